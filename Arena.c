@@ -0,0 +1,122 @@
+/*******************************************************************************************************************************************************************
+ * File        : Arena.c
+ * Project     : Inverted Search Engine (Project-2)
+ *
+ * Description :
+ *      Bump-pointer arena that owns every MAIN_NODE and SUB_NODE of an index. Nodes are carved
+ *      out of large blocks one after another, so nodes created together sit together in memory,
+ *      and the whole index is released by handing back a few blocks instead of one free() per node.
+ *
+ * Function Overview :
+ *
+ *      → Arena_Init( ARENA *arena, size_t block_size, size_t align )
+ *            • Prepares an empty arena; no memory is reserved until the first allocation
+ *            • align is a power of two: ARENA_ALIGN for nodes, 1 for packed byte arrays
+ *
+ *      → Arena_Alloc( ARENA *arena, size_t size )
+ *            • Returns size bytes rounded to the arena alignment, opening a new block when needed
+ *            • Requests larger than a block get a block of their own
+ *
+ *      → Arena_Release( ARENA *arena )
+ *            • Frees every block at once; cost depends on block count, not node count
+ *
+ *      → Arena_Report( ARENA *arena, const char *label )
+ *            • Prints allocation count, bytes handed out and bytes reserved
+ *
+ * Notes :
+ *      • Individual allocations are never freed; memory is reclaimed only by Arena_Release()
+ *      • Statistics are kept per arena so index memory can be sized per table
+ *
+ *******************************************************************************************************************************************************************/
+
+
+#include "Inverted_Search.h"
+#include "Types.h"
+
+
+/**/
+void Arena_Init( ARENA *arena, size_t block_size, size_t align )
+{
+	arena -> head = NULL;
+	arena -> block_size = block_size;
+	arena -> align = align;
+	arena -> alloc_count = 0;
+	arena -> bytes_used = 0;
+	arena -> bytes_reserved = 0;
+	arena -> block_count = 0;
+}
+
+
+/**/
+void* Arena_Alloc( ARENA *arena, size_t size )
+{
+	size = ( size + arena -> align - 1 ) & ~( arena -> align - 1 );
+
+	ARENA_BLOCK *block = arena -> head;
+
+	if( block == NULL || block -> used + size > block -> size )
+	{
+		size_t capacity = size > arena -> block_size ? size : arena -> block_size;
+
+		block = malloc( sizeof( ARENA_BLOCK ) + capacity );
+		if( block == NULL )
+		{
+			perror("Malloc failed for arena block");
+			return NULL;
+		}
+
+		block -> size = capacity;
+		block -> used = 0;
+
+		// An oversized block goes behind the current one so its free space is not lost
+		if( capacity > arena -> block_size && arena -> head != NULL )
+		{
+			block -> next = arena -> head -> next;
+			arena -> head -> next = block;
+		}
+		else
+		{
+			block -> next = arena -> head;
+			arena -> head = block;
+		}
+
+		arena -> bytes_reserved += capacity;
+		arena -> block_count++;
+	}
+
+	void *ptr = block -> data + block -> used;
+	block -> used += size;
+
+	arena -> alloc_count++;
+	arena -> bytes_used += size;
+
+	return ptr;
+}
+
+
+/**/
+void Arena_Release( ARENA *arena )
+{
+	ARENA_BLOCK *block = arena -> head;
+
+	while( block != NULL )
+	{
+		ARENA_BLOCK *next = block -> next;
+		free( block );
+		block = next;
+	}
+
+	Arena_Init( arena, arena -> block_size, arena -> align );
+}
+
+
+/**/
+void Arena_Report( ARENA *arena, const char *label )
+{
+	printf("  %-12s : %10zu allocations | %12zu bytes used | %12zu bytes reserved | %4zu blocks\n",
+			label,
+			arena -> alloc_count,
+			arena -> bytes_used,
+			arena -> bytes_reserved,
+			arena -> block_count );
+}
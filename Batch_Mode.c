@@ -0,0 +1,1102 @@
+/*******************************************************************************************************************************************************************
+ * File        : Batch_Mode.c
+ * Project     : Inverted Search Engine (Project-2)
+ *
+ * Description :
+ *      Non-interactive front end. When the first argument is a subcommand the menu is skipped,
+ *      nothing is ever prompted, and the exit code reports success, so indexing and bulk query
+ *      runs can be scripted and timed.
+ *
+ *          Inverted build  file1.txt | dir ...     [--save DB.txt] [--save-index DB.idx [--memory-budget MB]]
+ *          Inverted load   --db DB.txt | --index DB.idx [--verify] [--save ...] [--save-index ...]
+ *          Inverted save   <source> --save DB.txt | --save-index DB.idx
+ *          Inverted query  <source> [-q WORD]... [--queries FILE] [--rank [--top K] [--no-prune]]
+ *          Inverted stats  <source>
+ *          Inverted serve  file1.txt | dir ...     [-q WORD]... [--queries FILE] [--segment-docs N] [--segments BASE]
+ *          Inverted add    file1.txt | dir ...     --segments BASE [--segment-docs N]
+ *
+ *      <source> is a list of .txt files and directories to index ( walked recursively, see
+ *      --include ), --db ( text save file ) or --index ( binary index ). Queries come from -q, from --queries FILE ( "-" for stdin ), or from stdin when
+ *      neither is given, one query per line.
+ *
+ *      With --memory-budget MB an input file source is indexed in runs of at most MB of index
+ *      in memory, merged straight into the --save-index file and then mapped (External_Build.c).
+ *
+ *      Every command also takes --remove NAME, --reindex FILE.txt ( add or re-index one file )
+ *      and --compact, applied in command-line order after the source is loaded (Live_Update.c).
+ *
+ *      With --shards N the index is N document-partitioned tables (Shard.c): built, loaded and
+ *      saved per shard ( DB.txt.0 .. DB.txt.N-1 ), with every query scattered to the shards and
+ *      the answers gathered. Output is the same as for one table.
+ *
+ *      serve answers queries while the files are still being indexed (Segment_Index.c): one
+ *      thread indexes and publishes a segment every --segment-docs files, and -j reader threads
+ *      answer each query against the segments published when it starts, without locking.
+ *      With --segments BASE the segments are also files BASE.<n> listed by the manifest BASE:
+ *      serve starts from the segments already there ( input files are then optional ), add only
+ *      writes the new files as one more segment, and a background thread merges segments of
+ *      similar size as they pile up.
+ *
+ * Function Overview :
+ *
+ *      → Find_Batch_Command( const char *name )
+ *            • EXISTS when name is one of the subcommands above
+ *
+ *      → Run_Batch( int argc, char *argv[], BUILD_OPTIONS *options, HASH_T *H_Table )
+ *            • Loads / builds the source, writes the requested save files, then answers
+ *              queries or prints statistics; returns the process exit code
+ *
+ * Output :
+ *      • query → one line per query on stdout:   word <TAB> file_count <TAB> file:count ...
+ *                boolean queries ( Query.c ):        query <TAB> matches <TAB> file file ...
+ *                --rank ( Rank.c ):                  query <TAB> results <TAB> file:score ...
+ *      • serve → the query lines, in the order the readers finish them
+ *      • stats → "key value" lines on stdout
+ *      • Progress and [INFO] messages of the build / load / save steps go to stderr
+ *
+ * Notes :
+ *      • Global options ( -j, --no-simd, normalization, --include, --shards ) are read by Read_Options() first
+ *      • For serve, -j counts reader threads; the index is built by one thread
+ *
+ *******************************************************************************************************************************************************************/
+
+
+#include "Inverted_Search.h"
+#include "Types.h"
+#include "Validate.h"
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+
+static const char *Batch_Command[] = { "build", "load", "save", "query", "stats", "serve", "add" };
+
+#define BATCH_COMMANDS ( sizeof( Batch_Command ) / sizeof( Batch_Command[0] ) )
+
+
+typedef struct Batch_Edit
+{
+	const char *name;
+	int remove;                     // --remove, otherwise --reindex
+
+} BATCH_EDIT;
+
+
+typedef struct Batch_Args
+{
+	const char *command;
+	const char *db;                 // --db, text save file to load
+	const char *index;              // --index, binary index to map
+	const char *save;               // --save
+	const char *save_index;         // --save-index
+	const char *queries;            // --queries, "-" for stdin
+	int verify;                     // --verify postings checksum after mapping
+	int rank;                       // --rank, answer with the BM25 top k
+	int prune;                      // MaxScore pruning, off with --no-prune
+	const char *top;                // --top K
+	const char *segment_docs;       // --segment-docs N, serve and add
+	const char *segments;           // --segments BASE, segment store of serve and add
+	const char *memory_budget;      // --memory-budget MB, external build into --save-index
+	int compact;                    // --compact after the document edits
+
+	char **word;                    // -q WORD, in order
+	int word_count;
+
+	BATCH_EDIT *edit;               // --remove / --reindex, in order
+	int edit_count;
+
+	char **file;                    // positional input files, file[0] is the program name
+	int file_count;
+
+} BATCH_ARGS;
+
+
+/* Seconds from a monotonic clock */
+static double Now( void )
+{
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/* Route stdout to stderr ( or back ) so status messages do not mix with results */
+static int Redirect_Stdout( int saved )
+{
+	fflush( stdout );
+
+	if( saved < 0 )
+	{
+		saved = dup( STDOUT_FILENO );
+		dup2( STDERR_FILENO, STDOUT_FILENO );
+		return saved;
+	}
+
+	dup2( saved, STDOUT_FILENO );
+	close( saved );
+	return -1;
+}
+
+
+/**/
+Status Find_Batch_Command( const char *name )
+{
+	for( size_t i = 0; i < BATCH_COMMANDS; i++ )
+		if( strcmp( name, Batch_Command[i] ) == 0 )
+			return EXISTS;
+
+	return NOT_EXISTS;
+}
+
+
+/* Split argv into flags and input files; FAILURE on an unknown flag */
+static Status Parse_Batch_Args( int argc, char *argv[], BATCH_ARGS *args )
+{
+	memset( args, 0, sizeof( *args ) );
+	args -> command = argv[1];
+	args -> prune = 1;
+
+	args -> word = malloc( argc * sizeof( char* ) );
+	args -> file = malloc( ( argc + 1 ) * sizeof( char* ) );
+	args -> edit = malloc( argc * sizeof( BATCH_EDIT ) );
+
+	if( args -> word == NULL || args -> file == NULL || args -> edit == NULL )
+		return FAILURE;
+
+	args -> file[ args -> file_count++ ] = argv[0];
+
+	for( int i = 2; i < argc; i++ )
+	{
+		const char **value = NULL;
+
+		if( strcmp( argv[i], "--db" ) == 0 )
+			value = &args -> db;
+		else if( strcmp( argv[i], "--index" ) == 0 )
+			value = &args -> index;
+		else if( strcmp( argv[i], "--save" ) == 0 )
+			value = &args -> save;
+		else if( strcmp( argv[i], "--save-index" ) == 0 )
+			value = &args -> save_index;
+		else if( strcmp( argv[i], "--queries" ) == 0 )
+			value = &args -> queries;
+		else if( strcmp( argv[i], "--top" ) == 0 )
+			value = &args -> top;
+		else if( strcmp( argv[i], "--segment-docs" ) == 0 )
+			value = &args -> segment_docs;
+		else if( strcmp( argv[i], "--segments" ) == 0 )
+			value = &args -> segments;
+		else if( strcmp( argv[i], "--memory-budget" ) == 0 )
+			value = &args -> memory_budget;
+		else if( strcmp( argv[i], "--verify" ) == 0 )
+		{
+			args -> verify = 1;
+			continue;
+		}
+		else if( strcmp( argv[i], "--rank" ) == 0 )
+		{
+			args -> rank = 1;
+			continue;
+		}
+		else if( strcmp( argv[i], "--no-prune" ) == 0 )
+		{
+			args -> prune = 0;
+			continue;
+		}
+		else if( strcmp( argv[i], "--compact" ) == 0 )
+		{
+			args -> compact = 1;
+			continue;
+		}
+		else if( ( strcmp( argv[i], "--remove" ) == 0 || strcmp( argv[i], "--reindex" ) == 0 ) && i + 1 < argc )
+		{
+			args -> edit[ args -> edit_count ].remove = strcmp( argv[i], "--remove" ) == 0;
+			args -> edit[ args -> edit_count++ ].name = argv[++i];
+			continue;
+		}
+		else if( strcmp( argv[i], "-q" ) == 0 && i + 1 < argc )
+		{
+			args -> word[ args -> word_count++ ] = argv[++i];
+			continue;
+		}
+		else if( argv[i][0] == '-' )
+		{
+			fprintf( stderr, "[INFO]: Unknown option '%s'\n", argv[i] );
+			return FAILURE;
+		}
+		else
+		{
+			args -> file[ args -> file_count++ ] = argv[i];
+			continue;
+		}
+
+		if( i + 1 >= argc )
+		{
+			fprintf( stderr, "[INFO]: '%s' needs a value\n", argv[i] );
+			return FAILURE;
+		}
+
+		*value = argv[++i];
+	}
+
+	args -> file[ args -> file_count ] = NULL;
+
+	int sources = ( args -> db != NULL ) + ( args -> index != NULL ) + ( args -> file_count > 1 );
+
+	// serve can start from a segment store alone
+	if( sources != 1 && !( sources == 0 && args -> segments != NULL ) )
+	{
+		fprintf( stderr, "[INFO]: '%s' needs exactly one source: input files, --db or --index\n", args -> command );
+		return FAILURE;
+	}
+
+	if( strcmp( args -> command, "build" ) == 0 && args -> file_count < 2 )
+	{
+		fprintf( stderr, "[INFO]: 'build' needs input files\n" );
+		return FAILURE;
+	}
+
+	if( strcmp( args -> command, "load" ) == 0 && args -> file_count > 1 )
+	{
+		fprintf( stderr, "[INFO]: 'load' needs --db or --index\n" );
+		return FAILURE;
+	}
+
+	if( args -> top != NULL && ( atol( args -> top ) <= 0 || !args -> rank ) )
+	{
+		fprintf( stderr, "[INFO]: '--top' needs --rank and a positive count\n" );
+		return FAILURE;
+	}
+
+	if( strcmp( args -> command, "save" ) == 0 && args -> save == NULL && args -> save_index == NULL )
+	{
+		fprintf( stderr, "[INFO]: 'save' needs --save or --save-index\n" );
+		return FAILURE;
+	}
+
+	int segmented = strcmp( args -> command, "serve" ) == 0 || strcmp( args -> command, "add" ) == 0;
+
+	if( segmented && ( args -> db != NULL || args -> index != NULL || args -> save != NULL || args -> save_index != NULL
+	                   || args -> rank || args -> edit_count > 0 || args -> compact ) )
+	{
+		fprintf( stderr, "[INFO]: '%s' needs input files and takes no --save, --save-index, --rank or document edits\n", args -> command );
+		return FAILURE;
+	}
+
+	if( strcmp( args -> command, "add" ) == 0 && ( args -> file_count < 2 || args -> segments == NULL
+	                                               || args -> word_count > 0 || args -> queries != NULL ) )
+	{
+		fprintf( stderr, "[INFO]: 'add' needs input files and --segments, and answers no queries\n" );
+		return FAILURE;
+	}
+
+	if( args -> segments != NULL && !segmented )
+	{
+		fprintf( stderr, "[INFO]: '--segments' needs 'serve' or 'add'\n" );
+		return FAILURE;
+	}
+
+	if( args -> memory_budget != NULL && ( atol( args -> memory_budget ) <= 0 || args -> file_count < 2
+	                                       || args -> save_index == NULL || strcmp( args -> command, "serve" ) == 0 ) )
+	{
+		fprintf( stderr, "[INFO]: '--memory-budget' needs a positive size in MB, input files and --save-index\n" );
+		return FAILURE;
+	}
+
+	if( args -> segment_docs != NULL && ( atol( args -> segment_docs ) <= 0 || !segmented ) )
+	{
+		fprintf( stderr, "[INFO]: '--segment-docs' needs 'serve' or 'add' and a positive count\n" );
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+
+/* --memory-budget: build the index in runs straight into --save-index, then map it */
+static Status Load_External( BATCH_ARGS *args, BUILD_OPTIONS *options, SHARD_SET *set, LIST **head )
+{
+	Status status = SUCCESS;
+
+	if( options -> shards > 1 )
+	{
+		printf("[INFO]: '--memory-budget' builds one table and takes no --shards\n");
+		status = FAILURE;
+	}
+
+	if( status == SUCCESS )
+		status = Build_External_Index( head, ( size_t ) atol( args -> memory_budget ) << 20, args -> save_index );
+
+	while( *head != NULL )
+	{
+		LIST *next = ( *head ) -> link;
+		free( *head );
+		*head = next;
+	}
+
+	if( status == SUCCESS )
+		status = Load_Shards( set, NULL, args -> save_index, 0 );
+
+	// The index is written already; only document edits make it change again
+	if( args -> edit_count == 0 && !args -> compact )
+		args -> save_index = NULL;
+
+	return status;
+}
+
+
+/* Fill the shards from the selected source */
+static Status Load_Source( BATCH_ARGS *args, BUILD_OPTIONS *options, SHARD_SET *set )
+{
+	if( args -> db != NULL || args -> index != NULL )
+		return Load_Shards( set, args -> db, args -> index, args -> verify );
+
+	LIST *head = NULL;
+	Read_and_Validate( args -> file_count, args -> file, &head );
+
+	if( head == NULL )
+	{
+		printf("[INFO]: No valid input files\n");
+		return FAILURE;
+	}
+
+	if( args -> memory_budget != NULL )
+		return Load_External( args, options, set, &head );
+
+	double start = Now();
+	Status status = Build_Shards( set, &head, options -> threads );
+	double seconds = Now() - start;
+
+	while( head != NULL )
+	{
+		LIST *next = head -> link;
+		free( head );
+		head = next;
+	}
+
+	if( status == FAILURE )
+		return FAILURE;
+
+	TOKEN_STATS tokens = { 0, 0, 0, 0 };
+
+	for( int shard = 0; shard < set -> count; shard++ )
+	{
+		tokens.bytes += set -> shard[shard].Tokens.bytes;
+		tokens.tokens += set -> shard[shard].Tokens.tokens;
+		tokens.truncated += set -> shard[shard].Tokens.truncated;
+		tokens.dropped += set -> shard[shard].Tokens.dropped;
+	}
+
+	Report_Tokenizer_Throughput( &tokens, seconds );
+
+	if( Freeze_Shards( set ) == FAILURE )
+		printf("[INFO]: Could not compress postings, keeping linked lists\n");
+
+	return SUCCESS;
+}
+
+
+/* --remove / --reindex in order, then --compact */
+static Status Apply_Edits( BATCH_ARGS *args, SHARD_SET *set )
+{
+	for( int i = 0; i < args -> edit_count; i++ )
+	{
+		Status status = args -> edit[i].remove ? Shard_Remove_Document( set, args -> edit[i].name )
+		                                       : Shard_Reindex_Document( set, args -> edit[i].name );
+		if( status != SUCCESS )
+			return FAILURE;
+	}
+
+	return args -> compact ? Compact_Shards( set ) : SUCCESS;
+}
+
+
+/* File name of a shard hit */
+static const char* Hit_Name( SHARD_SET *set, SHARD_HIT *hit )
+{
+	return Doc_Name( &set -> shard[ hit -> shard ].Docs, hit -> doc_id );
+}
+
+
+/* Matching files of a boolean query, without counts */
+static void Answer_Boolean( SHARD_SET *set, char *text )
+{
+	SHARD_RESULT result;
+	char error[2 * MAX_WORD_LENGTH + 64];
+
+	if( Shard_Evaluate_Query( set, text, &result, error, sizeof( error ) ) == FAILURE )
+	{
+		fprintf( stderr, "[INFO]: Could not evaluate '%s': %s\n", text, error );
+		printf("%s\t0\n", text );
+		return;
+	}
+
+	printf("%s\t%zu", text, result.count );
+
+	for( size_t i = 0; i < result.count; i++ )
+		printf("%c%s", i == 0 ? '\t' : ' ', Hit_Name( set, &result.hit[i] ) );
+
+	printf("\n");
+	Free_Shard_Result( &result );
+}
+
+
+/* Best files of a ranked query with their BM25 scores */
+static void Answer_Ranked( SHARD_SET *set, char *text, BATCH_ARGS *args )
+{
+	SHARD_RESULT result;
+	size_t k = args -> top != NULL ? ( size_t ) atol( args -> top ) : RANK_DEFAULT_K;
+
+	if( Shard_Rank_Query( set, text, k, args -> prune, &result ) == FAILURE )
+	{
+		fprintf( stderr, "[INFO]: Could not rank '%s'\n", text );
+		printf("%s\t0\n", text );
+		return;
+	}
+
+	printf("%s\t%zu", text, result.count );
+
+	for( size_t i = 0; i < result.count; i++ )
+		printf("%c%s:%.4f", i == 0 ? '\t' : ' ', Hit_Name( set, &result.hit[i] ), result.hit[i].score );
+
+	printf("\n");
+	Free_Shard_Result( &result );
+}
+
+
+/* One result line for one query: a word with per-file counts, or a boolean query */
+static void Answer_Query( SHARD_SET *set, char *text, BATCH_ARGS *args )
+{
+	if( args -> rank )
+	{
+		Answer_Ranked( set, text, args );
+		return;
+	}
+
+	QUERY parsed;
+
+	if( Parse_Query( text, &parsed ) == FAILURE )
+	{
+		fprintf( stderr, "[INFO]: Invalid query '%s': %s\n", text, parsed.error );
+		printf("%s\t0\n", text );
+		Free_Query( &parsed );
+		return;
+	}
+
+	if( parsed.root != NULL && parsed.root -> kind != QUERY_TERM )
+	{
+		Free_Query( &parsed );
+		Answer_Boolean( set, text );
+		return;
+	}
+
+	SHARD_RESULT result = { NULL, 0 };
+
+	if( parsed.root != NULL && Shard_Term_Postings( set, parsed.root -> word, &result ) == FAILURE )
+		fprintf( stderr, "[INFO]: Could not look up '%s'\n", text );
+
+	Free_Query( &parsed );
+
+	if( result.count == 0 )
+	{
+		printf("%s\t0\n", text );
+		Free_Shard_Result( &result );
+		return;
+	}
+
+	printf("%s\t%zu\t", text, result.count );
+
+	for( size_t i = 0; i < result.count; i++ )
+		printf("%s%s:%ld", i == 0 ? "" : " ", Hit_Name( set, &result.hit[i] ), result.hit[i].word_count );
+
+	printf("\n");
+	Free_Shard_Result( &result );
+}
+
+
+/* Answer -q words, then the query file / stdin; returns the number of queries */
+static long Run_Queries( BATCH_ARGS *args, SHARD_SET *set )
+{
+	long count = 0;
+
+	for( int i = 0; i < args -> word_count; i++, count++ )
+		Answer_Query( set, args -> word[i], args );
+
+	if( args -> word_count > 0 && args -> queries == NULL )
+		return count;
+
+	FILE *fptr = stdin;
+
+	if( args -> queries != NULL && strcmp( args -> queries, "-" ) != 0 )
+	{
+		fptr = fopen( args -> queries, "r" );
+		if( fptr == NULL )
+		{
+			fprintf( stderr, "[INFO]: Could not open query file '%s'\n", args -> queries );
+			return -1;
+		}
+	}
+
+	char *line = NULL;
+	size_t capacity = 0;
+	ssize_t length;
+
+	while( ( length = getline( &line, &capacity, fptr ) ) != -1 )
+	{
+		while( length > 0 && isspace( ( unsigned char ) line[ length - 1 ] ) )
+			line[ --length ] = '\0';
+
+		char *query = line;
+		while( isspace( ( unsigned char ) *query ) )
+			query++;
+
+		if( *query == '\0' )
+			continue;
+
+		Answer_Query( set, query, args );
+		count++;
+	}
+
+	free( line );
+
+	if( fptr != stdin )
+		fclose( fptr );
+
+	return count;
+}
+
+
+/* Totals of the loaded index as "key value" lines */
+static void Print_Stats( SHARD_SET *set )
+{
+	TERM_CURSOR cursor;
+	TERM_REF term;
+	INDEX group;
+	long terms = 0;
+	long postings = 0;
+	Word_Count occurrences = 0;
+	size_t documents = 0;
+	size_t deleted = 0;
+
+	for( int shard = 0; shard < set -> count; shard++ )
+	{
+		HASH_T *H_Table = &set -> shard[shard];
+
+		Term_Cursor_Init( &cursor, H_Table );
+
+		while( Term_Cursor_Next( &cursor, &term, &group ) == SUCCESS )
+		{
+			POSTING_ITER it;
+			long live = 0;
+
+			Posting_Iter_Init_Term( &it, &term );
+
+			while( Posting_Iter_Next( &it ) == SUCCESS )
+			{
+				live++;
+				occurrences += it.word_count;
+			}
+
+			// A word found only in deleted documents is gone until compaction removes it
+			terms += live > 0;
+			postings += live;
+		}
+
+		documents += H_Table -> Docs.count - H_Table -> Docs.deleted;
+		deleted += H_Table -> Docs.deleted;
+	}
+
+	// A word indexed in several shards is one term
+	if( set -> count > 1 )
+		terms = Shard_Live_Terms( set );
+
+	if( set -> count > 1 )
+		printf("shards %d\n", set -> count );
+
+	printf("documents %zu\n", documents );
+	printf("deleted %zu\n", deleted );
+	printf("terms %ld\n", terms );
+	printf("postings %ld\n", postings );
+	printf("occurrences %ld\n", occurrences );
+	printf("normalization 0x%x\n", Normalizer_Flags() );
+
+	// The memory report is a status message, not a key value line
+	int saved = Redirect_Stdout( -1 );
+
+	for( int shard = 0; shard < set -> count; shard++ )
+		Report_Memory_Usage( &set -> shard[shard] );
+
+	Redirect_Stdout( saved );
+}
+
+
+typedef struct Serve_State
+{
+	BATCH_ARGS *args;
+	SEGMENT_INDEX *index;
+	LIST *head;
+	size_t segment_docs;            // documents per published segment
+	DOC_TABLE seen;                 // every document of every segment, for duplicate checks
+
+	Status ingest;                  // written by the ingest thread, read after it is joined
+	int segments;
+	size_t documents;
+
+	FILE *input;                    // query file / stdin, NULL when only -q words are answered
+	int next_word;                  // next -q word
+	long answered;
+	pthread_mutex_t lock;           // input, next_word and answered
+
+	FILE *out;                      // answers: the real stdout
+
+} SERVE_STATE;
+
+
+typedef struct Serve_Reader
+{
+	SERVE_STATE *state;
+	int slot;                       // reader slot of the segment index
+	pthread_t thread;
+
+} SERVE_READER;
+
+
+/* Publish a filled segment; it is freed here if that fails */
+static Status Serve_Publish( SERVE_STATE *state, HASH_T *segment )
+{
+	size_t documents = segment -> Docs.count - segment -> Docs.deleted;
+
+	if( Publish_Segment( state -> index, segment ) == FAILURE )
+	{
+		printf("[INFO]: Could not publish segment %d\n", state -> segments + 1 );
+		Free_Hash_Table( segment );
+		return FAILURE;
+	}
+
+	state -> segments++;
+	state -> documents += documents;
+
+	printf("[INFO]: Segment %d published: %zu document%s, %zu searchable\n",
+			state -> segments, documents, documents == 1 ? "" : "s", state -> documents );
+
+	return SUCCESS;
+}
+
+
+/* Ingest thread: walk the input, index files into a private table, publish it every segment_docs files */
+static void* Serve_Ingest( void *arg )
+{
+	SERVE_STATE *state = arg;
+	char filename[FILENAME_MAX];
+	DOC_TABLE *seen = &state -> seen;
+	HASH_T segment;
+	int filling = 0;                // segment is initialised
+
+	state -> ingest = FAILURE;
+
+	CORPUS *corpus = Open_Corpus( state -> head );
+	if( corpus == NULL )
+		return NULL;
+
+	Status status = SUCCESS;
+
+	while( status == SUCCESS && Next_Corpus_File( corpus, filename ) == SUCCESS )
+	{
+		DOC_ID doc_id;
+
+		// Segments are separate tables, so duplicates are caught across all of them here
+		if( Find_Document_File( seen, filename, NULL, NULL ) == EXISTS )
+		{
+			printf("[INFO]: '%s' already present in database. Skipping...\n", filename );
+			continue;
+		}
+
+		FILE *fptr = fopen( filename, "r" );
+		if( fptr == NULL )
+		{
+			printf("[INFO]: Could not open '%s'. Skipping...\n", filename );
+			Skip_Corpus_File( corpus );
+			continue;
+		}
+
+		DOC_ID seen_id;
+
+		if( Register_Document( seen, filename, &seen_id ) == FAILURE )
+		{
+			printf("[INFO]: Could not register '%s'. Skipping...\n", filename );
+			fclose( fptr );
+			continue;
+		}
+
+		Record_Document_File( seen, seen_id, filename, fptr );
+
+		if( !filling )
+		{
+			status = Initialise_Hash_Table( &segment );
+			filling = status == SUCCESS;
+			Adopt_Posting_Form( &segment );
+		}
+
+		if( status == SUCCESS && Register_Document( &segment.Docs, filename, &doc_id ) == FAILURE )
+		{
+			printf("[INFO]: Could not register '%s'. Skipping...\n", filename );
+			Delete_Document( seen, seen_id );
+		}
+		else if( status == SUCCESS )
+		{
+			Record_Document_File( &segment.Docs, doc_id, filename, fptr );
+
+			// A file indexed part-way is not published as if complete: its postings stay behind a tombstone
+			if( Index_File( &segment, fptr, doc_id ) == FAILURE )
+			{
+				printf("[INFO]: Indexing '%s' failed. Skipping...\n", filename );
+				Delete_Document( &segment.Docs, doc_id );
+				Delete_Document( seen, seen_id );
+			}
+		}
+
+		fclose( fptr );
+
+		if( filling && segment.Docs.count == state -> segment_docs )
+		{
+			filling = 0;
+			status = Serve_Publish( state, &segment );
+		}
+	}
+
+	if( filling && status == SUCCESS && segment.Docs.count > 0 )
+		status = Serve_Publish( state, &segment );
+	else if( filling )
+		Free_Hash_Table( &segment );
+
+	Close_Corpus( corpus );
+
+	state -> ingest = status;
+	return NULL;
+}
+
+
+/* Next query for a reader: -q words first, then lines of the query input; NULL at the end */
+static char* Next_Serve_Query( SERVE_STATE *state, char **line, size_t *capacity )
+{
+	char *query = NULL;
+
+	pthread_mutex_lock( &state -> lock );
+
+	if( state -> next_word < state -> args -> word_count )
+		query = state -> args -> word[ state -> next_word++ ];
+
+	while( query == NULL && state -> input != NULL )
+	{
+		ssize_t length = getline( line, capacity, state -> input );
+
+		if( length == -1 )
+			break;
+
+		while( length > 0 && isspace( ( unsigned char ) ( *line )[ length - 1 ] ) )
+			( *line )[ --length ] = '\0';
+
+		query = *line;
+		while( isspace( ( unsigned char ) *query ) )
+			query++;
+
+		if( *query == '\0' )
+			query = NULL;
+	}
+
+	state -> answered += query != NULL;
+
+	pthread_mutex_unlock( &state -> lock );
+	return query;
+}
+
+
+/* One result line against one snapshot, in the format of Answer_Query() */
+static void Serve_Answer( FILE *out, const SNAPSHOT *snapshot, char *text )
+{
+	SHARD_RESULT result = { NULL, 0 };
+	char error[2 * MAX_WORD_LENGTH + 64];
+	QUERY parsed;
+	int boolean = 0;
+
+	if( Parse_Query( text, &parsed ) == FAILURE )
+	{
+		fprintf( stderr, "[INFO]: Invalid query '%s': %s\n", text, parsed.error );
+	}
+	else if( parsed.root != NULL && parsed.root -> kind != QUERY_TERM )
+	{
+		boolean = 1;
+
+		if( Snapshot_Evaluate_Query( snapshot, text, &result, error, sizeof( error ) ) == FAILURE )
+			fprintf( stderr, "[INFO]: Could not evaluate '%s': %s\n", text, error );
+	}
+	else if( parsed.root != NULL && Snapshot_Term_Postings( snapshot, parsed.root -> word, &result ) == FAILURE )
+	{
+		fprintf( stderr, "[INFO]: Could not look up '%s'\n", text );
+	}
+
+	Free_Query( &parsed );
+
+	// Readers share the output; one line is written under the stream lock
+	flockfile( out );
+	fprintf( out, "%s\t%zu", text, result.count );
+
+	for( size_t i = 0; i < result.count; i++ )
+	{
+		if( boolean )
+			fprintf( out, "%c%s", i == 0 ? '\t' : ' ', Snapshot_Doc_Name( snapshot, &result.hit[i] ) );
+		else
+			fprintf( out, "%c%s:%ld", i == 0 ? '\t' : ' ', Snapshot_Doc_Name( snapshot, &result.hit[i] ), result.hit[i].word_count );
+	}
+
+	fprintf( out, "\n" );
+	funlockfile( out );
+
+	Free_Shard_Result( &result );
+}
+
+
+/* Reader thread: answer queries, each against the snapshot current when it starts */
+static void* Serve_Reader( void *arg )
+{
+	SERVE_READER *reader = arg;
+	SERVE_STATE *state = reader -> state;
+	char *line = NULL;
+	size_t capacity = 0;
+	char *text;
+
+	while( ( text = Next_Serve_Query( state, &line, &capacity ) ) != NULL )
+	{
+		const SNAPSHOT *snapshot = Enter_Snapshot( state -> index, reader -> slot );
+
+		Serve_Answer( state -> out, snapshot, text );
+
+		Leave_Snapshot( state -> index, reader -> slot );
+	}
+
+	free( line );
+	return NULL;
+}
+
+
+/* serve / add: one ingest thread indexes the input while -j reader threads answer queries */
+static Status Serve_Queries( BATCH_ARGS *args, BUILD_OPTIONS *options, int saved )
+{
+	int add = strcmp( args -> command, "add" ) == 0;
+
+	if( options -> shards > 1 )
+	{
+		printf("[INFO]: '%s' keeps its own segments and takes no --shards\n", args -> command );
+		return FAILURE;
+	}
+
+	SERVE_STATE state;
+	memset( &state, 0, sizeof( state ) );
+
+	state.args = args;
+	state.segment_docs = args -> segment_docs != NULL ? ( size_t ) atol( args -> segment_docs ) : SEGMENT_DEFAULT_DOCS;
+
+	// add writes the whole batch as one segment unless told otherwise
+	if( add && args -> segment_docs == NULL )
+		state.segment_docs = SIZE_MAX;
+
+	if( args -> file_count > 1 )
+	{
+		Read_and_Validate( args -> file_count, args -> file, &state.head );
+
+		if( state.head == NULL )
+		{
+			printf("[INFO]: No valid input files\n");
+			return FAILURE;
+		}
+	}
+
+	if( !add && ( args -> word_count == 0 || args -> queries != NULL ) )
+		state.input = stdin;
+
+	if( args -> queries != NULL && strcmp( args -> queries, "-" ) != 0 )
+	{
+		state.input = fopen( args -> queries, "r" );
+		if( state.input == NULL )
+			printf("[INFO]: Could not open query file '%s'\n", args -> queries );
+	}
+
+	int readers = add ? 0 : options -> threads;
+	int started = 0;
+	int ingesting = 0;
+	pthread_t ingest;
+
+	// stdout carries progress messages until Run_Batch() restores it; answers go to the real one
+	int out = dup( saved );
+
+	state.out = out < 0 ? NULL : fdopen( out, "w" );
+	state.index = Open_Segment_Index( readers );
+	SERVE_READER *reader = calloc( readers > 0 ? readers : 1, sizeof( SERVE_READER ) );
+
+	Status status = state.out != NULL && state.index != NULL && reader != NULL
+	                && ( args -> queries == NULL || state.input != NULL ) ? SUCCESS : FAILURE;
+
+	if( status == SUCCESS )
+		status = Initialise_Doc_Table( &state.seen );
+
+	// Documents already in the store count as present
+	if( status == SUCCESS && args -> segments != NULL )
+		status = Attach_Segment_Store( state.index, args -> segments );
+
+	if( status == SUCCESS )
+		status = Segment_Index_Documents( state.index, &state.seen );
+
+	if( status == SUCCESS )
+		status = Start_Segment_Merger( state.index );
+
+	pthread_mutex_init( &state.lock, NULL );
+	double start = Now();
+
+	state.ingest = SUCCESS;
+
+	if( status == SUCCESS && state.head != NULL )
+	{
+		ingesting = pthread_create( &ingest, NULL, Serve_Ingest, &state ) == 0;
+
+		if( !ingesting )
+			status = FAILURE;
+	}
+
+	for( ; status == SUCCESS && started < readers; started++ )
+	{
+		reader[started].state = &state;
+		reader[started].slot = started;
+
+		if( pthread_create( &reader[started].thread, NULL, Serve_Reader, &reader[started] ) != 0 )
+			break;
+	}
+
+	if( status == FAILURE || ( readers > 0 && started == 0 ) )
+	{
+		printf("[INFO]: Could not start the serving threads\n");
+		status = FAILURE;
+	}
+
+	for( int i = 0; i < started; i++ )
+		pthread_join( reader[i].thread, NULL );
+
+	if( ingesting )
+	{
+		pthread_join( ingest, NULL );
+		status = status == SUCCESS ? state.ingest : FAILURE;
+	}
+
+	double seconds = Now() - start;
+
+	fflush( stdout );
+
+	if( status == SUCCESS && add )
+		fprintf( stderr, "[INFO]: %zu document%s added to '%s' as %d segment%s in %.3f s\n",
+				state.documents, state.documents == 1 ? "" : "s", args -> segments,
+				state.segments, state.segments == 1 ? "" : "s", seconds );
+	else if( status == SUCCESS )
+		fprintf( stderr, "[INFO]: %ld quer%s answered by %d reader%s while %zu documents were indexed into %d segment%s in %.3f s\n",
+				state.answered, state.answered == 1 ? "y" : "ies", started, started == 1 ? "" : "s",
+				state.documents, state.segments, state.segments == 1 ? "" : "s", seconds );
+
+	// Waits for the merges the new segments call for
+	Close_Segment_Index( state.index );
+	Free_Doc_Table( &state.seen );
+	pthread_mutex_destroy( &state.lock );
+	free( reader );
+
+	if( state.out != NULL )
+		fclose( state.out );
+	else if( out >= 0 )
+		close( out );
+
+	if( state.input != NULL && state.input != stdin )
+		fclose( state.input );
+
+	while( state.head != NULL )
+	{
+		LIST *next = state.head -> link;
+		free( state.head );
+		state.head = next;
+	}
+
+	return status;
+}
+
+
+/**/
+int Run_Batch( int argc, char *argv[], BUILD_OPTIONS *options, HASH_T *H_Table )
+{
+	BATCH_ARGS args;
+
+	if( Parse_Batch_Args( argc, argv, &args ) == FAILURE )
+	{
+		free( args.word );
+		free( args.file );
+		free( args.edit );
+		return 2;
+	}
+
+	int saved = Redirect_Stdout( -1 );
+
+	SHARD_SET set;
+
+	double start = Now();
+	Status status = Apply_Options( options );
+
+	int serve = strcmp( args.command, "serve" ) == 0 || strcmp( args.command, "add" ) == 0;
+
+	if( status == SUCCESS && serve )
+		status = Serve_Queries( &args, options, saved );
+	else if( status == SUCCESS )
+		status = Open_Shard_Set( &set, H_Table, options -> shards );
+
+	int opened = status == SUCCESS && !serve;
+
+	if( opened )
+		status = Load_Source( &args, options, &set );
+
+	if( opened && status == SUCCESS )
+		status = Apply_Edits( &args, &set );
+	double load_time = Now() - start;
+
+	if( opened && status == SUCCESS )
+		status = Save_Shards( &set, args.save, args.save_index );
+
+	saved = Redirect_Stdout( saved );
+
+	if( opened && status == SUCCESS )
+	{
+		fprintf( stderr, "[INFO]: %s ready in %.3f s\n", args.command, load_time );
+
+		if( strcmp( args.command, "query" ) == 0 )
+		{
+			start = Now();
+			long count = Run_Queries( &args, &set );
+			double seconds = Now() - start;
+
+			if( count < 0 )
+				status = FAILURE;
+			else
+				fprintf( stderr, "[INFO]: %ld quer%s in %.3f s ( %.0f queries/s )\n",
+						count, count == 1 ? "y" : "ies", seconds, seconds > 0 ? count / seconds : 0.0 );
+		}
+		else if( strcmp( args.command, "stats" ) == 0 )
+		{
+			Print_Stats( &set );
+		}
+	}
+
+	fflush( stdout );
+
+	if( opened )
+		Close_Shard_Set( &set );
+
+	Free_Hash_Table( H_Table );
+	Free_Stopwords();
+	free( args.word );
+	free( args.file );
+	free( args.edit );
+
+	return status == SUCCESS ? 0 : 1;
+}
@@ -0,0 +1,206 @@
+/*******************************************************************************************************************************************************************
+ * File        : Bench_Load.c
+ * Project     : Inverted Search Engine (Project-2)
+ *
+ * Description :
+ *      Benchmark comparing the two ways of loading a saved database:
+ *
+ *          Legacy  → fscanf() parsing + one Insert_To_Hash_Table() per saved occurrence
+ *          Bulk    → Load_DataBase_File(), one Add_Posting() per saved ( word, file ) pair
+ *
+ *      A synthetic save file is generated, loaded both ways, and the two tables are checked
+ *      for identical totals before the timings are printed.
+ *
+ *      A second pair of files has a few words found in every one of df and 2 x df documents;
+ *      the bulk load of the second must take about twice as long, not four times ( a posting
+ *      list walked per new document makes the load quadratic in document frequency ).
+ *
+ * Usage :
+ *      make bench
+ *      ./Bench_Load [words] [files] [occurrences] [df]      ( defaults: 2000 200 500 20000 )
+ *
+ *******************************************************************************************************************************************************************/
+
+
+#include "Inverted_Search.h"
+#include "Types.h"
+#include <time.h>
+
+#define BENCH_FILE "Bench_Load_Input.txt"
+
+
+/* Seconds from a monotonic clock */
+static double Now( void )
+{
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/* The loader as it was: replay every occurrence through Insert_To_Hash_Table() */
+static Status Legacy_Load( HASH_T *H_Table, const char *filename )
+{
+	FILE *fptr = fopen( filename, "r" );
+	if( fptr == NULL )
+		return FAILURE;
+
+	INDEX index;
+	WORD word;
+	No_Of_Files file_count;
+	FILE_NAME file_name;
+	Word_Count word_count;
+
+	while( fscanf( fptr, "#%d; %[^;]; %ld;", &index, word, &file_count ) == 3 )
+	{
+		for( No_Of_Files i = 0; i < file_count; i++ )
+		{
+			if( fscanf( fptr, " %[^;]; %ld;", file_name, &word_count ) != 2 )
+				break;
+
+			DOC_ID doc_id;
+			if( Register_Document( &H_Table -> Docs, file_name, &doc_id ) == FAILURE )
+				continue;
+
+			for( Word_Count j = 0; j < word_count; j++ )
+				Insert_To_Hash_Table( word, doc_id, H_Table );
+		}
+
+		fscanf( fptr, " #\n" );
+	}
+
+	fclose( fptr );
+	return SUCCESS;
+}
+
+
+/* Synthetic save file: every word in every file */
+static Status Write_Bench_File( long words, long files, long occurrences )
+{
+	FILE *fptr = fopen( BENCH_FILE, "w" );
+	if( fptr == NULL )
+	{
+		perror("[INFO]: Could not create benchmark input");
+		return FAILURE;
+	}
+
+	for( long w = 0; w < words; w++ )
+	{
+		fprintf( fptr, "#%d; word%ld; %ld;", Find_Index( 'w' ), w, files );
+
+		for( long f = 0; f < files; f++ )
+			fprintf( fptr, " file%ld.txt; %ld;", f, 1 + ( w * 31 + f * 17 ) % occurrences );
+
+		fprintf( fptr, " #\n" );
+	}
+
+	fclose( fptr );
+	return SUCCESS;
+}
+
+
+/* Bulk load time of a save file with words found in df documents each */
+static double High_DF_Load( long words, long df )
+{
+	HASH_T table;
+
+	if( Write_Bench_File( words, df, 3 ) == FAILURE || Initialise_Hash_Table( &table ) == FAILURE )
+		return -1;
+
+	double start = Now();
+	Load_DataBase_File( &table, BENCH_FILE );
+	double elapsed = Now() - start;
+
+	Free_Hash_Table( &table );
+	return elapsed;
+}
+
+
+/* Sum of all counts, used to check both loaders built the same index */
+static Word_Count Total_Occurrences( HASH_T *H_Table, long *postings )
+{
+	TERM_CURSOR cursor;
+	TERM_REF term;
+	INDEX group;
+	Word_Count total = 0;
+
+	*postings = 0;
+	Term_Cursor_Init( &cursor, H_Table );
+
+	while( Term_Cursor_Next( &cursor, &term, &group ) == SUCCESS )
+	{
+		POSTING_ITER it;
+		Posting_Iter_Init_Term( &it, &term );
+
+		while( Posting_Iter_Next( &it ) == SUCCESS )
+		{
+			total += it.word_count;
+			( *postings )++;
+		}
+	}
+
+	return total;
+}
+
+
+int main( int argc, char *argv[] )
+{
+	long words = argc > 1 ? atol( argv[1] ) : 2000;
+	long files = argc > 2 ? atol( argv[2] ) : 200;
+	long occurrences = argc > 3 ? atol( argv[3] ) : 500;
+	long df = argc > 4 ? atol( argv[4] ) : 20000;
+
+	if( Write_Bench_File( words, files, occurrences ) == FAILURE )
+		return 1;
+
+	HASH_T legacy;
+	HASH_T bulk;
+
+	if( Initialise_Hash_Table( &legacy ) == FAILURE || Initialise_Hash_Table( &bulk ) == FAILURE )
+		return 1;
+
+	printf("[INFO]: %ld words x %ld files, up to %ld occurrences per posting\n", words, files, occurrences );
+
+	double start = Now();
+	Legacy_Load( &legacy, BENCH_FILE );
+	double legacy_time = Now() - start;
+
+	start = Now();
+	Load_DataBase_File( &bulk, BENCH_FILE );
+	double bulk_time = Now() - start;
+
+	long legacy_postings;
+	long bulk_postings;
+	Word_Count legacy_total = Total_Occurrences( &legacy, &legacy_postings );
+	Word_Count bulk_total = Total_Occurrences( &bulk, &bulk_postings );
+
+	printf("\n  %-8s : %10.3f s | %10ld postings | %12ld occurrences\n", "Legacy", legacy_time, legacy_postings, legacy_total );
+	printf("  %-8s : %10.3f s | %10ld postings | %12ld occurrences\n", "Bulk", bulk_time, bulk_postings, bulk_total );
+
+	if( legacy_total != bulk_total || legacy_postings != bulk_postings )
+		printf("\n[INFO]: MISMATCH between legacy and bulk load\n");
+	else
+		printf("\n[INFO]: Results match, bulk load is %.1fx faster\n", bulk_time > 0 ? legacy_time / bulk_time : 0.0 );
+
+	Free_Hash_Table( &legacy );
+	Free_Hash_Table( &bulk );
+
+	// Document frequency: twice the postings per word should cost twice the time
+	double single = High_DF_Load( 20, df );
+	double twice = High_DF_Load( 20, 2 * df );
+
+	printf("\n  %-8s : %10.3f s | %10ld postings | df %ld\n", "Bulk", single, 20 * df, df );
+	printf("  %-8s : %10.3f s | %10ld postings | df %ld\n", "Bulk", twice, 40 * df, 2 * df );
+
+	int linear = single >= 0 && twice >= 0 && twice <= 3 * single + 0.01;
+
+	if( linear )
+		printf("\n[INFO]: Load time grows %.1fx for twice the document frequency\n", single > 0 ? twice / single : 0.0 );
+	else
+		printf("\n[INFO]: Load time grows faster than the document frequency\n");
+
+	remove( BENCH_FILE );
+
+	return legacy_total == bulk_total && linear ? 0 : 1;
+}
@@ -0,0 +1,663 @@
+/*******************************************************************************************************************************************************************
+ * File        : Binary_Index.c
+ * Project     : Inverted Search Engine (Project-2)
+ *
+ * Description :
+ *      Versioned binary index file that is queried in place through mmap(). Loading maps the
+ *      file, checks it, and registers the document names; terms and postings are never copied,
+ *      so a multi-GB index is searchable as soon as the dictionary has been verified.
+ *
+ * File Layout ( all integers in host byte order, every section 8-byte aligned ) :
+ *
+ *      INDEX_HEADER    magic "INVSRCH", version, counts, section offsets / sizes, CRC32s
+ *      Doc table       uint64 name_offset[doc_count]  followed by NUL-terminated names
+ *      Postings        frozen posting arrays ( varint doc delta, varint count [, positions] ) back to back
+ *      Dictionary      TERM_ENTRY[term_count] in dictionary order followed by NUL-terminated words
+ *
+ *      Dictionary order is Compare_Terms(): letter group first, then strcmp(). It allows binary
+ *      search and is also the order in which Display / Save walk a mapped index.
+ *
+ * Function Overview :
+ *
+ *      → Save_Binary_Index( HASH_T *Hash_T, const char *filename )
+ *            • Compacts away deleted documents, freezes the table and writes it to filename.tmp,
+ *              then syncs it and renames it over filename ( Commit_File() )
+ *            • Terms are written in the order of the sorted term dictionary (Term_Dict.c)
+ *
+ *      → Open_Index_Writer( const char *filename, DOC_TABLE *Docs, int positional )
+ *      → Index_Writer_Term( INDEX_WRITER *writer, const char *word, const unsigned char *postings, unsigned int length, No_Of_Files file_count )
+ *      → Close_Index_Writer( INDEX_WRITER *writer, Status status )
+ *            • Streams an index to filename.tmp one term at a time, in dictionary order, with
+ *              frozen postings; the dictionary is spilled to temporary files until the postings
+ *              are written, so memory does not grow with the index
+ *            • Close renames over filename when status and every write succeeded, otherwise
+ *              removes the temporary file; Save_Binary_Index() and the external build
+ *              (External_Build.c) both write through it
+ *
+ *      → Load_Binary_Index( HASH_T *Hash_T, const char *filename )
+ *            • Maps filename read-only, validates header / doc table / dictionary and attaches it
+ *
+ *      → Verify_Binary_Index( HASH_T *Hash_T )
+ *            • Full postings checksum, kept separate so loading stays O(dictionary)
+ *
+ *      → Mapped_Find_Term / Mapped_Term_Ref
+ *            • Binary search in the mapped dictionary / TERM_REF for one entry
+ *
+ *      → Materialise_Mapped_Index( HASH_T *Hash_T )
+ *            • Creates heap MAIN_NODEs for every mapped term before the index is modified;
+ *              their postings still point into the mapping (zero copy)
+ *            • Words already in the heap table ( Materialise_Mapped_Term() ) are kept as they are
+ *
+ *      → Materialise_Mapped_Term( HASH_T *Hash_T, const char *word, MAIN_NODE **node )
+ *            • The same for one word, so a single document can be added without copying the whole
+ *              dictionary; *node is NULL when the mapping does not hold word
+ *            • Until the next full materialisation, heap words shadow their mapped entries in
+ *              Lookup_Term(); dictionary walks materialise first
+ *
+ *      → Unmap_Binary_Index( HASH_T *Hash_T )
+ *            • Releases the mapping; called by Free_Hash_Table()
+ *
+ * Return Behavior :
+ *      • SUCCESS on a complete save / load
+ *      • FAILURE on I/O errors or any failed validation; the current table is left untouched
+ *
+ * Notes :
+ *      • Saving goes through a temporary file, so overwriting the file that is currently mapped
+ *        is safe
+ *      • Files are not portable between machines of different endianness
+ *      • header.flags records the normalization stages; loading adopts them for later queries
+ *      • INDEX_POSITIONAL in header.flags marks postings that carry token positions
+ *
+ *******************************************************************************************************************************************************************/
+
+
+#include "Inverted_Search.h"
+#include "Types.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+/* CRC-32 ( IEEE, reflected ) using a 16 entry nibble table */
+static uint32_t Crc32( uint32_t crc, const void *data, size_t length )
+{
+	static const uint32_t table[16] =
+	{
+		0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+		0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+	};
+
+	const unsigned char *p = data;
+	crc = ~crc;
+
+	while( length-- )
+	{
+		crc ^= *p++;
+		crc = ( crc >> 4 ) ^ table[crc & 0x0F];
+		crc = ( crc >> 4 ) ^ table[crc & 0x0F];
+	}
+
+	return ~crc;
+}
+
+
+/* fwrite that also folds the bytes into a running CRC */
+static Status Write_Section( FILE *fptr, const void *data, size_t length, uint32_t *crc )
+{
+	if( length == 0 )
+		return SUCCESS;
+
+	*crc = Crc32( *crc, data, length );
+
+	return fwrite( data, 1, length, fptr ) == length ? SUCCESS : FAILURE;
+}
+
+
+/* Zero bytes up to the next multiple of 8 ( not part of any checksum ) */
+static Status Pad_Section( FILE *fptr, uint64_t *offset )
+{
+	static const char zero[8] = { 0 };
+	size_t pad = ( 8 - ( *offset & 7 ) ) & 7;
+
+	*offset += pad;
+
+	return fwrite( zero, 1, pad, fptr ) == pad ? SUCCESS : FAILURE;
+}
+
+
+struct Index_Writer
+{
+	FILE *fptr;                     // filename.tmp
+	FILE *entries;                  // TERM_ENTRYs and words, spilled until the postings are written
+	FILE *words;
+	char temp_name[FILENAME_MAX];
+	char name[FILENAME_MAX];
+
+	INDEX_HEADER header;
+	uint64_t offset;                // bytes written to fptr
+	uint64_t word_offset;           // bytes in words
+
+};
+
+
+/* Write header placeholder and doc table; SUCCESS when every write succeeded */
+static Status Write_Doc_Table( INDEX_WRITER *writer, DOC_TABLE *Docs )
+{
+	INDEX_HEADER *header = &writer -> header;
+
+	// Placeholder, rewritten once all offsets and checksums are known
+	if( fwrite( header, sizeof( *header ), 1, writer -> fptr ) != 1 )
+		return FAILURE;
+
+	writer -> offset = sizeof( *header );
+
+	header -> doc_offset = writer -> offset;
+	uint64_t name_offset = Docs -> count * sizeof( uint64_t );
+
+	for( size_t id = 0; id < Docs -> count; id++ )
+	{
+		if( Write_Section( writer -> fptr, &name_offset, sizeof( name_offset ), &header -> doc_crc ) == FAILURE )
+			return FAILURE;
+
+		name_offset += strlen( Docs -> doc[id].name ) + 1;
+	}
+
+	for( size_t id = 0; id < Docs -> count; id++ )
+	{
+		const char *name = Docs -> doc[id].name;
+
+		if( Write_Section( writer -> fptr, name, strlen( name ) + 1, &header -> doc_crc ) == FAILURE )
+			return FAILURE;
+	}
+
+	header -> doc_size = name_offset;
+	writer -> offset += name_offset;
+
+	if( Pad_Section( writer -> fptr, &writer -> offset ) == FAILURE )
+		return FAILURE;
+
+	header -> post_offset = writer -> offset;
+	return SUCCESS;
+}
+
+
+/**/
+INDEX_WRITER* Open_Index_Writer( const char *filename, DOC_TABLE *Docs, int positional )
+{
+	INDEX_WRITER *writer = calloc( 1, sizeof( INDEX_WRITER ) );
+	if( writer == NULL )
+	{
+		perror("Malloc failed for binary index writer");
+		return NULL;
+	}
+
+	snprintf( writer -> name, sizeof( writer -> name ), "%s", filename );
+	snprintf( writer -> temp_name, sizeof( writer -> temp_name ), "%s.tmp", filename );
+
+	INDEX_HEADER *header = &writer -> header;
+
+	memcpy( header -> magic, INDEX_MAGIC, sizeof( INDEX_MAGIC ) );
+	header -> version = INDEX_VERSION;
+	header -> flags = Normalizer_Flags() | ( positional ? INDEX_POSITIONAL : 0 );
+	header -> doc_count = Docs -> count;
+
+	writer -> fptr = fopen( writer -> temp_name, "wb" );
+	writer -> entries = tmpfile();
+	writer -> words = tmpfile();
+
+	if( writer -> fptr == NULL || writer -> entries == NULL || writer -> words == NULL )
+	{
+		perror("[INFO]: Could not open binary index for writing");
+		Close_Index_Writer( writer, FAILURE );
+		return NULL;
+	}
+
+	if( Write_Doc_Table( writer, Docs ) == FAILURE )
+	{
+		Close_Index_Writer( writer, FAILURE );
+		return NULL;
+	}
+
+	return writer;
+}
+
+
+/**/
+Status Index_Writer_Term( INDEX_WRITER *writer, const char *word, const unsigned char *postings, unsigned int length, No_Of_Files file_count )
+{
+	TERM_ENTRY entry;
+	size_t word_length = strlen( word ) + 1;
+
+	entry.word_offset = writer -> word_offset;
+	entry.post_offset = writer -> header.post_size;
+	entry.post_len = length;
+	entry.file_count = ( uint32_t ) file_count;
+
+	writer -> word_offset += word_length;
+	writer -> header.post_size += length;
+	writer -> header.term_count++;
+
+	if( fwrite( &entry, sizeof( entry ), 1, writer -> entries ) != 1 || fwrite( word, 1, word_length, writer -> words ) != word_length )
+		return FAILURE;
+
+	return Write_Section( writer -> fptr, postings, length, &writer -> header.post_crc );
+}
+
+
+/* Append a spilled dictionary part to the index, folding it into the dictionary CRC */
+static Status Copy_Spill( INDEX_WRITER *writer, FILE *spill )
+{
+	unsigned char buffer[1 << 16];
+	size_t length;
+
+	if( fflush( spill ) != 0 || fseek( spill, 0, SEEK_SET ) != 0 )
+		return FAILURE;
+
+	while( ( length = fread( buffer, 1, sizeof( buffer ), spill ) ) > 0 )
+		if( Write_Section( writer -> fptr, buffer, length, &writer -> header.term_crc ) == FAILURE )
+			return FAILURE;
+
+	return ferror( spill ) ? FAILURE : SUCCESS;
+}
+
+
+/* Dictionary after the postings, then the final header */
+static Status Finish_Index( INDEX_WRITER *writer )
+{
+	INDEX_HEADER *header = &writer -> header;
+
+	writer -> offset += header -> post_size;
+
+	if( Pad_Section( writer -> fptr, &writer -> offset ) == FAILURE )
+		return FAILURE;
+
+	header -> term_offset = writer -> offset;
+	header -> term_size = header -> term_count * sizeof( TERM_ENTRY ) + writer -> word_offset;
+
+	if( Copy_Spill( writer, writer -> entries ) == FAILURE || Copy_Spill( writer, writer -> words ) == FAILURE )
+		return FAILURE;
+
+	header -> header_crc = 0;
+	header -> header_crc = Crc32( 0, header, sizeof( *header ) );
+
+	if( fseek( writer -> fptr, 0, SEEK_SET ) != 0 || fwrite( header, sizeof( *header ), 1, writer -> fptr ) != 1 )
+		return FAILURE;
+
+	return SUCCESS;
+}
+
+
+/**/
+Status Close_Index_Writer( INDEX_WRITER *writer, Status status )
+{
+	if( status == SUCCESS )
+		status = Finish_Index( writer );
+
+	if( writer -> fptr != NULL && Sync_Close( writer -> fptr ) == FAILURE )
+		status = FAILURE;
+
+	if( writer -> entries != NULL )
+		fclose( writer -> entries );
+
+	if( writer -> words != NULL )
+		fclose( writer -> words );
+
+	if( status == SUCCESS && Commit_File( writer -> temp_name, writer -> name ) == FAILURE )
+		status = FAILURE;
+
+	if( status == FAILURE && writer -> fptr != NULL )
+		remove( writer -> temp_name );
+
+	free( writer );
+	return status;
+}
+
+
+/**/
+Status Save_Binary_Index( HASH_T *Hash_T, const char *filename )
+{
+	// Heap words must be in frozen form, without deleted documents, so their bytes can be written directly
+	if( Compact_Index( Hash_T ) == FAILURE || Freeze_Hash_Table( Hash_T ) == FAILURE || Update_Term_Dict( Hash_T ) == FAILURE )
+		return FAILURE;
+
+	INDEX_WRITER *writer = Open_Index_Writer( filename, &Hash_T -> Docs, Hash_T -> Positional );
+	if( writer == NULL )
+	{
+		printf("\n[INFO]: Could not write binary index '%s'\n", filename );
+		return FAILURE;
+	}
+
+	// The term dictionary is already in the on-disk order
+	size_t term_count = Term_Dict_Size( Hash_T );
+	Status status = SUCCESS;
+
+	for( size_t i = 0; i < term_count && status == SUCCESS; i++ )
+	{
+		TERM_REF term;
+		Term_Dict_Ref( Hash_T, i, &term );
+
+		const unsigned char *bytes = term.node ? term.node -> Postings : term.postings;
+		unsigned int length = term.node ? term.node -> Postings_len : term.postings_len;
+
+		status = Index_Writer_Term( writer, term.word, bytes, length, term.file_count );
+	}
+
+	if( Close_Index_Writer( writer, status ) == FAILURE )
+	{
+		printf("\n[INFO]: Could not write binary index '%s'\n", filename );
+		return FAILURE;
+	}
+
+	printf("\n[INFO]: Binary index saved to '%s' ( %zu words, %zu documents )\n",
+			filename, term_count, Hash_T -> Docs.count );
+
+	return SUCCESS;
+}
+
+
+/* Structural checks; every offset read later is proven in range here */
+static Status Validate_Mapping( MAPPED_INDEX *map )
+{
+	if( map -> length < sizeof( INDEX_HEADER ) )
+		return FAILURE;
+
+	INDEX_HEADER header = *( const INDEX_HEADER* ) map -> base;
+
+	if( memcmp( header.magic, INDEX_MAGIC, sizeof( INDEX_MAGIC ) ) != 0 || header.version != INDEX_VERSION )
+		return FAILURE;
+
+	uint32_t stored = header.header_crc;
+	header.header_crc = 0;
+	if( Crc32( 0, &header, sizeof( header ) ) != stored )
+		return FAILURE;
+
+	if( header.doc_offset > map -> length || header.doc_size > map -> length - header.doc_offset ||
+		header.term_offset > map -> length || header.term_size > map -> length - header.term_offset ||
+		header.post_offset > map -> length || header.post_size > map -> length - header.post_offset )
+		return FAILURE;
+
+	if( header.doc_count > header.doc_size / sizeof( uint64_t ) ||
+		header.term_count > header.term_size / sizeof( TERM_ENTRY ) ||
+		( header.doc_offset & 7 ) || ( header.term_offset & 7 ) )
+		return FAILURE;
+
+	const unsigned char *base = map -> base;
+
+	if( Crc32( 0, base + header.doc_offset, header.doc_size ) != header.doc_crc ||
+		Crc32( 0, base + header.term_offset, header.term_size ) != header.term_crc )
+		return FAILURE;
+
+	// Name and word pools must end in NUL and every offset must land inside them
+	const uint64_t *name_offset = ( const uint64_t* )( base + header.doc_offset );
+	uint64_t names_start = header.doc_count * sizeof( uint64_t );
+
+	if( header.doc_count > 0 && base[ header.doc_offset + header.doc_size - 1 ] != '\0' )
+		return FAILURE;
+
+	for( uint64_t i = 0; i < header.doc_count; i++ )
+		if( name_offset[i] < names_start || name_offset[i] >= header.doc_size )
+			return FAILURE;
+
+	const TERM_ENTRY *entry = ( const TERM_ENTRY* )( base + header.term_offset );
+	uint64_t words_size = header.term_size - header.term_count * sizeof( TERM_ENTRY );
+
+	if( header.term_count > 0 && ( words_size == 0 || base[ header.term_offset + header.term_size - 1 ] != '\0' ) )
+		return FAILURE;
+
+	for( uint64_t i = 0; i < header.term_count; i++ )
+	{
+		if( entry[i].word_offset >= words_size ||
+			entry[i].post_offset > header.post_size ||
+			entry[i].post_len > header.post_size - entry[i].post_offset ||
+			entry[i].post_len < Posting_Skip_Bytes( entry[i].file_count ) )
+			return FAILURE;
+	}
+
+	map -> header = ( const INDEX_HEADER* ) base;
+	map -> term = entry;
+	map -> words = ( const char* )( base + header.term_offset + header.term_count * sizeof( TERM_ENTRY ) );
+	map -> postings = base + header.post_offset;
+
+	return SUCCESS;
+}
+
+
+/**/
+Status Load_Binary_Index( HASH_T *Hash_T, const char *filename )
+{
+	int fd = open( filename, O_RDONLY );
+	if( fd < 0 )
+	{
+		printf("\n[INFO]: Could not open '%s'. File not Found\n", filename );
+		return FAILURE;
+	}
+
+	struct stat info;
+	if( fstat( fd, &info ) != 0 || info.st_size == 0 )
+	{
+		printf("\n[INFO]: '%s' is Empty. Nothing to load.\n", filename );
+		close( fd );
+		return FAILURE;
+	}
+
+	void *base = mmap( NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	close( fd );
+
+	if( base == MAP_FAILED )
+	{
+		perror("[INFO]: mmap failed");
+		return FAILURE;
+	}
+
+	MAPPED_INDEX *map = malloc( sizeof( MAPPED_INDEX ) );
+	if( map == NULL )
+	{
+		munmap( base, info.st_size );
+		return FAILURE;
+	}
+
+	map -> base = base;
+	map -> length = info.st_size;
+	map -> materialised = 0;
+
+	if( Validate_Mapping( map ) == FAILURE )
+	{
+		printf("\n[INFO]: '%s' is not a valid binary index ( corrupt or wrong version )\n", filename );
+		munmap( base, info.st_size );
+		free( map );
+		return FAILURE;
+	}
+
+	// The new table is assembled aside; the current database is replaced only once it is complete
+	HASH_T loaded;
+
+	if( Initialise_Hash_Table( &loaded ) == FAILURE )
+	{
+		munmap( base, info.st_size );
+		free( map );
+		return FAILURE;
+	}
+
+	const uint64_t *name_offset = ( const uint64_t* )( ( const char* ) base + map -> header -> doc_offset );
+
+	for( uint64_t i = 0; i < map -> header -> doc_count; i++ )
+	{
+		DOC_ID doc_id;
+		const char *name = ( const char* ) base + map -> header -> doc_offset + name_offset[i];
+
+		if( Register_Document( &loaded.Docs, name, &doc_id ) == FAILURE || doc_id != i )
+		{
+			printf("\n[INFO]: '%s' has an invalid document table\n", filename );
+			Free_Hash_Table( &loaded );
+			munmap( base, info.st_size );
+			free( map );
+			return FAILURE;
+		}
+	}
+
+	Free_Hash_Table( Hash_T );
+	*Hash_T = loaded;
+
+	Hash_T -> Mapped = map;
+	Hash_T -> Docs.lengths_stale = 1;
+	Hash_T -> Positional = ( map -> header -> flags & INDEX_POSITIONAL ) != 0;
+
+	// Queries must be normalized the way the index was built
+	unsigned stages = map -> header -> flags & ~INDEX_POSITIONAL;
+
+	if( stages != Normalizer_Flags() )
+	{
+		printf("\n[INFO]: Index was built with normalization flags 0x%x, switching from 0x%x\n",
+				stages, Normalizer_Flags() );
+		Set_Normalizer( stages );
+	}
+
+	printf("\n[INFO]: Binary index '%s' mapped ( %lu words, %lu documents, %zu bytes )\n",
+			filename,
+			( unsigned long ) map -> header -> term_count,
+			( unsigned long ) map -> header -> doc_count,
+			map -> length );
+
+	return SUCCESS;
+}
+
+
+/**/
+Status Verify_Binary_Index( HASH_T *Hash_T )
+{
+	MAPPED_INDEX *map = Hash_T -> Mapped;
+
+	if( map == NULL )
+		return FAILURE;
+
+	if( Crc32( 0, map -> postings, map -> header -> post_size ) != map -> header -> post_crc )
+	{
+		printf("\n[INFO]: Postings checksum mismatch. Index is corrupt.\n");
+		return FAILURE;
+	}
+
+	printf("\n[INFO]: Postings checksum verified\n");
+	return SUCCESS;
+}
+
+
+/**/
+void Unmap_Binary_Index( HASH_T *Hash_T )
+{
+	if( Hash_T -> Mapped == NULL )
+		return;
+
+	munmap( Hash_T -> Mapped -> base, Hash_T -> Mapped -> length );
+	free( Hash_T -> Mapped );
+	Hash_T -> Mapped = NULL;
+}
+
+
+/**/
+long Mapped_Find_Term( MAPPED_INDEX *map, const char *word )
+{
+	long low = 0;
+	long high = ( long ) map -> header -> term_count - 1;
+
+	while( low <= high )
+	{
+		long mid = low + ( high - low ) / 2;
+		int cmp = Compare_Terms( map -> words + map -> term[mid].word_offset, word );
+
+		if( cmp == 0 )
+			return mid;
+
+		if( cmp < 0 )
+			low = mid + 1;
+		else
+			high = mid - 1;
+	}
+
+	return -1;
+}
+
+
+/**/
+void Mapped_Term_Ref( MAPPED_INDEX *map, long pos, TERM_REF *ref )
+{
+	const TERM_ENTRY *entry = &map -> term[pos];
+
+	ref -> word = map -> words + entry -> word_offset;
+	ref -> file_count = entry -> file_count;
+	ref -> node = NULL;
+	ref -> postings = map -> postings + entry -> post_offset;
+	ref -> postings_len = entry -> post_len;
+	ref -> positional = ( map -> header -> flags & INDEX_POSITIONAL ) != 0;
+	ref -> docs = NULL;
+	ref -> doc_limit = ( DOC_ID ) map -> header -> doc_count;
+}
+
+
+/* Heap MAIN_NODE for the mapped term at pos, its postings left in the mapping */
+static MAIN_NODE* Link_Mapped_Term( HASH_T *Hash_T, MAPPED_INDEX *map, long pos )
+{
+	TERM_REF ref;
+	Mapped_Term_Ref( map, pos, &ref );
+
+	size_t length = strlen( ref.word );
+	MAIN_NODE *node = Arena_Alloc( &Hash_T -> Main_arena, sizeof( MAIN_NODE ) + length + 1 );
+	if( node == NULL )
+		return NULL;
+
+	memcpy( node -> word, ref.word, length + 1 );
+	node -> file_count = ref.file_count;
+	node -> Next_Sub_node = NULL;
+	node -> Last_Sub_node = NULL;
+	node -> Postings = ( unsigned char* ) ref.postings;      // read-only, thawed or chained after before any change
+	node -> Postings_len = ref.postings_len;
+	node -> Postings_count = ref.file_count;
+
+	if( Link_Main_Node( Hash_T, node ) == FAILURE )
+		return NULL;
+
+	return node;
+}
+
+
+/**/
+Status Materialise_Mapped_Index( HASH_T *Hash_T )
+{
+	MAPPED_INDEX *map = Hash_T -> Mapped;
+
+	if( map == NULL || map -> materialised )
+		return SUCCESS;
+
+	// Words a re-index already copied hold newer postings than their mapped entries
+	int shadowed = Hash_T -> word_total > 0;
+
+	for( uint64_t i = 0; i < map -> header -> term_count; i++ )
+	{
+		if( shadowed && Find_Main_Node( Hash_T, map -> words + map -> term[i].word_offset ) != NULL )
+			continue;
+
+		if( Link_Mapped_Term( Hash_T, map, i ) == NULL )
+			return FAILURE;
+	}
+
+	map -> materialised = 1;
+	return SUCCESS;
+}
+
+
+/**/
+Status Materialise_Mapped_Term( HASH_T *Hash_T, const char *word, MAIN_NODE **node )
+{
+	MAPPED_INDEX *map = Hash_T -> Mapped;
+	*node = NULL;
+
+	if( map == NULL || map -> materialised )
+		return SUCCESS;
+
+	long pos = Mapped_Find_Term( map, word );
+
+	if( pos >= 0 && ( *node = Link_Mapped_Term( Hash_T, map, pos ) ) == NULL )
+		return FAILURE;
+
+	return SUCCESS;
+}
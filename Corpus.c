@@ -0,0 +1,421 @@
+/*******************************************************************************************************************************************************************
+ * File        : Corpus.c
+ * Project     : Inverted Search Engine (Project-2)
+ *
+ * Description :
+ *      Streaming file discovery for Create_DataBase(). The file list may name files and
+ *      directories; a walker thread expands directories recursively and feeds the paths found,
+ *      in a fixed order, through a bounded queue to the indexer. Discovery and indexing overlap,
+ *      and neither the paths of a large tree nor open file handles pile up in memory:
+ *
+ *          walker  : list entry → file   → queue
+ *                                → directory → sorted entries → files → queue, sub-directories → walked
+ *          indexer : Next_Corpus_File() → open → index → close
+ *
+ * Function Overview :
+ *
+ *      → Open_Corpus( LIST *head )
+ *            • Starts the walker over the list entries in list order; NULL on failure
+ *
+ *      → Next_Corpus_File( CORPUS *corpus, char *path )
+ *            • Copies the next file into path ( FILENAME_MAX bytes ), waiting for the walker
+ *            • FAILURE once every entry is walked and the queue is empty
+ *
+ *      → Skip_Corpus_File( CORPUS *corpus )
+ *            • Counts a file the indexer could not open, so the report covers it; any thread may call it
+ *
+ *      → Close_Corpus( CORPUS *corpus )
+ *            • Stops the walker if it is still running, frees what is left and reports the walk
+ *
+ * Walk Rules :
+ *      • Entries of a directory are visited in strcmp order, so a tree always yields the same
+ *        doc ids, whatever the file system returns and however many indexing threads run
+ *      • Only files matching --include ( Check_Ext(), "*.txt" by default ) that are non-empty
+ *        regular files are queued; hidden entries ( ".name" ) are not walked
+ *      • Links to files are indexed, links to directories are not followed ( no cycles ); a
+ *        second path to the same file is caught by File_Already_Indexed()
+ *
+ * Notes :
+ *      • A directory is read completely and closed before its entries are visited, so the walk
+ *        holds one directory handle at a time, at any depth
+ *      • Memory is the queue ( CORPUS_QUEUE_SIZE paths ) plus the names of the directories on
+ *        the current path of the walk
+ *      • List entries that are files were validated by Read_and_Validate() and are queued as is
+ *
+ *******************************************************************************************************************************************************************/
+
+
+#include "Inverted_Search.h"
+#include "Types.h"
+#include "Validate.h"
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+
+typedef struct Walk_Frame
+{
+	char *path;
+	char **name;                    // entries of path, sorted
+	size_t count;
+	size_t next;                    // next entry to visit
+
+} WALK_FRAME;
+
+
+struct Corpus
+{
+	LIST *source;
+
+	char *queue[CORPUS_QUEUE_SIZE];
+	size_t head;                    // oldest queued path
+	size_t count;
+	int done;                       // the walker has finished
+	int stop;                       // Close_Corpus() before the end
+
+	long directories;               // walker counters, read after it is joined
+	long found;
+	long skipped;
+	long unopened;                  // found, but the indexer could not open them; under lock
+
+	pthread_t walker;
+	pthread_mutex_t lock;
+	pthread_cond_t changed;
+
+};
+
+
+/* Queue one path, waiting while the queue is full; the queue owns path afterwards */
+static Status Push_Path( CORPUS *corpus, char *path )
+{
+	if( path == NULL )
+		return FAILURE;
+
+	pthread_mutex_lock( &corpus -> lock );
+
+	while( corpus -> count == CORPUS_QUEUE_SIZE && !corpus -> stop )
+		pthread_cond_wait( &corpus -> changed, &corpus -> lock );
+
+	if( corpus -> stop )
+	{
+		pthread_mutex_unlock( &corpus -> lock );
+		free( path );
+		return FAILURE;
+	}
+
+	corpus -> queue[ ( corpus -> head + corpus -> count ) % CORPUS_QUEUE_SIZE ] = path;
+	corpus -> count++;
+
+	pthread_cond_broadcast( &corpus -> changed );
+	pthread_mutex_unlock( &corpus -> lock );
+
+	return SUCCESS;
+}
+
+
+/* Whether Close_Corpus() asked the walker to stop */
+static int Corpus_Stopped( CORPUS *corpus )
+{
+	pthread_mutex_lock( &corpus -> lock );
+	int stop = corpus -> stop;
+	pthread_mutex_unlock( &corpus -> lock );
+
+	return stop;
+}
+
+
+/* qsort comparator for directory entries */
+static int Compare_Names( const void *a, const void *b )
+{
+	return strcmp( *( char* const* ) a, *( char* const* ) b );
+}
+
+
+/* directory + "/" + name, malloc'd */
+static char* Join_Path( const char *directory, const char *name )
+{
+	size_t length = strlen( directory );
+	int slash = length > 0 && directory[ length - 1 ] != '/';
+
+	char *path = malloc( length + slash + strlen( name ) + 1 );
+	if( path == NULL )
+		return NULL;
+
+	memcpy( path, directory, length );
+	if( slash )
+		path[ length++ ] = '/';
+
+	strcpy( path + length, name );
+	return path;
+}
+
+
+/* Read the visible entries of path into frame, sorted; frame owns path afterwards */
+static Status Read_Directory( WALK_FRAME *frame, char *path )
+{
+	frame -> path = path;
+	frame -> name = NULL;
+	frame -> count = 0;
+	frame -> next = 0;
+
+	DIR *dir = opendir( path );
+	if( dir == NULL )
+	{
+		printf("[INFO]: Could not open directory '%s'. Skipping...\n", path );
+		return FAILURE;
+	}
+
+	size_t capacity = 0;
+	struct dirent *entry;
+	Status status = SUCCESS;
+
+	while( status == SUCCESS && ( entry = readdir( dir ) ) != NULL )
+	{
+		// Hidden entries, "." and ".." included, are not walked
+		if( entry -> d_name[0] == '.' )
+			continue;
+
+		if( frame -> count == capacity )
+		{
+			size_t grown = capacity ? capacity * 2 : 16;
+			char **name = realloc( frame -> name, grown * sizeof( char* ) );
+
+			if( name == NULL )
+			{
+				status = FAILURE;
+				break;
+			}
+
+			frame -> name = name;
+			capacity = grown;
+		}
+
+		frame -> name[ frame -> count ] = strdup( entry -> d_name );
+
+		if( frame -> name[ frame -> count ] == NULL )
+			status = FAILURE;
+		else
+			frame -> count++;
+	}
+
+	closedir( dir );
+
+	if( status == FAILURE )
+		printf("[INFO]: Out of memory reading directory '%s'\n", path );
+
+	qsort( frame -> name, frame -> count, sizeof( char* ), Compare_Names );
+	return status;
+}
+
+
+/* Release a frame and everything it owns */
+static void Free_Frame( WALK_FRAME *frame )
+{
+	for( size_t i = 0; i < frame -> count; i++ )
+		free( frame -> name[i] );
+
+	free( frame -> name );
+	free( frame -> path );
+}
+
+
+/* Queue every matching file below root, depth first, entries in sorted order */
+static void Walk_Directory( CORPUS *corpus, const char *root )
+{
+	WALK_FRAME *frame = NULL;
+	size_t depth = 0;
+	size_t capacity = 0;
+	char *path = strdup( root );
+
+	// path is the next directory to enter; the loop owns it until a frame does
+	while( path != NULL || depth > 0 )
+	{
+		if( path != NULL )
+		{
+			if( depth == capacity )
+			{
+				size_t grown = capacity ? capacity * 2 : 16;
+				WALK_FRAME *bigger = realloc( frame, grown * sizeof( WALK_FRAME ) );
+
+				if( bigger == NULL )
+				{
+					free( path );
+					break;
+				}
+
+				frame = bigger;
+				capacity = grown;
+			}
+
+			// An unreadable directory still gets a frame, with no entries
+			Read_Directory( &frame[ depth++ ], path );
+			path = NULL;
+			corpus -> directories++;
+
+			if( Corpus_Stopped( corpus ) )
+				break;
+		}
+
+		WALK_FRAME *top = &frame[ depth - 1 ];
+
+		if( top -> next == top -> count )
+		{
+			Free_Frame( top );
+			depth--;
+			continue;
+		}
+
+		char *full = Join_Path( top -> path, top -> name[ top -> next++ ] );
+		if( full == NULL )
+			break;
+
+		struct stat st;
+
+		if( lstat( full, &st ) == 0 && S_ISDIR( st.st_mode ) )
+		{
+			path = full;
+			continue;
+		}
+
+		// stat() follows a link: a link to a file is indexed, a link to a directory is not followed
+		if( Check_Ext( full ) == SUCCESS )
+		{
+			if( strlen( full ) < FILENAME_MAX && stat( full, &st ) == 0 && S_ISREG( st.st_mode ) && st.st_size > 0 )
+			{
+				corpus -> found++;
+
+				if( Push_Path( corpus, full ) == FAILURE )
+					break;
+
+				continue;
+			}
+
+			corpus -> skipped++;
+		}
+
+		free( full );
+	}
+
+	while( depth > 0 )
+		Free_Frame( &frame[ --depth ] );
+
+	free( frame );
+}
+
+
+/* Walker thread: list entries in order, directories expanded */
+static void* Corpus_Walker( void *arg )
+{
+	CORPUS *corpus = arg;
+
+	for( LIST *source = corpus -> source; source != NULL && !Corpus_Stopped( corpus ); source = source -> link )
+	{
+		struct stat st;
+
+		if( stat( source -> FILENAME, &st ) == 0 && S_ISDIR( st.st_mode ) )
+			Walk_Directory( corpus, source -> FILENAME );
+		else if( Push_Path( corpus, strdup( source -> FILENAME ) ) == FAILURE )
+			break;
+	}
+
+	pthread_mutex_lock( &corpus -> lock );
+	corpus -> done = 1;
+	pthread_cond_broadcast( &corpus -> changed );
+	pthread_mutex_unlock( &corpus -> lock );
+
+	return NULL;
+}
+
+
+/**/
+CORPUS* Open_Corpus( LIST *head )
+{
+	CORPUS *corpus = calloc( 1, sizeof( CORPUS ) );
+	if( corpus == NULL )
+	{
+		perror("Malloc failed for file discovery");
+		return NULL;
+	}
+
+	corpus -> source = head;
+	pthread_mutex_init( &corpus -> lock, NULL );
+	pthread_cond_init( &corpus -> changed, NULL );
+
+	if( pthread_create( &corpus -> walker, NULL, Corpus_Walker, corpus ) != 0 )
+	{
+		printf("[INFO]: Could not start the file discovery thread\n");
+		pthread_mutex_destroy( &corpus -> lock );
+		pthread_cond_destroy( &corpus -> changed );
+		free( corpus );
+		return NULL;
+	}
+
+	return corpus;
+}
+
+
+/**/
+Status Next_Corpus_File( CORPUS *corpus, char *path )
+{
+	pthread_mutex_lock( &corpus -> lock );
+
+	while( corpus -> count == 0 && !corpus -> done )
+		pthread_cond_wait( &corpus -> changed, &corpus -> lock );
+
+	if( corpus -> count == 0 )
+	{
+		pthread_mutex_unlock( &corpus -> lock );
+		return FAILURE;
+	}
+
+	char *next = corpus -> queue[ corpus -> head ];
+	corpus -> head = ( corpus -> head + 1 ) % CORPUS_QUEUE_SIZE;
+	corpus -> count--;
+
+	pthread_cond_broadcast( &corpus -> changed );
+	pthread_mutex_unlock( &corpus -> lock );
+
+	snprintf( path, FILENAME_MAX, "%s", next );
+	free( next );
+
+	return SUCCESS;
+}
+
+
+/**/
+void Skip_Corpus_File( CORPUS *corpus )
+{
+	pthread_mutex_lock( &corpus -> lock );
+	corpus -> unopened++;
+	pthread_mutex_unlock( &corpus -> lock );
+}
+
+
+/**/
+void Close_Corpus( CORPUS *corpus )
+{
+	if( corpus == NULL )
+		return;
+
+	pthread_mutex_lock( &corpus -> lock );
+	corpus -> stop = 1;
+	pthread_cond_broadcast( &corpus -> changed );
+	pthread_mutex_unlock( &corpus -> lock );
+
+	pthread_join( corpus -> walker, NULL );
+
+	for( ; corpus -> count > 0; corpus -> count-- )
+	{
+		free( corpus -> queue[ corpus -> head ] );
+		corpus -> head = ( corpus -> head + 1 ) % CORPUS_QUEUE_SIZE;
+	}
+
+	if( corpus -> directories > 0 )
+		printf("[INFO]: %ld file%s found in %ld director%s, %ld skipped ( empty or unreadable )\n",
+				corpus -> found, corpus -> found == 1 ? "" : "s",
+				corpus -> directories, corpus -> directories == 1 ? "y" : "ies", corpus -> skipped + corpus -> unopened );
+
+	pthread_mutex_destroy( &corpus -> lock );
+	pthread_cond_destroy( &corpus -> changed );
+	free( corpus );
+}
@@ -14,50 +14,77 @@
  * Function Overview :
  *
  *      → Create_DataBase( HASH_T *Hash_T, LIST **head )
- *            • Scans each validated file from the file list
+ *            • Scans each validated file from the file list, and every matching file below the
+ *              listed directories as the walker (Corpus.c) finds it
+ *            • Opens each file only while it is indexed, so one file handle is in use at a time
  *            • Tokenizes every word and inserts into hash table using hashing
  *            • Skips files that are already indexed earlier
+ *            • Materialises a mapped binary index before adding to it
+ *            • Registers each new file in the document table to get its DOC_ID, with its file identity
  *
- *      → Initialise_Hash_Table( HASH_T *Hash_T )
- *            • Sets index value and resets link pointer for all 27 buckets
+ *      → Index_File( HASH_T *Hash_T, FILE *fptr, DOC_ID doc_id )
+ *            • Tokenizes one open file (Tokenizer.c), normalizes every token (Normalize.c)
+ *              and inserts the resulting terms under doc_id
+ *            • Records the document length ( terms inserted ) for ranked search
+ *            • With --positions every occurrence also records its term position in the file
+ *            • Shared by the sequential and the parallel build (Parallel_Build.c)
  *
  *      → Find_Index( char chr )
- *            • Maps first character of word into bucket index
+ *            • Maps first character of word into its letter group (Display / Save order)
  *            • 'a'–'z' → 0–25
  *            • Others → 26
  *
- *      → Create_Main_Node( char* word, char* filename )
- *            • Allocates + initializes a new MAIN_NODE
+ *      → Create_Main_Node( HASH_T *Hash_T, char* word, DOC_ID doc_id )
+ *            • Allocates a new MAIN_NODE from the MAIN_NODE arena, sized to the word
  *            • Automatically creates its first SUB_NODE entry
  *
- *      → Create_Sub_Node( char* filename )
- *            • Allocates + initializes a new SUB_NODE entry for filename
+ *      → Create_Sub_Node( HASH_T *Hash_T, DOC_ID doc_id )
+ *            • Allocates a new SUB_NODE entry for the document id from the SUB_NODE arena
  *
- *      → Insert_To_Hash_Table( int index, char* word, char* filename, HASH_T *Hash_T )
+ *      → Insert_To_Hash_Table( char* word, DOC_ID doc_id, HASH_T *Hash_T )
+ *            • One occurrence of word in doc_id ( Add_Posting with count 1 )
+ *
+ *      → Add_Posting( HASH_T *Hash_T, char* word, DOC_ID doc_id, Word_Count count )
+ *            • Adds count occurrences at once; used for bulk loading saved databases
+ *            • Looks the word up through the whole-word hash (Hash_Table.c)
  *            • Handles all insertion cases:
  *                 1. Brand-new word → new MAIN_NODE
  *                 2. Word exists in DB → update existing structure
- *                 3. File has word already → just increment count
+ *                 3. File has word already → just add to its count
  *                 4. File is new for this word → attach new SUB_NODE
+ *            • Thaws a frozen word (Postings.c) before modifying it
+ *
+ *      → Add_Posting_Positions( HASH_T *Hash_T, char* word, DOC_ID doc_id, Word_Count count,
+ *                               const unsigned char *deltas )
+ *            • Add_Posting() plus count varint position deltas ( from 0 ) for a positional table;
+ *              deltas are ignored when the table keeps counts only
+ *
+ *      → Add_Term_Posting( HASH_T *Hash_T, MAIN_NODE **node, char* word, DOC_ID doc_id, Word_Count count,
+ *                          const unsigned char *deltas )
+ *            • Add_Posting_Positions() for a run of postings of one word: *node starts NULL and
+ *              keeps the word's MAIN_NODE, so the word is looked up once per run ( merges )
  *
  *      → File_Already_Indexed( const char *fname, HASH_T *Hash_T )
  *            • Prevents duplicate re-indexing of already processed files
+ *            • Answered by the document table (Doc_Table.c) in constant time, by name and then by
+ *              file identity, so another path, a symlink or a hard link to an indexed file is caught
+ *            • A removed file counts as not indexed
  *
  * Data Structure :
- *      HASH_T
+ *      HASH_T (hash buckets + 27 letter groups)
  *         ↳ MAIN_NODE (unique words)
- *               ↳ SUB_NODE (filename, count)
+ *               ↳ SUB_NODE (doc id, count)   → filename via DOC_TABLE
  *
  * Return Behavior :
  *      • All creation/insert functions → SUCCESS on proper insertion
- *      • Memory allocation failures → FAILURE
+ *      • Memory allocation failures → FAILURE (nodes are owned by the table arenas)
  *      • Duplicate indexing detection → EXISTS / NOT_EXISTS
  *
  * Notes :
- *      • fscanf() tokenization uses whitespace as separator by default
- *      • Word matching is case-sensitive (storage-exact)
- *      • fptr must already be open when passed to Create_DataBase()
- *      • Hash insertion always maintains forward traversal order
+ *      • Tokenization uses whitespace as separator, exactly as fscanf( "%s" ) did
+ *      • Terms are stored normalized; with --raw matching is case-sensitive (storage-exact)
+ *      • fptr must already be open when passed to Index_File(); list nodes carry no open files
+ *      • Letter groups always maintain forward insertion order
  *
  *******************************************************************************************************************************************************************/
 
@@ -76,45 +103,101 @@ Status Create_DataBase( HASH_T *Hash_T, LIST **head )
 		return FAILURE;
 	}
 
-	LIST *Ltemp = *head;
+	Adopt_Posting_Form( Hash_T );
+
+	// A mapped binary index is read-only; copy its dictionary into the heap table first
+	if( Materialise_Mapped_Index( Hash_T ) == FAILURE )
+		return FAILURE;
+
+	CORPUS *corpus = Open_Corpus( *head );
+	if( corpus == NULL )
+		return FAILURE;
+
+	char filename[FILENAME_MAX];
 
-	while( Ltemp != NULL )
+	while( Next_Corpus_File( corpus, filename ) == SUCCESS )
 	{
 
 		// After update, check if any file is already indexed to ensure no duplicate it found
-		if ( File_Already_Indexed( Ltemp -> FILENAME, Hash_T ) == EXISTS )
+		if ( File_Already_Indexed( filename, Hash_T ) == EXISTS )
         {
-            printf("[INFO]: '%s' already present in database. Skipping...\n",
-                   Ltemp -> FILENAME );
-
-            Ltemp = Ltemp -> link;
+            printf("[INFO]: '%s' already present in database. Skipping...\n", filename );
             continue;
         }
 
+		FILE *fptr = fopen( filename, "r" );
+		if( fptr == NULL )
+		{
+			printf("[INFO]: Could not open '%s'. Skipping...\n", filename );
+			Skip_Corpus_File( corpus );
+			continue;
+		}
 
-		char str[MAX_WORD_LENGTH];
-
-		while( fscanf( Ltemp -> fptr, "%s", str ) != EOF )
+		DOC_ID doc_id;
+		if( Register_Document( &Hash_T -> Docs, filename, &doc_id ) == FAILURE )
 		{
-			int index = Find_Index( str[0] );
-			Insert_To_Hash_Table( index, str, Ltemp -> FILENAME, Hash_T );
+			printf("[INFO]: Could not register '%s'. Skipping...\n", filename );
+
+			fclose( fptr );
+			continue;
 		}
 
-		Ltemp = Ltemp -> link;
+		Record_Document_File( &Hash_T -> Docs, doc_id, filename, fptr );
+		Index_File( Hash_T, fptr, doc_id );
+
+		fclose( fptr );
 	}
 
+	Close_Corpus( corpus );
+
 	return SUCCESS;
 }
 
 
-/**/
-void Initialise_Hash_Table( HASH_T *Hash_T )
+typedef struct Index_Target
 {
-	for( int i = 0; i < 27; i++ )
+	HASH_T *Hash_T;
+	DOC_ID doc_id;
+	Word_Count length;              // terms inserted, the document length for ranking
+
+} INDEX_TARGET;
+
+
+/* TOKEN_SINK: one occurrence per normalized token */
+static Status Index_Token( void *context, char *token )
+{
+	INDEX_TARGET *target = context;
+	WORD term;
+
+	if( Normalize_Word( token, term ) != SUCCESS )
 	{
-		Hash_T[i].index = i;
-		Hash_T[i].link = NULL;
+		target -> Hash_T -> Tokens.dropped++;
+		return SUCCESS;
 	}
+
+	// The position of a term is the number of terms indexed before it in the file
+	if( target -> Hash_T -> Positional )
+	{
+		unsigned char delta[POSITION_MAX_BYTES];
+		Varint_Encode( delta, target -> length++ );
+
+		return Add_Posting_Positions( target -> Hash_T, term, target -> doc_id, 1, delta );
+	}
+
+	target -> length++;
+	return Insert_To_Hash_Table( term, target -> doc_id, target -> Hash_T );
+}
+
+
+/**/
+Status Index_File( HASH_T *Hash_T, FILE *fptr, DOC_ID doc_id )
+{
+	INDEX_TARGET target = { Hash_T, doc_id, 0 };
+
+	Status status = Tokenize_File( fptr, Index_Token, &target, &Hash_T -> Tokens );
+
+	Set_Document_Length( &Hash_T -> Docs, doc_id, target.length );
+	return status;
 }
 
 
@@ -130,27 +213,32 @@ INDEX Find_Index( char chr )
 
 
 /**/
-MAIN_NODE* Create_Main_Node( char* word, char* filename )
+MAIN_NODE* Create_Main_Node( HASH_T *Hash_T, char* word, DOC_ID doc_id )
 {
-	MAIN_NODE* New_main = malloc( sizeof( MAIN_NODE ) );
+	size_t length = strlen( word );
+
+	MAIN_NODE* New_main = Arena_Alloc( &Hash_T -> Main_arena, sizeof( MAIN_NODE ) + length + 1 );
 	if( New_main == NULL )
 	{
-		perror("Malloc failed for MAIN_NODE");
 		return NULL;
 	}
 
-	strcpy( New_main -> word, word );
+	memcpy( New_main -> word, word, length + 1 );
 	New_main -> file_count = 1;
 	New_main -> Next_Main_node = NULL;
+	New_main -> Next_Hash_node = NULL;
+	New_main -> Postings = NULL;
+	New_main -> Postings_len = 0;
+	New_main -> Postings_count = 0;
 
-	SUB_NODE* First_sub = Create_Sub_Node( filename );
+	SUB_NODE* First_sub = Create_Sub_Node( Hash_T, doc_id );
 	if( First_sub == NULL )
 	{
-		free( New_main );
 		return NULL;
 	}
 
 	New_main -> Next_Sub_node = First_sub;
+	New_main -> Last_Sub_node = First_sub;
 
 	return New_main;
 	
@@ -158,16 +246,26 @@ MAIN_NODE* Create_Main_Node( char* word, char* filename )
 
 
 /**/
-SUB_NODE* Create_Sub_Node( char* filename )
+SUB_NODE* Create_Sub_Node( HASH_T *Hash_T, DOC_ID doc_id )
 {
-	SUB_NODE* new_sub = malloc( sizeof( SUB_NODE ) );
+	// Count-only tables never pay for the position fields
+	SUB_NODE* new_sub = Arena_Alloc( &Hash_T -> Sub_arena, Hash_T -> Positional ? sizeof( POS_SUB_NODE ) : sizeof( SUB_NODE ) );
 	if( new_sub == NULL )
 	{
-		perror("Malloc failed for SUB_NODE");
 		return NULL;
 	}
 
-	strcpy( new_sub -> File_name, filename );
+	if( Hash_T -> Positional )
+	{
+		POS_SUB_NODE *pos_sub = ( POS_SUB_NODE* ) new_sub;
+
+		pos_sub -> positions = NULL;
+		pos_sub -> positions_len = 0;
+		pos_sub -> positions_capacity = 0;
+		pos_sub -> last_position = 0;
+	}
+
+	new_sub -> doc_id = doc_id;
 	new_sub -> link = NULL;
 	new_sub -> word_count = 1;
 
@@ -177,96 +275,162 @@ SUB_NODE* Create_Sub_Node( char* filename )
 
 
 /**/
-Status Insert_To_Hash_Table( int index, char* word, char* filename, HASH_T *Hash_T )
+Status Insert_To_Hash_Table( char* word, DOC_ID doc_id, HASH_T *Hash_T )
 {
+	return Add_Posting( Hash_T, word, doc_id, 1 );
+}
 
-	MAIN_NODE *main_temp = Hash_T[index].link;
-	MAIN_NODE *Prev_main = NULL;
 
-	// Case 1: Search if word exists
-	while( main_temp != NULL )
-	{
-		if( strcmp( main_temp -> word, word ) == 0 )
-			break;
+/* Link a new posting after prev ( NULL: first ), so the chain stays sorted by doc id */
+static SUB_NODE* Link_Sub_Node( HASH_T *Hash_T, MAIN_NODE *main_temp, SUB_NODE *prev, DOC_ID doc_id, Word_Count count )
+{
+	SUB_NODE *New_sub = Create_Sub_Node( Hash_T, doc_id );
+	if( New_sub == NULL )
+		return NULL;
 
-		Prev_main = main_temp;
-		main_temp = main_temp -> Next_Main_node;
+	New_sub -> word_count = count;
+
+	if( prev == NULL )
+	{
+		New_sub -> link = main_temp -> Next_Sub_node;
+		main_temp -> Next_Sub_node = New_sub;
 	}
+	else
+	{
+		New_sub -> link = prev -> link;
+		prev -> link = New_sub;
+	}
+
+	if( New_sub -> link == NULL )
+		main_temp -> Last_Sub_node = New_sub;
+
+	main_temp -> file_count++;
+
+	return New_sub;
+}
+
+
+/* Add count occurrences of word in doc_id; returns the posting that holds them, NULL on failure.
+   *node is the word's MAIN_NODE when the caller already knows it, and is set when it is found or created */
+static SUB_NODE* Count_Posting( HASH_T *Hash_T, MAIN_NODE **node, char* word, DOC_ID doc_id, Word_Count count )
+{
+
+	// Case 1: Search if word exists, in the heap and then in a mapped index not copied into it
+	MAIN_NODE *main_temp = *node != NULL ? *node : Find_Main_Node( Hash_T, word );
+
+	if( main_temp == NULL && Materialise_Mapped_Term( Hash_T, word, &main_temp ) == FAILURE )
+		return NULL;
 
 	// Case 2: Word not found, create a new main node
 	if( main_temp == NULL )
 	{
-		MAIN_NODE *new_main = Create_Main_Node( word, filename );
+		MAIN_NODE *new_main = Create_Main_Node( Hash_T, word, doc_id );
 		if( new_main == NULL )
 		{
-			return FAILURE;
+			return NULL;
 		}
 
-		if( Prev_main == NULL )
-			Hash_T[index].link = new_main;
-		else
-			Prev_main -> Next_Main_node = new_main;
+		new_main -> Next_Sub_node -> word_count = count;
 
-		return SUCCESS;
+		if( Link_Main_Node( Hash_T, new_main ) == FAILURE )
+			return NULL;
+
+		Record_Save_Word( Hash_T, new_main, new_main -> Next_Sub_node );
+
+		*node = new_main;
+		return new_main -> Next_Sub_node;
 
 	}
 
+	*node = main_temp;
+
 	// Case 3: Word exists - check if file already has the word
-	SUB_NODE *Sub_temp = main_temp -> Next_Sub_node;
-	SUB_NODE *Prev_sub = NULL;
+	// Files are indexed one after another, so the tail is almost always the match
+	if( main_temp -> Last_Sub_node != NULL && main_temp -> Last_Sub_node -> doc_id == doc_id )
+	{
+		main_temp -> Last_Sub_node -> word_count += count;
+		return main_temp -> Last_Sub_node;
+	}
+
+	// Doc ids arrive in ascending order from builds, merges, loads and re-indexing, so a larger one is
+	// new to the list and goes to its tail. A frozen list keeps its bytes and chains the posting after
+	// them, so adding one document costs the same whatever the word's document frequency
+	DOC_ID last = main_temp -> Last_Sub_node != NULL ? main_temp -> Last_Sub_node -> doc_id
+	                                                 : Frozen_Last_Doc( main_temp, Hash_T -> Positional );
 
-	while( Sub_temp != NULL )
+	if( doc_id > last )
 	{
-		if( strcmp( Sub_temp -> File_name, filename ) == 0 )
-		{
-			Sub_temp -> word_count++;
+		SUB_NODE *sub = Link_Sub_Node( Hash_T, main_temp, main_temp -> Last_Sub_node, doc_id, count );
 
-			return SUCCESS;
-		}
+		// The word's first posting past the save goes into the next delta save ( Save_DataBase.c )
+		if( sub != NULL && last < Hash_T -> Saved.docs )
+			Record_Save_Word( Hash_T, main_temp, sub );
+
+		return sub;
+	}
 
+	// Only an out-of-order id ( an older save file ) walks the list, which goes back to chain form for it
+	if( main_temp -> Postings != NULL && Thaw_Main_Node( Hash_T, main_temp ) == FAILURE )
+		return NULL;
+
+	SUB_NODE *prev = NULL;
+	SUB_NODE *Sub_temp = main_temp -> Next_Sub_node;
 
-		Prev_sub = Sub_temp;
+	// The tail is larger, so the walk stops inside the chain
+	while( Sub_temp -> doc_id < doc_id )
+	{
+		prev = Sub_temp;
 		Sub_temp = Sub_temp -> link;
 	}
 
-	// Case 4: Word Exists - file not found with this word
-	SUB_NODE *New_sub = Create_Sub_Node( filename );
-	if( New_sub == NULL )
-		return FAILURE;
+	if( Sub_temp -> doc_id == doc_id )
+	{
+		Sub_temp -> word_count += count;
 
-	if( Prev_sub == NULL )
-		main_temp -> Next_Sub_node = New_sub;
-	else
-		Prev_sub -> link = New_sub;
+		return Sub_temp;
+	}
 
-	main_temp -> file_count++;
+	// Case 4: Word Exists - file not found with this word, linked in doc id order
+	return Link_Sub_Node( Hash_T, main_temp, prev, doc_id, count );
 
-	return SUCCESS;
-	
 }
 
 
 /**/
-Status File_Already_Indexed (const char *fname, HASH_T *Hash_T )
+Status Add_Posting( HASH_T *Hash_T, char* word, DOC_ID doc_id, Word_Count count )
 {
-    for ( int i = 0; i < 27; i++ )
-    {
-        MAIN_NODE *main = Hash_T[i].link;
+	MAIN_NODE *node = NULL;
 
-        while ( main )
-        {
-            SUB_NODE *sub = main -> Next_Sub_node;
+	return Count_Posting( Hash_T, &node, word, doc_id, count ) != NULL ? SUCCESS : FAILURE;
+}
 
-            while ( sub )
-            {
-                if (strcmp(sub -> File_name, fname ) == 0 )
-                    return EXISTS;  // Exists in DB
 
-                sub = sub -> link;
-            }
-            
-			main = main -> Next_Main_node;
-        }
-    }
-    return NOT_EXISTS;  // Not found
-}
\ No newline at end of file
+/**/
+Status Add_Posting_Positions( HASH_T *Hash_T, char* word, DOC_ID doc_id, Word_Count count, const unsigned char *deltas )
+{
+	MAIN_NODE *node = NULL;
+
+	return Add_Term_Posting( Hash_T, &node, word, doc_id, count, deltas );
+}
+
+
+/**/
+Status Add_Term_Posting( HASH_T *Hash_T, MAIN_NODE **node, char* word, DOC_ID doc_id, Word_Count count, const unsigned char *deltas )
+{
+	SUB_NODE *sub = Count_Posting( Hash_T, node, word, doc_id, count );
+	if( sub == NULL )
+		return FAILURE;
+
+	if( !Hash_T -> Positional || deltas == NULL )
+		return SUCCESS;
+
+	return Append_Positions( Hash_T, sub, count, deltas );
+}
+
+
+/**/
+Status File_Already_Indexed (const char *fname, HASH_T *Hash_T )
+{
+    // Documents are registered only when indexed, so the doc table answers directly, by name or file identity
+    return Find_Document_File( &Hash_T -> Docs, fname, NULL, NULL );
+}
@@ -12,14 +12,19 @@
  * Function Overview :
  *
  *      → Display_DataBase( HASH_T* H_Table )
- *            • Iterates through all 27 hash buckets (0–26)
+ *            • Walks the sorted term dictionary (Term_Dict.c): letter groups 0–26, words sorted
+ *              inside each group, without a sort pass of its own
+ *            • Works on the heap table and on a mapped binary index alike, in the same order
  *            • Prints each unique word with its file occurrences in a tabular format
+ *            • Postings of deleted documents are skipped; a word with none left is not shown
  *            • Prevents misleading output by showing a clear message when database is empty
  *
  *      → Search_DataBase( HASH_T* H_Table, char* word )
- *            • Determines hash index from the first character of input word
- *            • Searches MAIN_NODE chain for an exact string match
- *            • Prints all file names and occurrence counts when found
+ *            • Looks the word up through the whole-word hash index, then the mapped dictionary
+ *            • Normalizes the query exactly as indexed text (Normalize.c), then matches it exactly
+ *            • Prints all file names and occurrence counts when found ( live documents only )
+ *            • Otherwise suggests up to FUZZY_SUGGESTIONS indexed terms within Auto_Fuzzy_Distance()
+ *              edits, found through the term dictionary (Expand_Fuzzy), never a scan of every word
  *            • Returns SUCCESS if word exists, otherwise FAILURE
  *
  *      → Display_Menu()
@@ -42,6 +47,8 @@
  *      • Search is case-sensitive and matches stored word format exactly
  *      • Output appearance assumes reasonable filename/word lengths
  *      • Function does not modify or free any data structures
+ *      • Filenames are resolved from posting doc ids through the document table
+ *      • Postings are read through POSTING_ITER, so frozen (compressed) words decode on the fly
  *
  *******************************************************************************************************************************************************************/
 
@@ -60,53 +67,48 @@ DISPLAY Display_DataBase( HASH_T* H_Table )
     printf("|-----|-----------------|----------|----------------------|----------|\n");
 
 
-	int is_empty = 1;
-	for( int i = 0; i < 27; i++ )
+	size_t total = Term_Dict_Size( H_Table );
+	TERM_REF term;
+
+	for( size_t pos = 0; pos < total; pos++ )
 	{
-		if( H_Table[i].link != NULL )
+		Term_Dict_Ref( H_Table, pos, &term );
+		INDEX i = Find_Index( term.word[0] );
+
+		// Words left only in deleted documents wait for compaction out of sight
+		No_Of_Files live = Live_File_Count( &term );
+		if( live == 0 )
+			continue;
+
+		POSTING_ITER it;
+		Posting_Iter_Init_Term( &it, &term );
+
+		// print first line with full info
+		if( Posting_Iter_Next( &it ) == SUCCESS )
+		{
+			printf("| %-3d | %-15s | %-8ld | %-20s | %-8ld |\n",
+				i,
+				term.word,
+				live,
+				Doc_Name( &H_Table -> Docs, it.doc_id ),
+				it.word_count);
+		}
+
+		while( Posting_Iter_Next( &it ) == SUCCESS )
 		{
-			MAIN_NODE* main_node = H_Table[i].link;
-
-			while( main_node != NULL )
-			{
-
-				is_empty = 0;
-
-				SUB_NODE* sub_node = main_node -> Next_Sub_node;
-
-				// print first line with full info
-				if (sub_node != NULL)
-				{
-					printf("| %-3d | %-15s | %-8ld | %-20s | %-8ld |\n",
-						i,
-						main_node->word,
-						main_node->file_count,
-						sub_node->File_name,
-						sub_node->word_count);
-
-					sub_node = sub_node->link;
-				}
-
-				while( sub_node != NULL )
-				{
-					printf("| %-3s | %-15s | %-8s | %-20s | %-8ld |\n",
-                       "",
-                       "",
-                       "",
-                       sub_node->File_name,
-                       sub_node->word_count);
-
-					sub_node = sub_node -> link;
-		
-				}
-
-				main_node = main_node -> Next_Main_node;
-				printf("\n");
-			}
+			printf("| %-3s | %-15s | %-8s | %-20s | %-8ld |\n",
+               "",
+               "",
+               "",
+               Doc_Name( &H_Table -> Docs, it.doc_id ),
+               it.word_count);
+
 		}
+
+		printf("\n");
 	}
 
-	if( is_empty )
+	if( total == 0 )
 		printf("| %-68s |\n", "[INFO]: Database is empty. Nothing to display.");
 
     printf("|-----|-----------------|----------|----------------------|----------|\n");
@@ -115,47 +117,122 @@ DISPLAY Display_DataBase( HASH_T* H_Table )
 }
 
 
+/* Closest indexed terms to a missing word: smallest edit distance first, then most files */
+static void Suggest_Terms( HASH_T* H_Table, const char* word )
+{
+	int distance = Auto_Fuzzy_Distance( word );
+
+	if( distance == 0 )
+		return;
+
+	TERM_REF *near = malloc( TERM_EXPANSION_MAX * sizeof( TERM_REF ) );
+	int *cost = malloc( TERM_EXPANSION_MAX * sizeof( int ) );
+
+	if( near == NULL || cost == NULL )
+	{
+		free( near );
+		free( cost );
+		return;
+	}
+
+	size_t found = Expand_Fuzzy( H_Table, word, distance, near, cost, TERM_EXPANSION_MAX );
+	size_t count = 0;
+
+	if( found > TERM_EXPANSION_MAX )
+		found = TERM_EXPANSION_MAX;
+
+	// Keep live terms only; file_count is reused to hold the live file count for the ordering below
+	for( size_t i = 0; i < found; i++ )
+	{
+		No_Of_Files live = Live_File_Count( &near[i] );
+
+		if( live == 0 )
+			continue;
+
+		near[ count ] = near[i];
+		near[ count ].file_count = live;
+		cost[ count++ ] = cost[i];
+	}
+
+	if( count > 0 )
+		printf("[INFO]: Did you mean:");
+
+	// Selection of the best few; the candidate list is short
+	for( size_t shown = 0; shown < count && shown < FUZZY_SUGGESTIONS; shown++ )
+	{
+		size_t best = shown;
+
+		for( size_t i = shown + 1; i < count; i++ )
+			if( cost[i] < cost[best] || ( cost[i] == cost[best] && near[i].file_count > near[best].file_count ) )
+				best = i;
+
+		TERM_REF swap_ref = near[shown];
+		int swap_cost = cost[shown];
+
+		near[shown] = near[best];
+		cost[shown] = cost[best];
+		near[best] = swap_ref;
+		cost[best] = swap_cost;
+
+		printf("%s %s ( %ld file%s )", shown ? "," : "", near[shown].word, near[shown].file_count, near[shown].file_count > 1 ? "s" : "" );
+	}
+
+	if( count > 0 )
+		printf("\n");
+
+	free( near );
+	free( cost );
+}
+
+
 Status Search_DataBase( HASH_T* H_Table, char* word )
 {
-	int index = Find_Index( word[0] );
+	TERM_REF term;
+	WORD normalized;
 
-	MAIN_NODE* main_node = H_Table[index].link;
+	// Queries go through the same normalization as indexed text
+	if( Normalize_Word( word, normalized ) != SUCCESS )
+	{
+		printf("\n[INFO]: '%s' is a stopword or has no searchable characters.\n", word);
+		return FAILURE;
+	}
+
+	No_Of_Files live = 0;
+
+	if( Lookup_Term( H_Table, normalized, &term ) == SUCCESS )
+		live = Live_File_Count( &term );
 
-	while( main_node != NULL )
+	if( live == 0 )
 	{
-		if( strcmp( main_node -> word, word ) == 0 )
-		{
-			printf("\n============================================================\n");
-			printf(" 🔍  Word: %-20s | Found in %ld file%s\n",
-						 main_node -> word,
-						 main_node -> file_count,
-						(main_node -> file_count > 1 ? "s" : ""));
-			printf("------------------------------------------------------------\n");
-		
-			SUB_NODE* sub_node = main_node -> Next_Sub_node;
-			No_Of_Files file_no = 1;
-
-			while( sub_node != NULL )
-			{
-				 printf(" [%02ld] %-25s → %3ld occurrence%s\n",
-                       file_no++,
-                       sub_node->File_name,
-                       sub_node->word_count,
-                       (sub_node->word_count > 1 ? "s" : ""));
-
-                sub_node = sub_node->link;
-			}
-
-			printf("============================================================\n\n");
-			printf("[INFO]: Search Successful\n");
-            return SUCCESS;
-		}
-		
-		main_node = main_node -> Next_Main_node;
+		printf("\n[INFO]: Word '%s' not found in the database.\n", word);
+		Suggest_Terms( H_Table, normalized );
+		return FAILURE;
+	}
+
+	printf("\n============================================================\n");
+	printf(" 🔍  Word: %-20s | Found in %ld file%s\n",
+				 term.word,
+				 live,
+				(live > 1 ? "s" : ""));
+	printf("------------------------------------------------------------\n");
+
+	POSTING_ITER it;
+	No_Of_Files file_no = 1;
+
+	Posting_Iter_Init_Term( &it, &term );
+
+	while( Posting_Iter_Next( &it ) == SUCCESS )
+	{
+		 printf(" [%02ld] %-25s → %3ld occurrence%s\n",
+               file_no++,
+               Doc_Name( &H_Table -> Docs, it.doc_id ),
+               it.word_count,
+               (it.word_count > 1 ? "s" : ""));
 	}
 
-	printf("\n[INFO]: Word '%s' not found in the database.\n", word);
-    return FAILURE;
+	printf("============================================================\n\n");
+	printf("[INFO]: Search Successful\n");
+    return SUCCESS;
 
 }
 
@@ -173,6 +250,10 @@ void Display_Menu()
     printf("  4️⃣  Save Database\n");
     printf("  5️⃣  Update Database\n");
     printf("  6️⃣  Exit\n");
+    printf("  7️⃣  Save Binary Index\n");
+    printf("  8️⃣  Load Binary Index (mmap)\n");
+    printf("  9️⃣  Ranked Search (BM25)\n");
+    printf("  🔟  Manage Documents (add / re-index / remove / compact)\n");
 
 	printf("\n------------------------------------------------------------\n");
 
@@ -0,0 +1,388 @@
+/*******************************************************************************************************************************************************************
+ * File        : Doc_Table.c
+ * Project     : Inverted Search Engine (Project-2)
+ *
+ * Description :
+ *      Document table that interns every indexed filename exactly once. Postings (SUB_NODE)
+ *      store only the compact DOC_ID handed out here; Display, Search and Save resolve the
+ *      name back through Doc_Name().
+ *
+ *      Files are also known by identity ( device, inode ), so "./a.txt", a symlink or a hard link
+ *      to an indexed file is recognised as that document whatever name it is given under.
+ *
+ *      A removed or re-indexed document is not erased: its entry becomes a tombstone, readers
+ *      skip its postings, and Compact_Index() (Live_Update.c) drops them later. Re-indexing a
+ *      name gives it a new id with the next version, so old and new postings never mix.
+ *
+ * Function Overview :
+ *
+ *      → Initialise_Doc_Table( DOC_TABLE *Docs )
+ *            • Allocates the id → name array and the name → id slot array
+ *
+ *      → Free_Doc_Table( DOC_TABLE *Docs )
+ *            • Releases every interned name and both arrays
+ *
+ *      → Register_Document( DOC_TABLE *Docs, const char *filename, DOC_ID *doc_id )
+ *            • Returns the existing id of filename, or assigns the next free id
+ *            • A deleted filename gets a new id whose version follows the tombstone's
+ *
+ *      → Find_Document( DOC_TABLE *Docs, const char *filename, DOC_ID *doc_id )
+ *            • EXISTS / NOT_EXISTS without modifying the table; deleted documents do not exist
+ *
+ *      → Record_Document_File( DOC_TABLE *Docs, DOC_ID doc_id, const char *filename, FILE *fptr )
+ *            • Stores the identity of the file behind a document ( fstat of fptr, else stat of filename )
+ *
+ *      → Find_Document_File( DOC_TABLE *Docs, const char *filename, FILE *fptr, DOC_ID *doc_id )
+ *            • Find_Document() by name, then by file identity; EXISTS / NOT_EXISTS
+ *            • Documents registered by name only ( loaded from a save file or binary index ) are
+ *              identified through stat() of their name once, the first time this is asked
+ *
+ *      → Delete_Document( DOC_TABLE *Docs, DOC_ID doc_id )
+ *            • Tombstones a live document in O(1) and takes its length out of total_length
+ *
+ *      → Restore_Document( DOC_TABLE *Docs, DOC_ID doc_id )
+ *            • Undoes Delete_Document() for a version whose replacement failed; its name maps to it again
+ *
+ *      → Doc_Tombstones( DOC_TABLE *Docs )
+ *            • The table when it holds deleted documents, NULL otherwise ( TERM_REF -> docs )
+ *
+ *      → Doc_Name( DOC_TABLE *Docs, DOC_ID doc_id )
+ *            • Filename for an id
+ *
+ *      → Set_Document_Length( DOC_TABLE *Docs, DOC_ID doc_id, Word_Count length )
+ *            • Records the number of indexed terms of a document and keeps total_length in step
+ *
+ * Notes :
+ *      • Ids are dense and handed out in registration order (0, 1, 2, ...)
+ *      • Name lookup uses linear probing over a power-of-two slot array kept below 50% load
+ *      • A slot always holds the newest id of its name, live or deleted
+ *      • Identities use a second slot array of the same size; a tombstone and the live document
+ *        that replaced it may share an identity, so identity lookups skip deleted entries
+ *
+ *******************************************************************************************************************************************************************/
+
+
+#include "Inverted_Search.h"
+#include "Types.h"
+#include <sys/stat.h>
+
+
+/**/
+Status Initialise_Doc_Table( DOC_TABLE *Docs )
+{
+	Docs -> doc = malloc( DOC_INITIAL_SIZE * sizeof( DOC_ENTRY ) );
+	Docs -> slot = calloc( DOC_INITIAL_SIZE * 2, sizeof( DOC_ID ) );
+	Docs -> ident_slot = calloc( DOC_INITIAL_SIZE * 2, sizeof( DOC_ID ) );
+
+	if( Docs -> doc == NULL || Docs -> slot == NULL || Docs -> ident_slot == NULL )
+	{
+		perror("Malloc failed for document table");
+		free( Docs -> doc );
+		free( Docs -> slot );
+		free( Docs -> ident_slot );
+		Docs -> doc = NULL;
+		Docs -> slot = NULL;
+		Docs -> ident_slot = NULL;
+		Docs -> count = Docs -> capacity = Docs -> slot_size = 0;
+		return FAILURE;
+	}
+
+	Docs -> count = 0;
+	Docs -> deleted = 0;
+	Docs -> resolved = 0;
+	Docs -> capacity = DOC_INITIAL_SIZE;
+	Docs -> slot_size = DOC_INITIAL_SIZE * 2;
+	Docs -> total_length = 0;
+	Docs -> lengths_stale = 0;
+
+	return SUCCESS;
+}
+
+
+/**/
+void Free_Doc_Table( DOC_TABLE *Docs )
+{
+	for( size_t i = 0; i < Docs -> count; i++ )
+		free( Docs -> doc[i].name );
+
+	free( Docs -> doc );
+	free( Docs -> slot );
+	free( Docs -> ident_slot );
+
+	Docs -> doc = NULL;
+	Docs -> slot = NULL;
+	Docs -> ident_slot = NULL;
+	Docs -> count = Docs -> deleted = Docs -> capacity = Docs -> slot_size = 0;
+}
+
+
+/* Probe for filename; returns the slot holding it or the empty slot where it belongs */
+static size_t Probe_Slot( DOC_TABLE *Docs, const char *filename, HASH_VALUE hash )
+{
+	size_t mask = Docs -> slot_size - 1;
+	size_t pos = hash & mask;
+
+	while( Docs -> slot[pos] != 0 )
+	{
+		DOC_ENTRY *entry = &Docs -> doc[ Docs -> slot[pos] - 1 ];
+
+		if( entry -> hash_value == hash && strcmp( entry -> name, filename ) == 0 )
+			break;
+
+		pos = ( pos + 1 ) & mask;
+	}
+
+	return pos;
+}
+
+
+/* Home slot of a file identity */
+static size_t Ident_Hash( dev_t dev, ino_t ino )
+{
+	uint64_t h = ( ( uint64_t ) ino * 0x9E3779B97F4A7C15ULL ) ^ ( uint64_t ) dev;
+
+	return ( size_t )( h ^ ( h >> 29 ) );
+}
+
+
+/* Add an identified id to the identity slots */
+static void Place_Ident( DOC_TABLE *Docs, DOC_ID id )
+{
+	size_t mask = Docs -> slot_size - 1;
+	size_t pos = Ident_Hash( Docs -> doc[id].dev, Docs -> doc[id].ino ) & mask;
+
+	while( Docs -> ident_slot[pos] != 0 )
+		pos = ( pos + 1 ) & mask;
+
+	Docs -> ident_slot[pos] = id + 1;
+}
+
+
+/* Double both slot arrays and re-place every id; a later id of the same name takes the name slot over */
+static Status Grow_Doc_Slots( DOC_TABLE *Docs )
+{
+	size_t new_size = Docs -> slot_size * 2;
+	DOC_ID *bigger = calloc( new_size, sizeof( DOC_ID ) );
+	DOC_ID *bigger_ident = calloc( new_size, sizeof( DOC_ID ) );
+
+	if( bigger == NULL || bigger_ident == NULL )
+	{
+		free( bigger );
+		free( bigger_ident );
+		return FAILURE;
+	}
+
+	free( Docs -> slot );
+	free( Docs -> ident_slot );
+	Docs -> slot = bigger;
+	Docs -> ident_slot = bigger_ident;
+	Docs -> slot_size = new_size;
+
+	for( size_t id = 0; id < Docs -> count; id++ )
+	{
+		Docs -> slot[ Probe_Slot( Docs, Docs -> doc[id].name, Docs -> doc[id].hash_value ) ] = id + 1;
+
+		if( Docs -> doc[id].identified )
+			Place_Ident( Docs, id );
+	}
+
+	return SUCCESS;
+}
+
+
+/**/
+Status Find_Document( DOC_TABLE *Docs, const char *filename, DOC_ID *doc_id )
+{
+	if( Docs -> slot == NULL )
+		return NOT_EXISTS;
+
+	size_t pos = Probe_Slot( Docs, filename, Hash_Word( filename ) );
+
+	if( Docs -> slot[pos] == 0 || Docs -> doc[ Docs -> slot[pos] - 1 ].deleted )
+		return NOT_EXISTS;
+
+	if( doc_id != NULL )
+		*doc_id = Docs -> slot[pos] - 1;
+
+	return EXISTS;
+}
+
+
+/**/
+Status Register_Document( DOC_TABLE *Docs, const char *filename, DOC_ID *doc_id )
+{
+	if( Docs -> slot == NULL )
+		return FAILURE;
+
+	// Keep probing chains short; the slots grow before a new id could fill them past half
+	if( ( Docs -> count + 1 ) * 2 > Docs -> slot_size && Grow_Doc_Slots( Docs ) == FAILURE )
+		return FAILURE;
+
+	HASH_VALUE hash = Hash_Word( filename );
+	size_t pos = Probe_Slot( Docs, filename, hash );
+	unsigned int version = 1;
+
+	if( Docs -> slot[pos] != 0 )
+	{
+		DOC_ENTRY *entry = &Docs -> doc[ Docs -> slot[pos] - 1 ];
+
+		if( !entry -> deleted )
+		{
+			*doc_id = Docs -> slot[pos] - 1;
+			return SUCCESS;
+		}
+
+		// Indexed again after a delete: a fresh id, the slot moves over to it
+		version = entry -> version + 1;
+	}
+
+	if( Docs -> count == Docs -> capacity )
+	{
+		DOC_ENTRY *bigger = realloc( Docs -> doc, Docs -> capacity * 2 * sizeof( DOC_ENTRY ) );
+		if( bigger == NULL )
+			return FAILURE;
+
+		Docs -> doc = bigger;
+		Docs -> capacity *= 2;
+	}
+
+	char *name = strdup( filename );
+	if( name == NULL )
+		return FAILURE;
+
+	DOC_ID id = Docs -> count++;
+	Docs -> doc[id].name = name;
+	Docs -> doc[id].hash_value = hash;
+	Docs -> doc[id].length = 0;
+	Docs -> doc[id].version = version;
+	Docs -> doc[id].deleted = 0;
+	Docs -> doc[id].identified = 0;
+	Docs -> slot[pos] = id + 1;
+
+	*doc_id = id;
+	return SUCCESS;
+}
+
+
+/**/
+Status Record_Document_File( DOC_TABLE *Docs, DOC_ID doc_id, const char *filename, FILE *fptr )
+{
+	struct stat st;
+
+	if( doc_id >= Docs -> count || Docs -> ident_slot == NULL )
+		return FAILURE;
+
+	if( Docs -> doc[doc_id].identified )
+		return SUCCESS;
+
+	if( ( fptr != NULL ? fstat( fileno( fptr ), &st ) : stat( filename, &st ) ) != 0 )
+		return FAILURE;
+
+	Docs -> doc[doc_id].dev = st.st_dev;
+	Docs -> doc[doc_id].ino = st.st_ino;
+	Docs -> doc[doc_id].identified = 1;
+	Place_Ident( Docs, doc_id );
+
+	return SUCCESS;
+}
+
+
+/**/
+Status Find_Document_File( DOC_TABLE *Docs, const char *filename, FILE *fptr, DOC_ID *doc_id )
+{
+	struct stat st;
+
+	if( Find_Document( Docs, filename, doc_id ) == EXISTS )
+		return EXISTS;
+
+	if( Docs -> ident_slot == NULL || ( fptr != NULL ? fstat( fileno( fptr ), &st ) : stat( filename, &st ) ) != 0 )
+		return NOT_EXISTS;
+
+	// Names registered without a file ( loads ) are identified once, the first time they may match
+	for( ; Docs -> resolved < Docs -> count; Docs -> resolved++ )
+	{
+		DOC_ENTRY *entry = &Docs -> doc[ Docs -> resolved ];
+
+		if( !entry -> identified && !entry -> deleted )
+			Record_Document_File( Docs, Docs -> resolved, entry -> name, NULL );
+	}
+
+	size_t mask = Docs -> slot_size - 1;
+
+	for( size_t pos = Ident_Hash( st.st_dev, st.st_ino ) & mask; Docs -> ident_slot[pos] != 0; pos = ( pos + 1 ) & mask )
+	{
+		DOC_ID id = Docs -> ident_slot[pos] - 1;
+		DOC_ENTRY *entry = &Docs -> doc[id];
+
+		if( entry -> dev == st.st_dev && entry -> ino == st.st_ino && !entry -> deleted )
+		{
+			if( doc_id != NULL )
+				*doc_id = id;
+
+			return EXISTS;
+		}
+	}
+
+	return NOT_EXISTS;
+}
+
+
+/**/
+Status Delete_Document( DOC_TABLE *Docs, DOC_ID doc_id )
+{
+	if( doc_id >= Docs -> count || Docs -> doc[doc_id].deleted )
+		return FAILURE;
+
+	Docs -> doc[doc_id].deleted = 1;
+	Docs -> total_length -= Docs -> doc[doc_id].length;
+	Docs -> deleted++;
+
+	return SUCCESS;
+}
+
+
+/**/
+Status Restore_Document( DOC_TABLE *Docs, DOC_ID doc_id )
+{
+	if( doc_id >= Docs -> count || !Docs -> doc[doc_id].deleted )
+		return FAILURE;
+
+	DOC_ENTRY *entry = &Docs -> doc[doc_id];
+
+	entry -> deleted = 0;
+	Docs -> total_length += entry -> length;
+	Docs -> deleted--;
+
+	// The slot moved on to the newer id that replaced this one
+	Docs -> slot[ Probe_Slot( Docs, entry -> name, entry -> hash_value ) ] = doc_id + 1;
+
+	return SUCCESS;
+}
+
+
+/**/
+const DOC_TABLE* Doc_Tombstones( DOC_TABLE *Docs )
+{
+	return Docs -> deleted > 0 ? Docs : NULL;
+}
+
+
+/**/
+const char* Doc_Name( DOC_TABLE *Docs, DOC_ID doc_id )
+{
+	if( doc_id >= Docs -> count )
+		return "?";
+
+	return Docs -> doc[doc_id].name;
+}
+
+
+/**/
+void Set_Document_Length( DOC_TABLE *Docs, DOC_ID doc_id, Word_Count length )
+{
+	if( doc_id >= Docs -> count || Docs -> doc[doc_id].deleted )
+		return;
+
+	Docs -> total_length += length - Docs -> doc[doc_id].length;
+	Docs -> doc[doc_id].length = length;
+}
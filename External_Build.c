@@ -0,0 +1,463 @@
+/*******************************************************************************************************************************************************************
+ * File        : External_Build.c
+ * Project     : Inverted Search Engine (Project-2)
+ *
+ * Description :
+ *      Index build for corpora whose postings do not fit in memory ( single-pass in-memory
+ *      indexing, SPIMI ). Files are indexed into an ordinary table until it reaches the memory
+ *      budget; the table is then written out as a sorted run and a new one is started. At the
+ *      end the runs are merged term by term into the final binary index:
+ *
+ *          files → table → budget reached → run 0 ( binary index, sorted dictionary )
+ *                → table → budget reached → run 1
+ *                ...
+ *          runs  → k-way merge on the dictionaries → postings concatenated in doc order → index
+ *
+ *      Every run holds the documents that follow those of the runs before it, so the postings of
+ *      one word are merged by appending the runs' lists in run order ( Concat_Postings() ).
+ *
+ * Function Overview :
+ *
+ *      → Build_External_Index( LIST **head, size_t budget, const char *filename )
+ *            • Indexes every file of the list ( walked by Corpus.c ) with at most budget bytes of
+ *              index in memory and writes the merged binary index to filename
+ *            • Runs are written next to it ( filename.run.<n> ) and removed afterwards
+ *            • With a single run the table is saved to filename directly
+ *
+ *      → Merge_Index_Files( HASH_T **part, int count, const char *filename )
+ *      → Merge_Index_Tables( HASH_T **part, int count, HASH_T *merged )
+ *            • Merges count frozen indexes ( mapped or heap ) into a binary index file / a new
+ *              frozen table; documents of part i follow those of parts 0 .. i-1
+ *            • The parts are only read, so they may be queried at the same time (Segment_Index.c)
+ *
+ * Notes :
+ *      • Runs are binary indexes ( Binary_Index.c ); the merge maps them, so their postings are
+ *        read from the page cache, and streams the result through an INDEX_WRITER
+ *      • Memory is the budget, checked after each file ( a larger file still completes its run ),
+ *        plus the document table and the longest merged posting list. The budget counts the
+ *        bytes a run's index uses, not the arena blocks it has reserved, so a budget below one
+ *        block still fills runs of many documents
+ *      • The merge keeps the parts on a min-heap by head word, log k work per word and run
+ *      • Documents are numbered in discovery order, so the result is the index a one-table build
+ *        of the same files would save
+ *
+ *******************************************************************************************************************************************************************/
+
+
+#include "Inverted_Search.h"
+#include "Types.h"
+
+
+typedef struct External_Build
+{
+	const char *filename;
+	size_t budget;
+
+	DOC_TABLE docs;                 // every document indexed so far, in doc id order
+	HASH_T run;                     // table being filled
+	int filling;
+
+	int runs;
+
+} EXTERNAL_BUILD;
+
+
+/* File name of run n */
+static void Run_File_Name( char *name, const char *filename, int run )
+{
+	snprintf( name, FILENAME_MAX, "%s.run.%d", filename, run );
+}
+
+
+/* Start the next run */
+static Status Start_Run( EXTERNAL_BUILD *build )
+{
+	if( Initialise_Hash_Table( &build -> run ) == FAILURE )
+		return FAILURE;
+
+	Adopt_Posting_Form( &build -> run );
+	build -> filling = 1;
+
+	return SUCCESS;
+}
+
+
+/* Write the table being filled as the next run and release it */
+static Status Flush_Run( EXTERNAL_BUILD *build )
+{
+	char name[FILENAME_MAX];
+	Run_File_Name( name, build -> filename, build -> runs );
+
+	size_t bytes = Index_Memory_Bytes( &build -> run );
+
+	Status status = Save_Binary_Index( &build -> run, name );
+
+	if( status == SUCCESS )
+		printf("[INFO]: Run %d written: %zu documents, %zu words, %zu bytes of index in memory\n",
+				build -> runs, build -> run.Docs.count, build -> run.word_total, bytes );
+
+	Free_Hash_Table( &build -> run );
+	build -> filling = 0;
+	build -> runs += status == SUCCESS;
+
+	return status;
+}
+
+
+/* Index one file into the current run, starting one if needed */
+static Status Add_File( EXTERNAL_BUILD *build, CORPUS *corpus, const char *filename )
+{
+	// Runs are separate tables, so duplicates are caught across all of them here
+	if( Find_Document_File( &build -> docs, filename, NULL, NULL ) == EXISTS )
+	{
+		printf("[INFO]: '%s' already present in database. Skipping...\n", filename );
+		return SUCCESS;
+	}
+
+	FILE *fptr = fopen( filename, "r" );
+	if( fptr == NULL )
+	{
+		printf("[INFO]: Could not open '%s'. Skipping...\n", filename );
+		Skip_Corpus_File( corpus );
+		return SUCCESS;
+	}
+
+	DOC_ID doc_id;
+	DOC_ID local_id;
+
+	Status status = Register_Document( &build -> docs, filename, &doc_id );
+
+	if( status == SUCCESS )
+		Record_Document_File( &build -> docs, doc_id, filename, fptr );
+
+	if( status == SUCCESS && !build -> filling )
+		status = Start_Run( build );
+
+	// A run's documents are the next ones in doc id order, so its local ids only need an offset
+	if( status == SUCCESS )
+		status = Register_Document( &build -> run.Docs, filename, &local_id );
+
+	if( status == SUCCESS )
+		status = Index_File( &build -> run, fptr, local_id );
+
+	fclose( fptr );
+
+	if( status == FAILURE )
+	{
+		printf("[INFO]: Indexing '%s' failed\n", filename );
+		return FAILURE;
+	}
+
+	if( Index_Memory_Bytes( &build -> run ) >= build -> budget )
+		return Flush_Run( build );
+
+	return SUCCESS;
+}
+
+
+typedef Status ( *TERM_SINK )( void *sink, const char *word, const unsigned char *postings, unsigned int length, No_Of_Files file_count );
+
+
+/* Part a's head word comes before part b's; equal words in part order, so their lists concatenate in doc order */
+static int Head_Before( const TERM_REF *head, int a, int b )
+{
+	int order = Compare_Terms( head[a].word, head[b].word );
+
+	return order < 0 || ( order == 0 && a < b );
+}
+
+
+/* Heap of part indexes ordered by their head word; sift the entry at i down */
+static void Head_Sift_Down( int *heap, int count, int i, const TERM_REF *head )
+{
+	while( 1 )
+	{
+		int smallest = i;
+		int left = 2 * i + 1;
+		int right = left + 1;
+
+		if( left < count && Head_Before( head, heap[left], heap[smallest] ) )
+			smallest = left;
+
+		if( right < count && Head_Before( head, heap[right], heap[smallest] ) )
+			smallest = right;
+
+		if( smallest == i )
+			return;
+
+		int swap = heap[i];
+		heap[i] = heap[smallest];
+		heap[smallest] = swap;
+		i = smallest;
+	}
+}
+
+
+/* k-way merge of the parts' sorted dictionaries on a min-heap; every word goes to emit once, its lists concatenated */
+static Status Merge_Dictionaries( HASH_T **part, int count, TERM_SINK emit, void *sink, size_t *terms )
+{
+	size_t *next = calloc( count, sizeof( size_t ) );
+	size_t *size = calloc( count, sizeof( size_t ) );
+	DOC_ID *first = calloc( count, sizeof( DOC_ID ) );
+	TERM_REF *head = calloc( count, sizeof( TERM_REF ) );
+	TERM_REF *ref = calloc( count, sizeof( TERM_REF ) );
+	DOC_ID *base = calloc( count, sizeof( DOC_ID ) );
+	int *heap = calloc( count, sizeof( int ) );
+	int heap_size = 0;
+
+	Status status = next && size && first && head && ref && base && heap ? SUCCESS : FAILURE;
+
+	if( status == FAILURE )
+		perror("Malloc failed for index merge");
+
+	// Part i holds the doc ids that follow those of parts 0 .. i-1
+	for( int i = 0; status == SUCCESS && i < count; i++ )
+	{
+		first[i] = i == 0 ? 0 : first[i - 1] + ( DOC_ID ) part[i - 1] -> Docs.count;
+		size[i] = Term_Dict_Size( part[i] );
+
+		if( size[i] > 0 )
+		{
+			Term_Dict_Ref( part[i], 0, &head[i] );
+			heap[ heap_size++ ] = i;
+		}
+	}
+
+	for( int i = heap_size / 2 - 1; i >= 0; i-- )
+		Head_Sift_Down( heap, heap_size, i, head );
+
+	unsigned char *buffer = NULL;
+	size_t capacity = 0;
+
+	*terms = 0;
+
+	// Equal words meet at the top of the heap one after another
+	while( status == SUCCESS && heap_size > 0 )
+	{
+		const char *word = head[ heap[0] ].word;
+		int found = 0;
+		No_Of_Files file_count = 0;
+
+		while( heap_size > 0 && strcmp( head[ heap[0] ].word, word ) == 0 )
+		{
+			int top = heap[0];
+
+			ref[found] = head[top];
+			file_count += head[top].file_count;
+			base[found++] = first[top];
+
+			if( ++next[top] < size[top] )
+				Term_Dict_Ref( part[top], next[top], &head[top] );
+			else
+				heap[0] = heap[ --heap_size ];
+
+			Head_Sift_Down( heap, heap_size, 0, head );
+		}
+
+		long length = Concat_Postings( ref, base, found, &buffer, &capacity );
+
+		status = length < 0 ? FAILURE : emit( sink, ref[0].word, buffer, length, file_count );
+		( *terms )++;
+	}
+
+	free( buffer );
+	free( next );
+	free( size );
+	free( first );
+	free( head );
+	free( ref );
+	free( base );
+	free( heap );
+
+	return status;
+}
+
+
+/* TERM_SINK of Merge_Index_Files() */
+static Status Writer_Term( void *sink, const char *word, const unsigned char *postings, unsigned int length, No_Of_Files file_count )
+{
+	return Index_Writer_Term( sink, word, postings, length, file_count );
+}
+
+
+/* TERM_SINK of Merge_Index_Tables() */
+static Status Table_Term( void *sink, const char *word, const unsigned char *postings, unsigned int length, No_Of_Files file_count )
+{
+	return Add_Frozen_Term( sink, word, postings, length, file_count );
+}
+
+
+/**/
+Status Merge_Index_Files( HASH_T **part, int count, const char *filename )
+{
+	DOC_TABLE docs;
+
+	if( Initialise_Doc_Table( &docs ) == FAILURE )
+		return FAILURE;
+
+	Status status = SUCCESS;
+
+	for( int i = 0; i < count && status == SUCCESS; i++ )
+	{
+		for( size_t id = 0; id < part[i] -> Docs.count && status == SUCCESS; id++ )
+		{
+			DOC_ID doc_id;
+			status = Register_Document( &docs, part[i] -> Docs.doc[id].name, &doc_id );
+		}
+	}
+
+	INDEX_WRITER *writer = status == SUCCESS ? Open_Index_Writer( filename, &docs, part[0] -> Positional ) : NULL;
+	size_t terms = 0;
+
+	if( writer == NULL )
+		status = FAILURE;
+	else
+		status = Close_Index_Writer( writer, Merge_Dictionaries( part, count, Writer_Term, writer, &terms ) );
+
+	if( status == SUCCESS )
+		printf("[INFO]: %d indexes merged into '%s' ( %zu words, %zu documents )\n", count, filename, terms, docs.count );
+
+	Free_Doc_Table( &docs );
+	return status;
+}
+
+
+/**/
+Status Merge_Index_Tables( HASH_T **part, int count, HASH_T *merged )
+{
+	if( Initialise_Hash_Table( merged ) == FAILURE )
+		return FAILURE;
+
+	merged -> Positional = part[0] -> Positional;
+
+	Status status = SUCCESS;
+
+	for( int i = 0; i < count && status == SUCCESS; i++ )
+	{
+		DOC_TABLE *Docs = &part[i] -> Docs;
+
+		for( size_t id = 0; id < Docs -> count && status == SUCCESS; id++ )
+		{
+			DOC_ID doc_id;
+			status = Register_Document( &merged -> Docs, Docs -> doc[id].name, &doc_id );
+
+			if( status == SUCCESS )
+				Set_Document_Length( &merged -> Docs, doc_id, Docs -> doc[id].length );
+		}
+
+		merged -> Docs.lengths_stale |= Docs -> lengths_stale;
+	}
+
+	size_t terms;
+
+	if( status == SUCCESS )
+		status = Merge_Dictionaries( part, count, Table_Term, merged, &terms );
+
+	if( status == FAILURE )
+		Free_Hash_Table( merged );
+
+	return status;
+}
+
+
+/* Map the runs and merge them into filename */
+static Status Merge_Runs( EXTERNAL_BUILD *build )
+{
+	int runs = build -> runs;
+	HASH_T *table = calloc( runs, sizeof( HASH_T ) );
+	HASH_T **part = calloc( runs, sizeof( HASH_T* ) );
+	int loaded = 0;
+
+	Status status = table && part ? SUCCESS : FAILURE;
+
+	if( status == FAILURE )
+		perror("Malloc failed for run merge");
+
+	for( ; status == SUCCESS && loaded < runs; loaded++ )
+	{
+		char name[FILENAME_MAX];
+		Run_File_Name( name, build -> filename, loaded );
+
+		part[loaded] = &table[loaded];
+		status = Initialise_Hash_Table( &table[loaded] );
+
+		if( status == SUCCESS )
+			status = Load_Binary_Index( &table[loaded], name );
+	}
+
+	if( status == SUCCESS )
+		status = Merge_Index_Files( part, runs, build -> filename );
+
+	for( int run = 0; run < loaded; run++ )
+		Free_Hash_Table( &table[run] );
+
+	free( table );
+	free( part );
+
+	return status;
+}
+
+
+/**/
+Status Build_External_Index( LIST **head, size_t budget, const char *filename )
+{
+	EXTERNAL_BUILD build;
+	memset( &build, 0, sizeof( build ) );
+
+	build.filename = filename;
+	build.budget = budget;
+
+	if( Initialise_Doc_Table( &build.docs ) == FAILURE )
+		return FAILURE;
+
+	CORPUS *corpus = Open_Corpus( *head );
+	if( corpus == NULL )
+	{
+		Free_Doc_Table( &build.docs );
+		return FAILURE;
+	}
+
+	char path[FILENAME_MAX];
+	Status status = SUCCESS;
+
+	while( status == SUCCESS && Next_Corpus_File( corpus, path ) == SUCCESS )
+		status = Add_File( &build, corpus, path );
+
+	Close_Corpus( corpus );
+
+	if( status == SUCCESS && build.filling && build.runs == 0 )
+	{
+		// Everything fitted: the table is the index
+		status = Save_Binary_Index( &build.run, filename );
+		Free_Hash_Table( &build.run );
+		build.filling = 0;
+	}
+	else if( status == SUCCESS )
+	{
+		if( build.filling )
+			status = Flush_Run( &build );
+
+		if( status == SUCCESS && build.runs == 0 )
+		{
+			printf("[INFO]: No documents indexed\n");
+			status = FAILURE;
+		}
+
+		if( status == SUCCESS )
+			status = Merge_Runs( &build );
+	}
+
+	if( build.filling )
+		Free_Hash_Table( &build.run );
+
+	for( int run = 0; run < build.runs; run++ )
+	{
+		char name[FILENAME_MAX];
+		Run_File_Name( name, filename, run );
+		remove( name );
+	}
+
+	Free_Doc_Table( &build.docs );
+
+	return status;
+}
@@ -0,0 +1,452 @@
+/*******************************************************************************************************************************************************************
+ * File        : Hash_Table.c
+ * Project     : Inverted Search Engine (Project-2)
+ *
+ * Description :
+ *      Word-level hash index used by every lookup in the inverted search engine. This module:
+ *        • Hashes the complete word (FNV-1a) instead of only its first letter
+ *        • Keeps the average chain length bounded by a load factor
+ *        • Grows the bucket array incrementally so no single insert pays for a full rehash
+ *        • Maintains the 27 letter groups that define Display / Save ordering
+ *
+ * Function Overview :
+ *
+ *      → Initialise_Hash_Table( HASH_T *Hash_T )
+ *            • Allocates the initial bucket array and document table
+ *            • Resets all 27 letter groups
+ *
+ *      → Free_Hash_Table( HASH_T *Hash_T )
+ *            • Releases bucket arrays, the document table, the term dictionary and all node / posting arenas
+ *
+ *      → Report_Memory_Usage( HASH_T *Hash_T )
+ *            • Prints node arena statistics plus bucket and document table sizes
+ *
+ *      → Index_Memory_Bytes( HASH_T *Hash_T )
+ *            • Bytes used by the same parts, the figure a memory budget is checked against
+ *            • Counts what the arenas handed out, not the blocks they reserved, so an empty table
+ *              is a few KB rather than one block per arena
+ *
+ *      → Hash_Word( const char *word )
+ *            • 64-bit FNV-1a over every byte of the word
+ *
+ *      → Find_Main_Node( HASH_T *Hash_T, const char *word )
+ *            • Returns the MAIN_NODE for word, or NULL when the word is not indexed
+ *
+ *      → Finish_Rehash( HASH_T *Hash_T )
+ *            • Completes a resize in progress, after which finds no longer modify the table and
+ *              can run on several threads at once (Shard.c)
+ *
+ *      → Link_Main_Node( HASH_T *Hash_T, MAIN_NODE *node )
+ *            • Adds a new word to its hash bucket and to the tail of its letter group
+ *            • Marks the sorted term dictionary (Term_Dict.c) stale
+ *
+ *      → Compare_Terms( const char *a, const char *b )
+ *            • Dictionary order: letter group first, then strcmp() within the group
+ *
+ *      → Lookup_Term( HASH_T *Hash_T, const char *word, TERM_REF *ref )
+ *            • Finds a word in the heap table or, failing that, in an attached binary index
+ *
+ *      → Term_Cursor_Init( TERM_CURSOR *cursor, HASH_T *Hash_T )
+ *      → Term_Cursor_Next( TERM_CURSOR *cursor, TERM_REF *ref, INDEX *group )
+ *            • Visits every word in Display / Save order, whichever form the index is in
+ *            • A mapped index with re-indexed words in the heap is materialised on the first step
+ *
+ *      → Set_Positional_Index( int enable )  /  Adopt_Posting_Form( HASH_T *Hash_T )
+ *            • --positions setting; an empty table takes it when a build starts, a table that
+ *              already holds documents keeps the form it was built or loaded with
+ *
+ * Resize Strategy :
+ *      When word_total exceeds size * HASH_MAX_LOAD, a bucket array twice as large is
+ *      allocated and the current array becomes old_bucket. Every following find / link
+ *      migrates HASH_REHASH_STEP old buckets, so the cost of a resize is spread over the
+ *      next operations. While a resize is in progress lookups probe both arrays.
+ *
+ * Notes :
+ *      • Letter groups (0–25 → a–z, 26 → others) are independent of the hash buckets, so
+ *        Display and Save keep their original order no matter how often the table grows.
+ *      • Hash chains link through Next_Hash_node; letter groups through Next_Main_node.
+ *      • Readers should go through TERM_REF so they also work on a mapped binary index.
+ *      • TERM_REFs handed out here carry the document tombstones, so their iterators skip deleted files.
+ *
+ *******************************************************************************************************************************************************************/
+
+
+#include "Inverted_Search.h"
+#include "Types.h"
+
+
+static int Positional_Default = 0;
+
+
+/**/
+Status Initialise_Hash_Table( HASH_T *Hash_T )
+{
+	// Start from all-zero so Free_Hash_Table() is safe even after a failed initialise
+	memset( Hash_T, 0, sizeof( HASH_T ) );
+
+	Hash_T -> bucket = calloc( HASH_INITIAL_SIZE, sizeof( MAIN_NODE* ) );
+	if( Hash_T -> bucket == NULL )
+	{
+		perror("Calloc failed for hash buckets");
+		Hash_T -> size = 0;
+		return FAILURE;
+	}
+
+	if( Initialise_Doc_Table( &Hash_T -> Docs ) == FAILURE )
+	{
+		free( Hash_T -> bucket );
+		Hash_T -> bucket = NULL;
+		Hash_T -> size = 0;
+		return FAILURE;
+	}
+
+	Arena_Init( &Hash_T -> Main_arena, ARENA_BLOCK_SIZE, ARENA_ALIGN );
+	Arena_Init( &Hash_T -> Sub_arena, ARENA_BLOCK_SIZE, ARENA_ALIGN );
+	Arena_Init( &Hash_T -> Post_arena, ARENA_BLOCK_SIZE, 1 );      // byte arrays need no padding
+
+	Hash_T -> Mapped = NULL;
+	Hash_T -> size = HASH_INITIAL_SIZE;
+	Hash_T -> old_bucket = NULL;
+	Hash_T -> old_size = 0;
+	Hash_T -> rehash_pos = 0;
+	Hash_T -> word_total = 0;
+
+	for( int i = 0; i < LETTER_GROUPS; i++ )
+	{
+		Hash_T -> Letter[i].index = i;
+		Hash_T -> Letter[i].link = NULL;
+		Hash_T -> Letter[i].tail = NULL;
+	}
+
+	return SUCCESS;
+}
+
+
+/**/
+void Free_Hash_Table( HASH_T *Hash_T )
+{
+	// Nodes live in the arenas, so the whole index goes in a handful of frees
+	Arena_Release( &Hash_T -> Main_arena );
+	Arena_Release( &Hash_T -> Sub_arena );
+	Arena_Release( &Hash_T -> Post_arena );
+
+	for( int i = 0; i < LETTER_GROUPS; i++ )
+	{
+		Hash_T -> Letter[i].link = NULL;
+		Hash_T -> Letter[i].tail = NULL;
+	}
+
+	free( Hash_T -> bucket );
+	free( Hash_T -> old_bucket );
+	Free_Doc_Table( &Hash_T -> Docs );
+	Free_Term_Dict( Hash_T );
+	Unmap_Binary_Index( Hash_T );
+	Clear_Save_Mark( Hash_T );
+
+	Hash_T -> bucket = NULL;
+	Hash_T -> old_bucket = NULL;
+	Hash_T -> size = 0;
+	Hash_T -> old_size = 0;
+	Hash_T -> rehash_pos = 0;
+	Hash_T -> word_total = 0;
+}
+
+
+/**/
+HASH_VALUE Hash_Word( const char *word )
+{
+	HASH_VALUE hash = 14695981039346656037UL;
+
+	while( *word )
+	{
+		hash ^= ( unsigned char ) *word++;
+		hash *= 1099511628211UL;
+	}
+
+	return hash;
+}
+
+
+/* Move a few buckets of the old array into the new one */
+static void Rehash_Step( HASH_T *Hash_T, int steps )
+{
+	while( steps-- > 0 && Hash_T -> old_bucket != NULL )
+	{
+		MAIN_NODE *node = Hash_T -> old_bucket[ Hash_T -> rehash_pos ];
+
+		while( node != NULL )
+		{
+			MAIN_NODE *next = node -> Next_Hash_node;
+			size_t slot = node -> hash_value & ( Hash_T -> size - 1 );
+
+			node -> Next_Hash_node = Hash_T -> bucket[slot];
+			Hash_T -> bucket[slot] = node;
+			node = next;
+		}
+
+		Hash_T -> old_bucket[ Hash_T -> rehash_pos ] = NULL;
+
+		if( ++Hash_T -> rehash_pos == Hash_T -> old_size )
+		{
+			free( Hash_T -> old_bucket );
+			Hash_T -> old_bucket = NULL;
+			Hash_T -> old_size = 0;
+			Hash_T -> rehash_pos = 0;
+		}
+	}
+}
+
+
+/* Start a resize once the load factor is exceeded */
+static void Grow_Hash_Table( HASH_T *Hash_T )
+{
+	if( Hash_T -> word_total <= Hash_T -> size * HASH_MAX_LOAD )
+		return;
+
+	// Finish any pending resize first so only two arrays ever exist
+	while( Hash_T -> old_bucket != NULL )
+		Rehash_Step( Hash_T, HASH_REHASH_STEP );
+
+	MAIN_NODE **bigger = calloc( Hash_T -> size * 2, sizeof( MAIN_NODE* ) );
+	if( bigger == NULL )
+		return;     // keep working with longer chains
+
+	Hash_T -> old_bucket = Hash_T -> bucket;
+	Hash_T -> old_size = Hash_T -> size;
+	Hash_T -> rehash_pos = 0;
+
+	Hash_T -> bucket = bigger;
+	Hash_T -> size *= 2;
+}
+
+
+/**/
+MAIN_NODE* Find_Main_Node( HASH_T *Hash_T, const char *word )
+{
+	if( Hash_T -> bucket == NULL )
+		return NULL;
+
+	HASH_VALUE hash = Hash_Word( word );
+
+	Rehash_Step( Hash_T, HASH_REHASH_STEP );
+
+	MAIN_NODE *node = Hash_T -> bucket[ hash & ( Hash_T -> size - 1 ) ];
+	while( node != NULL )
+	{
+		if( node -> hash_value == hash && strcmp( node -> word, word ) == 0 )
+			return node;
+
+		node = node -> Next_Hash_node;
+	}
+
+	if( Hash_T -> old_bucket != NULL )
+	{
+		size_t slot = hash & ( Hash_T -> old_size - 1 );
+
+		if( slot >= Hash_T -> rehash_pos )
+		{
+			node = Hash_T -> old_bucket[slot];
+			while( node != NULL )
+			{
+				if( node -> hash_value == hash && strcmp( node -> word, word ) == 0 )
+					return node;
+
+				node = node -> Next_Hash_node;
+			}
+		}
+	}
+
+	return NULL;
+}
+
+
+/**/
+void Finish_Rehash( HASH_T *Hash_T )
+{
+	while( Hash_T -> old_bucket != NULL )
+		Rehash_Step( Hash_T, HASH_REHASH_STEP );
+}
+
+
+/**/
+Status Link_Main_Node( HASH_T *Hash_T, MAIN_NODE *node )
+{
+	if( Hash_T -> bucket == NULL )
+		return FAILURE;
+
+	node -> hash_value = Hash_Word( node -> word );
+
+	size_t slot = node -> hash_value & ( Hash_T -> size - 1 );
+	node -> Next_Hash_node = Hash_T -> bucket[slot];
+	Hash_T -> bucket[slot] = node;
+
+	// Letter groups keep insertion order for Display and Save
+	LETTER_GROUP *group = &Hash_T -> Letter[ Find_Index( node -> word[0] ) ];
+	node -> Next_Main_node = NULL;
+
+	if( group -> tail == NULL )
+		group -> link = node;
+	else
+		group -> tail -> Next_Main_node = node;
+
+	group -> tail = node;
+
+	Hash_T -> Dict.stale = 1;
+	Hash_T -> word_total++;
+	Grow_Hash_Table( Hash_T );
+
+	return SUCCESS;
+}
+
+
+/**/
+void Report_Memory_Usage( HASH_T *Hash_T )
+{
+	printf("\n[INFO]: Index memory usage\n");
+	Arena_Report( &Hash_T -> Main_arena, "MAIN_NODE" );
+	Arena_Report( &Hash_T -> Sub_arena, "SUB_NODE" );
+	Arena_Report( &Hash_T -> Post_arena, "Postings" );
+
+	printf("  %-12s : %10zu words     | %12zu bytes\n",
+			"Buckets",
+			Hash_T -> word_total,
+			( Hash_T -> size + Hash_T -> old_size ) * sizeof( MAIN_NODE* ) );
+
+	printf("  %-12s : %10zu documents | %12zu bytes\n",
+			"Doc table",
+			Hash_T -> Docs.count,
+			Hash_T -> Docs.capacity * sizeof( DOC_ENTRY ) + Hash_T -> Docs.slot_size * sizeof( DOC_ID ) );
+}
+
+
+/**/
+size_t Index_Memory_Bytes( HASH_T *Hash_T )
+{
+	return Hash_T -> Main_arena.bytes_used + Hash_T -> Sub_arena.bytes_used + Hash_T -> Post_arena.bytes_used
+	     + ( Hash_T -> size + Hash_T -> old_size ) * sizeof( MAIN_NODE* )
+	     + Hash_T -> Docs.count * sizeof( DOC_ENTRY ) + Hash_T -> Docs.slot_size * sizeof( DOC_ID );
+}
+
+
+/**/
+int Compare_Terms( const char *a, const char *b )
+{
+	int group_a = Find_Index( a[0] );
+	int group_b = Find_Index( b[0] );
+
+	if( group_a != group_b )
+		return group_a - group_b;
+
+	return strcmp( a, b );
+}
+
+
+/**/
+Status Lookup_Term( HASH_T *Hash_T, const char *word, TERM_REF *ref )
+{
+	MAIN_NODE *node = Find_Main_Node( Hash_T, word );
+
+	if( node != NULL )
+	{
+		ref -> word = node -> word;
+		ref -> file_count = node -> file_count;
+		ref -> node = node;
+		ref -> postings = NULL;
+		ref -> postings_len = 0;
+		ref -> doc_limit = 0;
+		ref -> positional = Hash_T -> Positional;
+		ref -> docs = Doc_Tombstones( &Hash_T -> Docs );
+		return SUCCESS;
+	}
+
+	if( Hash_T -> Mapped != NULL && !Hash_T -> Mapped -> materialised )
+	{
+		long pos = Mapped_Find_Term( Hash_T -> Mapped, word );
+
+		if( pos >= 0 )
+		{
+			Mapped_Term_Ref( Hash_T -> Mapped, pos, ref );
+			ref -> docs = Doc_Tombstones( &Hash_T -> Docs );
+			return SUCCESS;
+		}
+	}
+
+	return FAILURE;
+}
+
+
+/**/
+void Term_Cursor_Init( TERM_CURSOR *cursor, HASH_T *Hash_T )
+{
+	cursor -> table = Hash_T;
+	cursor -> group = 0;
+	cursor -> node = Hash_T -> Letter[0].link;
+	cursor -> pos = 0;
+}
+
+
+/**/
+Status Term_Cursor_Next( TERM_CURSOR *cursor, TERM_REF *ref, INDEX *group )
+{
+	MAPPED_INDEX *map = cursor -> table -> Mapped;
+
+	// Words re-indexed over a mapping live in the heap: the whole dictionary joins them there first
+	if( map != NULL && !map -> materialised && cursor -> pos == 0 && cursor -> table -> word_total > 0 )
+	{
+		if( Materialise_Mapped_Index( cursor -> table ) == FAILURE )
+			return FAILURE;
+
+		cursor -> node = cursor -> table -> Letter[0].link;
+	}
+
+	// A mapped index is stored in dictionary order, which is also letter-group order
+	if( map != NULL && !map -> materialised )
+	{
+		if( cursor -> pos >= map -> header -> term_count )
+			return FAILURE;
+
+		Mapped_Term_Ref( map, cursor -> pos++, ref );
+		ref -> docs = Doc_Tombstones( &cursor -> table -> Docs );
+		*group = Find_Index( ref -> word[0] );
+		return SUCCESS;
+	}
+
+	while( cursor -> node == NULL )
+	{
+		if( ++cursor -> group >= LETTER_GROUPS )
+			return FAILURE;
+
+		cursor -> node = cursor -> table -> Letter[ cursor -> group ].link;
+	}
+
+	MAIN_NODE *node = cursor -> node;
+	cursor -> node = node -> Next_Main_node;
+
+	ref -> word = node -> word;
+	ref -> file_count = node -> file_count;
+	ref -> node = node;
+	ref -> postings = NULL;
+	ref -> postings_len = 0;
+	ref -> doc_limit = 0;
+	ref -> positional = cursor -> table -> Positional;
+	ref -> docs = Doc_Tombstones( &cursor -> table -> Docs );
+	*group = cursor -> group;
+
+	return SUCCESS;
+}
+
+
+/**/
+void Set_Positional_Index( int enable )
+{
+	Positional_Default = enable;
+}
+
+
+/**/
+void Adopt_Posting_Form( HASH_T *Hash_T )
+{
+	// Positions cannot be added to postings that were stored without them
+	if( Hash_T -> Docs.count == 0 && Hash_T -> Mapped == NULL )
+		Hash_T -> Positional = Positional_Default;
+}
@@ -7,20 +7,276 @@
 
 INDEX Find_Index( char chr );
 
-SUB_NODE* Create_Sub_Node( char* filename );
+SUB_NODE* Create_Sub_Node( HASH_T *Hash_T, DOC_ID doc_id );
 
-void Initialise_Hash_Table( HASH_T *Hash_T );
+Status Initialise_Hash_Table( HASH_T *Hash_T );
+
+void Free_Hash_Table( HASH_T *Hash_T );
+
+HASH_VALUE Hash_Word( const char *word );
+
+MAIN_NODE* Find_Main_Node( HASH_T *Hash_T, const char *word );
+
+void Finish_Rehash( HASH_T *Hash_T );
+
+Status Link_Main_Node( HASH_T *Hash_T, MAIN_NODE *node );
+
+void Report_Memory_Usage( HASH_T *Hash_T );
+
+size_t Index_Memory_Bytes( HASH_T *Hash_T );
+
+int Compare_Terms( const char *a, const char *b );
+
+Status Lookup_Term( HASH_T *Hash_T, const char *word, TERM_REF *ref );
+
+void Term_Cursor_Init( TERM_CURSOR *cursor, HASH_T *Hash_T );
+
+void Set_Positional_Index( int enable );
+
+void Adopt_Posting_Form( HASH_T *Hash_T );
+
+Status Term_Cursor_Next( TERM_CURSOR *cursor, TERM_REF *ref, INDEX *group );
+
+Status Update_Term_Dict( HASH_T *Hash_T );
+
+size_t Term_Dict_Size( HASH_T *Hash_T );
+
+void Term_Dict_Ref( HASH_T *Hash_T, size_t pos, TERM_REF *ref );
+
+size_t Term_Dict_Seek( HASH_T *Hash_T, const char *word );
+
+int Match_Pattern( const char *pattern, const char *word );
+
+size_t Expand_Pattern( HASH_T *Hash_T, const char *pattern, TERM_REF *out, size_t max );
+
+size_t Expand_Range( HASH_T *Hash_T, const char *from, const char *to, TERM_REF *out, size_t max );
+
+int Auto_Fuzzy_Distance( const char *word );
+
+size_t Expand_Fuzzy( HASH_T *Hash_T, const char *word, int distance, TERM_REF *out, int *out_distance, size_t max );
+
+void Free_Term_Dict( HASH_T *Hash_T );
+
+Status Save_Binary_Index( HASH_T *Hash_T, const char *filename );
+
+INDEX_WRITER* Open_Index_Writer( const char *filename, DOC_TABLE *Docs, int positional );
+
+Status Index_Writer_Term( INDEX_WRITER *writer, const char *word, const unsigned char *postings, unsigned int length, No_Of_Files file_count );
+
+Status Close_Index_Writer( INDEX_WRITER *writer, Status status );
+
+Status Load_Binary_Index( HASH_T *Hash_T, const char *filename );
+
+Status Verify_Binary_Index( HASH_T *Hash_T );
+
+void Unmap_Binary_Index( HASH_T *Hash_T );
+
+long Mapped_Find_Term( MAPPED_INDEX *map, const char *word );
+
+void Mapped_Term_Ref( MAPPED_INDEX *map, long pos, TERM_REF *ref );
+
+Status Materialise_Mapped_Index( HASH_T *Hash_T );
+
+Status Materialise_Mapped_Term( HASH_T *Hash_T, const char *word, MAIN_NODE **node );
+
+Status Freeze_Hash_Table( HASH_T *Hash_T );
+
+Status Thaw_Main_Node( HASH_T *Hash_T, MAIN_NODE *node );
+
+void Posting_Iter_Init( POSTING_ITER *it, MAIN_NODE *node, int positional );
+
+void Posting_Iter_Init_Term( POSTING_ITER *it, TERM_REF *ref );
+
+Status Posting_Iter_Next( POSTING_ITER *it );
+
+Status Posting_Iter_Seek( POSTING_ITER *it, DOC_ID target );
+
+DOC_ID Frozen_Last_Doc( MAIN_NODE *node, int positional );
+
+long Concat_Postings( TERM_REF *part, const DOC_ID *base, int count, unsigned char **buffer, size_t *capacity );
+
+Status Add_Frozen_Term( HASH_T *Hash_T, const char *word, const unsigned char *postings, unsigned int length, No_Of_Files file_count );
+
+No_Of_Files Live_File_Count( TERM_REF *ref );
+
+size_t Posting_Skip_Bytes( No_Of_Files file_count );
+
+Status Append_Positions( HASH_T *Hash_T, SUB_NODE *sub, Word_Count count, const unsigned char *deltas );
+
+int Varint_Encode( unsigned char *out, unsigned long value );
+
+unsigned long Varint_Decode( const unsigned char **in );
+
+void Arena_Init( ARENA *arena, size_t block_size, size_t align );
+
+void* Arena_Alloc( ARENA *arena, size_t size );
+
+void Arena_Release( ARENA *arena );
+
+void Arena_Report( ARENA *arena, const char *label );
+
+Status Initialise_Doc_Table( DOC_TABLE *Docs );
+
+void Free_Doc_Table( DOC_TABLE *Docs );
+
+Status Register_Document( DOC_TABLE *Docs, const char *filename, DOC_ID *doc_id );
+
+Status Find_Document( DOC_TABLE *Docs, const char *filename, DOC_ID *doc_id );
+
+Status Record_Document_File( DOC_TABLE *Docs, DOC_ID doc_id, const char *filename, FILE *fptr );
+
+Status Find_Document_File( DOC_TABLE *Docs, const char *filename, FILE *fptr, DOC_ID *doc_id );
+
+Status Delete_Document( DOC_TABLE *Docs, DOC_ID doc_id );
+
+Status Restore_Document( DOC_TABLE *Docs, DOC_ID doc_id );
+
+const DOC_TABLE* Doc_Tombstones( DOC_TABLE *Docs );
+
+const char* Doc_Name( DOC_TABLE *Docs, DOC_ID doc_id );
+
+void Set_Document_Length( DOC_TABLE *Docs, DOC_ID doc_id, Word_Count length );
 
 Status Create_DataBase( HASH_T *Hash_T, LIST **head );
 
-MAIN_NODE* Create_Main_Node( char* word, char* filename );
+Status Index_File( HASH_T *Hash_T, FILE *fptr, DOC_ID doc_id );
+
+Status Tokenize_File( FILE *fptr, TOKEN_SINK sink, void *context, TOKEN_STATS *stats );
+
+void Set_Tokenizer_SIMD( int enable );
+
+void Report_Tokenizer_Throughput( TOKEN_STATS *stats, double seconds );
+
+void Set_Normalizer( unsigned flags );
+
+unsigned Normalizer_Flags( void );
+
+Status Normalize_Word( const char *word, char *term );
+
+Status Load_Stopwords( const char *filename );
+
+void Free_Stopwords( void );
 
-Status Insert_To_Hash_Table( int index, char* word, char* filename, HASH_T *Hash_T );
+Status Find_Batch_Command( const char *name );
+
+int Run_Batch( int argc, char *argv[], BUILD_OPTIONS *options, HASH_T *H_Table );
+
+Status Create_DataBase_Parallel( HASH_T *Hash_T, LIST **head, int threads );
+
+Status Merge_Partial_Index( HASH_T *Hash_T, HASH_T *partial );
+
+Status Open_Shard_Set( SHARD_SET *set, HASH_T *table, int count );
+
+void Close_Shard_Set( SHARD_SET *set );
+
+void Shard_File_Name( char *name, const char *base, int shard, int count );
+
+Status Build_Shards( SHARD_SET *set, LIST **head, int threads );
+
+Status Load_Shards( SHARD_SET *set, const char *db, const char *index, int verify );
+
+Status Save_Shards( SHARD_SET *set, const char *save, const char *save_index );
+
+Status Freeze_Shards( SHARD_SET *set );
+
+Status Compact_Shards( SHARD_SET *set );
+
+Status Shard_Remove_Document( SHARD_SET *set, const char *filename );
+
+Status Shard_Reindex_Document( SHARD_SET *set, const char *filename );
+
+Status Shard_Evaluate_Query( SHARD_SET *set, const char *text, SHARD_RESULT *result, char *error, size_t size );
+
+Status Shard_Term_Postings( SHARD_SET *set, const char *word, SHARD_RESULT *result );
+
+Status Shard_Rank_Query( SHARD_SET *set, const char *text, size_t k, int prune, SHARD_RESULT *result );
+
+long Shard_Live_Terms( SHARD_SET *set );
+
+void Free_Shard_Result( SHARD_RESULT *result );
+
+SEGMENT_INDEX* Open_Segment_Index( int readers );
+
+Status Attach_Segment_Store( SEGMENT_INDEX *index, const char *base );
+
+Status Start_Segment_Merger( SEGMENT_INDEX *index );
+
+Status Publish_Segment( SEGMENT_INDEX *index, HASH_T *segment );
+
+Status Segment_Index_Documents( SEGMENT_INDEX *index, DOC_TABLE *seen );
+
+const SNAPSHOT* Enter_Snapshot( SEGMENT_INDEX *index, int reader );
+
+void Leave_Snapshot( SEGMENT_INDEX *index, int reader );
+
+int Snapshot_Segments( const SNAPSHOT *snapshot );
+
+size_t Snapshot_Documents( const SNAPSHOT *snapshot );
+
+const char* Snapshot_Doc_Name( const SNAPSHOT *snapshot, const SHARD_HIT *hit );
+
+Status Snapshot_Term_Postings( const SNAPSHOT *snapshot, const char *word, SHARD_RESULT *result );
+
+Status Snapshot_Evaluate_Query( const SNAPSHOT *snapshot, const char *text, SHARD_RESULT *result, char *error, size_t size );
+
+void Close_Segment_Index( SEGMENT_INDEX *index );
+
+Status Build_External_Index( LIST **head, size_t budget, const char *filename );
+
+Status Merge_Index_Files( HASH_T **part, int count, const char *filename );
+
+Status Merge_Index_Tables( HASH_T **part, int count, HASH_T *merged );
+
+CORPUS* Open_Corpus( LIST *head );
+
+Status Next_Corpus_File( CORPUS *corpus, char *path );
+
+void Skip_Corpus_File( CORPUS *corpus );
+
+void Close_Corpus( CORPUS *corpus );
+
+Status Remove_Document( HASH_T *Hash_T, const char *filename );
+
+Status Reindex_Document( HASH_T *Hash_T, const char *filename );
+
+Status Compact_Index( HASH_T *Hash_T );
+
+MAIN_NODE* Create_Main_Node( HASH_T *Hash_T, char* word, DOC_ID doc_id );
+
+Status Insert_To_Hash_Table( char* word, DOC_ID doc_id, HASH_T *Hash_T );
+
+Status Add_Posting( HASH_T *Hash_T, char* word, DOC_ID doc_id, Word_Count count );
+
+Status Add_Posting_Positions( HASH_T *Hash_T, char* word, DOC_ID doc_id, Word_Count count, const unsigned char *deltas );
+
+Status Add_Term_Posting( HASH_T *Hash_T, MAIN_NODE **node, char* word, DOC_ID doc_id, Word_Count count, const unsigned char *deltas );
 
 DISPLAY Display_DataBase( HASH_T* H_Table );
 
 Status Search_DataBase( HASH_T* H_Table, char* word );
 
+Status Parse_Query( const char *text, QUERY *query );
+
+Status Expand_Query_Terms( HASH_T *H_Table, QUERY *query );
+
+Status Evaluate_Query( HASH_T *H_Table, QUERY *query, QUERY_RESULT *result );
+
+void Free_Query( QUERY *query );
+
+void Free_Query_Result( QUERY_RESULT *result );
+
+Status Search_Query( HASH_T *H_Table, char *text );
+
+Status Rank_Query( HASH_T *H_Table, const char *text, size_t k, int prune, RANK_RESULT *result );
+
+Status Rank_Query_Scope( HASH_T *H_Table, const char *text, size_t k, int prune, const RANK_SCOPE *scope, RANK_RESULT *result );
+
+void Update_Doc_Lengths( HASH_T *H_Table );
+
+void Free_Rank_Result( RANK_RESULT *result );
+
+Status Ranked_Search( HASH_T *H_Table, char *text, size_t k );
+
 void Display_Menu();
 
 Status Print_List( LIST *head );
@@ -29,8 +285,36 @@ Status Add_To_List( LIST **head, char *filename, FILE *fptr );
 
 Status Save_DataBase( HASH_T* H_Table );
 
+Status Save_DataBase_File( HASH_T* H_Table, const char *filename, int append_mode );
+
+void Set_Save_Mark( HASH_T* H_Table, const char *filename, unsigned int generation );
+
+void Clear_Save_Mark( HASH_T* H_Table );
+
+void Record_Save_Word( HASH_T* H_Table, MAIN_NODE *node, SUB_NODE *first );
+
+void Record_Save_Removal( HASH_T* H_Table, DOC_ID doc_id );
+
+void Forget_Save_Changes( HASH_T* H_Table );
+
+Status Sync_Close( FILE *fptr );
+
+Status Commit_File( const char *temp_name, const char *filename );
+
+Status Log_Document_Change( HASH_T *H_Table, char change, const char *filename );
+
+Status Log_Added_Documents( HASH_T *H_Table, DOC_ID first );
+
+Status Replay_Document_Log( HASH_T *H_Table, const char *filename );
+
+Status Discard_Document_Log( const char *filename );
+
 Status  Update_DataBase( HASH_T* H_Table, LIST **head );
 
+Status Load_DataBase_File( HASH_T* H_Table, const char *filename );
+
+void Set_Load_Threads( int threads );
+
 Status File_Already_Indexed (const char *fname, HASH_T *Hash_T );
 
 
@@ -0,0 +1,205 @@
+/*******************************************************************************************************************************************************************
+ * File        : Live_Update.c
+ * Project     : Inverted Search Engine (Project-2)
+ *
+ * Description :
+ *      Adding, re-indexing and removing single documents of a live index. The document table
+ *      (Doc_Table.c) keeps a version and a deleted flag per document, so none of these touch
+ *      the postings of other documents:
+ *
+ *          remove   → the document becomes a tombstone, O(1)
+ *          re-index → the old id becomes a tombstone and the file is indexed again under a new
+ *                     id with the next version, O(size of the file): new postings are chained
+ *                     after frozen lists, never merged into them
+ *          add      → a re-index of a name that was never indexed
+ *
+ *      Readers skip the postings of tombstones ( TERM_REF -> docs, Postings.c ), so results are
+ *      those of a fresh build of the live files straight away. The dead postings themselves stay
+ *      until Compact_Index() rebuilds the table without them.
+ *
+ * Function Overview :
+ *
+ *      → Remove_Document( HASH_T *Hash_T, const char *filename )
+ *            • NOT_EXISTS when filename is not a live document of the index
+ *            • Files are matched by name or by identity ( Find_Document_File() ), so any path works
+ *
+ *      → Reindex_Document( HASH_T *Hash_T, const char *filename )
+ *            • Opens filename ( .txt ), tombstones its current version if any and indexes it again
+ *            • When indexing fails the partial new version is tombstoned and the old one restored
+ *            • On a mapped binary index only the words of the file are copied into the heap table
+ *              ( Materialise_Mapped_Term() ), not the whole dictionary
+ *
+ *      → Compact_Index( HASH_T *Hash_T )
+ *            • Rebuilds the table from its live postings through Merge_Partial_Index() and freezes it
+ *            • Live documents keep their order and versions, ids become dense again, and words
+ *              found only in deleted documents disappear
+ *            • File identities are looked up again lazily ( Find_Document_File() )
+ *            • Nothing to do ( SUCCESS ) while there are no tombstones
+ *
+ * Notes :
+ *      • Save_DataBase_File() and Save_Binary_Index() compact first: both write file_count, and
+ *        the binary index writes frozen lists as they are
+ *      • Compaction holds the old and the new table at the same time; on failure the old one is kept
+ *      • Every change is appended to the write-ahead log of the table's save file before it is
+ *        reported ( Log_Document_Change(), Write_Ahead_Log.c ), and a removed saved version is
+ *        recorded for the next delta save ( Record_Save_Removal(), Save_DataBase.c )
+ *      • Postings of re-indexed words stay in SUB_NODE chains after the frozen bytes until the
+ *        next compaction or freeze
+ *
+ *******************************************************************************************************************************************************************/
+
+
+#include "Inverted_Search.h"
+#include "Types.h"
+#include "Validate.h"
+
+
+/**/
+Status Remove_Document( HASH_T *Hash_T, const char *filename )
+{
+	DOC_ID doc_id;
+
+	if( Find_Document_File( &Hash_T -> Docs, filename, NULL, &doc_id ) == NOT_EXISTS )
+	{
+		printf("[INFO]: '%s' is not in the database\n", filename );
+		return NOT_EXISTS;
+	}
+
+	Delete_Document( &Hash_T -> Docs, doc_id );
+	Record_Save_Removal( Hash_T, doc_id );
+
+	if( Log_Document_Change( Hash_T, 'r', Doc_Name( &Hash_T -> Docs, doc_id ) ) == FAILURE )
+		printf("[INFO]: The removal is not logged and is lost unless the database is saved\n");
+
+	printf("[INFO]: '%s' removed ( %zu deleted document%s awaiting compaction )\n",
+			Doc_Name( &Hash_T -> Docs, doc_id ), Hash_T -> Docs.deleted, Hash_T -> Docs.deleted > 1 ? "s" : "" );
+
+	return SUCCESS;
+}
+
+
+/**/
+Status Reindex_Document( HASH_T *Hash_T, const char *filename )
+{
+	FILE *fptr;
+
+	if( Check_Ext( ( char* ) filename ) == FAILURE )
+	{
+		printf("[INFO]: %s File wrong extension\n", filename );
+		return FAILURE;
+	}
+
+	if( Check_Avail( ( char* ) filename, &fptr ) == FAILURE )
+	{
+		printf("[INFO]: %s File not available\n", filename );
+		return FAILURE;
+	}
+
+	Adopt_Posting_Form( Hash_T );
+
+	DOC_ID old_id;
+	DOC_ID doc_id;
+	int replaced = Find_Document_File( &Hash_T -> Docs, filename, fptr, &old_id ) == EXISTS;
+
+	// The new version keeps the name it was indexed under, whatever path reached it; the old one
+	// steps aside so the name registers a new id, and comes back if the new one cannot be indexed
+	if( replaced )
+	{
+		filename = Doc_Name( &Hash_T -> Docs, old_id );
+		Delete_Document( &Hash_T -> Docs, old_id );
+	}
+
+	Status status = Register_Document( &Hash_T -> Docs, filename, &doc_id );
+	int registered = status == SUCCESS;
+
+	if( status == SUCCESS )
+	{
+		Record_Document_File( &Hash_T -> Docs, doc_id, filename, fptr );
+		status = Index_File( Hash_T, fptr, doc_id );
+	}
+
+	fclose( fptr );
+
+	if( status == FAILURE )
+	{
+		// The postings indexed so far belong to a tombstone and are dropped by the next compaction
+		if( registered )
+			Delete_Document( &Hash_T -> Docs, doc_id );
+
+		if( replaced )
+			Restore_Document( &Hash_T -> Docs, old_id );
+
+		printf("[INFO]: Indexing '%s' failed%s\n", filename, replaced ? ", keeping its current version" : "" );
+		return FAILURE;
+	}
+
+	if( replaced )
+		Record_Save_Removal( Hash_T, old_id );
+
+	if( Log_Document_Change( Hash_T, 'a', filename ) == FAILURE )
+		printf("[INFO]: The change is not logged and is lost unless the database is saved\n");
+
+	printf("[INFO]: '%s' %s ( version %u, %ld terms )\n", filename, replaced ? "re-indexed" : "added",
+			Hash_T -> Docs.doc[doc_id].version, Hash_T -> Docs.doc[doc_id].length );
+
+	return SUCCESS;
+}
+
+
+/**/
+Status Compact_Index( HASH_T *Hash_T )
+{
+	DOC_TABLE *Docs = &Hash_T -> Docs;
+
+	if( Docs -> deleted == 0 )
+		return SUCCESS;
+
+	HASH_T fresh;
+
+	if( Initialise_Hash_Table( &fresh ) == FAILURE )
+		return FAILURE;
+
+	fresh.Positional = Hash_T -> Positional;
+
+	// Live documents are registered in their old order, so every merged list stays in doc id order,
+	// and the old table's readers skip its tombstones, so only live postings are copied
+	Status status = Merge_Partial_Index( &fresh, Hash_T );
+
+	for( size_t id = 0; id < Docs -> count && status == SUCCESS; id++ )
+	{
+		DOC_ID new_id;
+
+		if( !Docs -> doc[id].deleted && Find_Document( &fresh.Docs, Docs -> doc[id].name, &new_id ) == EXISTS )
+			fresh.Docs.doc[new_id].version = Docs -> doc[id].version;
+	}
+
+	if( status == FAILURE )
+	{
+		printf("[INFO]: Compaction failed, keeping the index as it is\n");
+		Free_Hash_Table( &fresh );
+		return FAILURE;
+	}
+
+	fresh.Docs.lengths_stale = Docs -> lengths_stale;
+
+	if( Freeze_Hash_Table( &fresh ) == FAILURE )
+		printf("[INFO]: Could not compress postings, keeping linked lists\n");
+
+	size_t dropped = Docs -> deleted;
+
+	// The save file and its log stay with the table, but ids changed: the next save is a full one
+	SAVE_MARK saved = Hash_T -> Saved;
+	memset( &Hash_T -> Saved, 0, sizeof( SAVE_MARK ) );
+
+	Free_Hash_Table( Hash_T );
+	*Hash_T = fresh;
+
+	Hash_T -> Saved = saved;
+	Hash_T -> Saved.generation = 0;
+	Forget_Save_Changes( Hash_T );
+
+	printf("[INFO]: Compaction done: %zu deleted document%s dropped, %zu left, %zu words\n",
+			dropped, dropped > 1 ? "s" : "", Hash_T -> Docs.count, Hash_T -> word_total );
+
+	return SUCCESS;
+}
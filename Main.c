@@ -6,7 +6,7 @@
  *
  * Description  :
  *      Main driver program for the Inverted Search Engine project. This module:
- *          • Validates input text files and stores them into a file list
+ *          • Validates input text files and directories and stores them into a file list
  *          • Initializes hash table structure used for building the inverted index
  *          • Provides a menu-driven interface to perform core operations:
  *
@@ -15,12 +15,17 @@
  *              3. Search for a word across indexed files
  *              4. Save the database to storage
  *              5. Load/Update the database from existing file
- *              6. Exit cleanly and close all open file pointers
+ *              6. Exit cleanly, close all open file pointers and release the index
+ *              7. Save the database as a binary index file
+ *              8. Load a binary index through mmap (queried in place)
+ *              9. Ranked search: top k files by BM25 score (Rank.c)
+ *             10. Manage documents: add / re-index or remove one file, compact (Live_Update.c)
  *
  * Data Structure Layout:
- *      HASH_T H_Table[27]  → Hash buckets
- *          0–25 represent 'a' to 'z'
- *          26 stores numbers, symbols, or others
+ *      HASH_T H_Table      → Whole-word hash index (FNV-1a, incremental resize)
+ *          Letter[0–25] group words starting with 'a' to 'z'
+ *          Letter[26] groups numbers, symbols, or others
+ *          Letter groups fix the Display / Save order
  *
  *      MAIN_NODE per unique word:
  *          • Stores word string
@@ -37,8 +42,13 @@
  * Example:
  *      #5; file; 1; report.txt; 3; #
  *
+ * Binary Index Format ( Binary_Index.c ):
+ *      header + doc table + frozen postings + sorted dictionary, CRC32 per section
+ *
  * Program Flow Summary:
- *      1. Collect and validate filenames from command line
+ *      0. A subcommand ( build / load / save / query / stats / serve / add ) runs without the menu (Batch_Mode.c)
+ *      1. Collect options ( -j N indexing threads, --no-simd, normalization, --positions, --include ) and validate
+ *         filenames and directories from command line
  *      2. Create inverted index on request (menu)
  *      3. Perform display/search/save/update operations interactively
  *      4. Graceful shutdown with complete file closure
@@ -53,6 +63,11 @@
  *      • Database creation allowed only once until update operation resets flag
  *      • Update loads database from save file only when fresh database not already created
  *      • Every exit path ensures open file pointers are properly closed
+ *      • All index nodes live in per-table arenas and are released together on reload / exit
+ *      • Words are normalized ( case, punctuation, optional stemming / stopwords ) before
+ *        indexing and before every search (Normalize.c)
+ *      • After creation postings are frozen into sorted delta + varint arrays (Postings.c)
+ *      • Removed / re-indexed files leave tombstones that searches skip; saving compacts them away
  *
  *******************************************************************************************************************************************************************/
 
@@ -60,18 +75,35 @@
 #include "Inverted_Search.h"
 #include "Types.h"
 #include "Validate.h"
+#include <time.h>
 
 
 int main(int argc, char *argv[])
 {
 
 	LIST *head;
-	HASH_T H_Table[27];
+	HASH_T H_Table;
+	BUILD_OPTIONS options;
 	int Created_DataBase = 0;
 	int Updated_DataBase = 0;
 
 
-	Initialise_Hash_Table( H_Table );
+	if( Initialise_Hash_Table( &H_Table ) == FAILURE )
+	{
+		printf("[INFO]: Could not allocate the hash table\n");
+		return 1;
+	}
+
+	Read_Options( &argc, argv, &options );
+
+	// Subcommands ( build / load / save / query / stats / serve / add ) run without the menu
+	if( argc > 1 && Find_Batch_Command( argv[1] ) == EXISTS )
+		return Run_Batch( argc, argv, &options, &H_Table );
+
+	Apply_Options( &options );
+
+	if( options.shards > 1 )
+		printf("[INFO]: --shards applies to batch commands; the menu keeps one table\n");
 
 	if( Read_and_Validate( argc, argv, &head ) == SUCCESS )
 	{
@@ -98,23 +130,41 @@ int main(int argc, char *argv[])
 					break;
 				}
 
-				Create_DataBase( H_Table, &head );
+				struct timespec start, stop;
+				clock_gettime( CLOCK_MONOTONIC, &start );
+
+				DOC_ID first = H_Table.Docs.count;
+				Create_DataBase_Parallel( &H_Table, &head, options.threads );
+
+				clock_gettime( CLOCK_MONOTONIC, &stop );
+
+				// Files added to a loaded database go to its write-ahead log
+				if( Log_Added_Documents( &H_Table, first ) == FAILURE )
+					printf("[INFO]: The new files are not logged and are lost unless the database is saved\n");
+
 				printf("\n[INFO]: DataBase Creation Successful\n");
+				Report_Tokenizer_Throughput( &H_Table.Tokens, ( stop.tv_sec - start.tv_sec ) + ( stop.tv_nsec - start.tv_nsec ) / 1e9 );
+
+				// Build is complete: compress postings into their read-only form
+				if( Freeze_Hash_Table( &H_Table ) == FAILURE )
+					printf("[INFO]: Could not compress postings, keeping linked lists\n");
+
+				Report_Memory_Usage( &H_Table );
 				Created_DataBase = 1;
 				Updated_DataBase = 1;
 
 				break;
 
 			case 2:
-				Display_DataBase( H_Table );
+				Display_DataBase( &H_Table );
 				break;
 
 			case 3:
-				char word[50];
-				printf("\n[INFO]: Enter the Word you wish to search: ");
-				scanf("%s", word);
+				char query[256];
+				printf("\n[INFO]: Enter a word or query ( AND / OR / NOT, parentheses ): ");
+				scanf(" %255[^\n]", query);
 
-				Search_DataBase( H_Table, word );
+				Search_Query( &H_Table, query );
 				break;
 
 			case 4:
@@ -124,7 +174,7 @@ int main(int argc, char *argv[])
 					break;
 				}
 
-				Save_DataBase( H_Table );
+				Save_DataBase( &H_Table );
 				break;
 
 			case 5:
@@ -134,7 +184,7 @@ int main(int argc, char *argv[])
 					break;
 				}
 				
-				if(	Update_DataBase( H_Table, &head ) == SUCCESS )
+				if(	Update_DataBase( &H_Table, &head ) == SUCCESS )
 				{
 					Updated_DataBase = 1;
 					Created_DataBase = 0;
@@ -152,10 +202,116 @@ int main(int argc, char *argv[])
 						temp = temp -> link;
 					}
 
+					Report_Memory_Usage( &H_Table );
+					Free_Hash_Table( &H_Table );
+					Free_Stopwords();
+
 					printf("\n[INFO]: All files closed successfully.\n");
 					printf("[INFO]: Exiting Inverted Search. Goodbye!\n");
 					exit(0);
 				}
+
+			case 7:
+				if( Updated_DataBase == 0 && Created_DataBase == 0 )
+				{
+					printf("\n[INFO]: No DataBase to Save. Create One First\n");
+					break;
+				}
+
+				{
+					char index_name[256] = "Saved_DataBase.idx";
+					printf("\n[INFO]: Enter binary index filename ( . for '%s' ): ", index_name );
+					scanf("%251s", index_name );
+
+					if( strcmp( index_name, "." ) == 0 )
+						strcpy( index_name, "Saved_DataBase.idx" );
+
+					Save_Binary_Index( &H_Table, index_name );
+				}
+				break;
+
+			case 8:
+				if( Created_DataBase == 1 || Updated_DataBase == 1 )
+				{
+					printf("\n[INFO]: Update DataBase already done\n");
+					break;
+				}
+
+				{
+					char index_name[256] = "Saved_DataBase.idx";
+					char verify;
+
+					printf("\n[INFO]: Enter binary index filename ( . for '%s' ): ", index_name );
+					scanf("%251s", index_name );
+
+					if( strcmp( index_name, "." ) == 0 )
+						strcpy( index_name, "Saved_DataBase.idx" );
+
+					if( Load_Binary_Index( &H_Table, index_name ) == SUCCESS )
+					{
+						Updated_DataBase = 1;
+						Created_DataBase = 0;
+
+						printf("[INFO]: Verify postings checksum now? (y/n): ");
+						scanf(" %c", &verify );
+
+						if( verify == 'y' || verify == 'Y' )
+							Verify_Binary_Index( &H_Table );
+					}
+				}
+				break;
+
+			case 9:
+				{
+					char ranked[256];
+					size_t k = RANK_DEFAULT_K;
+
+					printf("\n[INFO]: Enter the query words: ");
+					scanf(" %255[^\n]", ranked );
+
+					printf("[INFO]: Number of results ( 0 for %d ): ", RANK_DEFAULT_K );
+					if( scanf("%zu", &k ) != 1 || k == 0 )
+						k = RANK_DEFAULT_K;
+
+					Ranked_Search( &H_Table, ranked, k );
+				}
+				break;
+
+			case 10:
+				if( Updated_DataBase == 0 && Created_DataBase == 0 )
+				{
+					printf("\n[INFO]: No DataBase to manage. Create One First\n");
+					break;
+				}
+
+				{
+					char action;
+					char filename[256];
+
+					printf("\n[INFO]: a ( add / re-index a file ), r ( remove a file ), c ( compact ): ");
+					scanf(" %c", &action );
+
+					if( action == 'c' || action == 'C' )
+					{
+						Compact_Index( &H_Table );
+						break;
+					}
+
+					if( action != 'a' && action != 'A' && action != 'r' && action != 'R' )
+					{
+						printf("[INFO]: Invalid Option\n");
+						break;
+					}
+
+					printf("[INFO]: Enter the filename: ");
+					scanf("%255s", filename );
+
+					if( action == 'r' || action == 'R' )
+						Remove_Document( &H_Table, filename );
+					else
+						Reindex_Document( &H_Table, filename );
+				}
+				break;
 				
 			default:
 				printf("\n[INFO]: Invalid Option\n");
@@ -0,0 +1,214 @@
+/*******************************************************************************************************************************************************************
+ * File        : Normalize.c
+ * Project     : Inverted Search Engine (Project-2)
+ *
+ * Description :
+ *      Text normalization applied to every term between tokenization and the index, and to every
+ *      query word before lookup, so "Kichu", "kichu" and "kichu," all become the term "kichu".
+ *      The same stage runs when a saved database is loaded, so older save files are folded into
+ *      the current vocabulary.
+ *
+ *      Stages, in order ( each one switchable through NORM_* flags ):
+ *          NORM_FOLD_CASE    → ASCII letters lowercased
+ *          NORM_STRIP_PUNCT  → leading / trailing punctuation removed ( "don't", "3.14" kept whole )
+ *          NORM_STEM         → light plural stemmer: -ies → -y, -es → -e, -s → "" ( Harman S-stemmer )
+ *          NORM_STOPWORDS    → terms found in the stopword list are dropped
+ *
+ * Function Overview :
+ *
+ *      → Set_Normalizer( unsigned flags )      /  Normalizer_Flags()
+ *            • Selects the stages; NORM_DEFAULT is case folding + punctuation stripping
+ *
+ *      → Load_Stopwords( const char *filename )
+ *            • Reads whitespace separated words, normalizes them with the current stages,
+ *              keeps them sorted for binary search and turns NORM_STOPWORDS on
+ *
+ *      → Normalize_Word( const char *word, char *term )
+ *            • term must hold MAX_WORD_LENGTH bytes
+ *            • SUCCESS with the normalized term, or EMPTY when nothing indexable is left
+ *              ( only punctuation, or a stopword )
+ *
+ *      → Free_Stopwords()
+ *
+ * Notes :
+ *      • Settings are process wide; choose them before indexing threads start
+ *      • Every stage is idempotent, so normalizing an already normalized term changes nothing
+ *      • The binary index records the flags it was built with ( INDEX_HEADER.flags )
+ *
+ *******************************************************************************************************************************************************************/
+
+
+#include "Inverted_Search.h"
+#include "Types.h"
+
+
+static unsigned Flags = NORM_DEFAULT;
+
+static char **Stopword = NULL;
+static size_t Stopword_count = 0;
+
+
+/**/
+void Set_Normalizer( unsigned flags )
+{
+	// The stopword stage needs a list to work with
+	if( Stopword_count == 0 )
+		flags &= ~NORM_STOPWORDS;
+
+	Flags = flags;
+}
+
+
+/**/
+unsigned Normalizer_Flags( void )
+{
+	return Flags;
+}
+
+
+/* Harman S-stemmer; only touches words ending in a single 's' */
+static void Stem_Plural( char *term, size_t *length )
+{
+	size_t n = *length;
+
+	if( n < 3 || term[n - 1] != 's' )
+		return;
+
+	if( n > 4 && strcmp( term + n - 3, "ies" ) == 0 && term[n - 4] != 'e' && term[n - 4] != 'a' )
+	{
+		term[n - 3] = 'y';
+		n -= 2;
+	}
+	else if( n > 3 && strcmp( term + n - 2, "es" ) == 0
+	         && term[n - 3] != 'a' && term[n - 3] != 'e' && term[n - 3] != 'o' )
+	{
+		n -= 1;
+	}
+	else if( term[n - 2] != 'u' && term[n - 2] != 's' )
+	{
+		n -= 1;
+	}
+
+	term[n] = '\0';
+	*length = n;
+}
+
+
+/* qsort / bsearch comparator on string pointers */
+static int Compare_Stopword( const void *a, const void *b )
+{
+	return strcmp( *( char* const* ) a, *( char* const* ) b );
+}
+
+
+/**/
+Status Normalize_Word( const char *word, char *term )
+{
+	const unsigned char *start = ( const unsigned char* ) word;
+	const unsigned char *end = start + strlen( word );
+
+	if( Flags & NORM_STRIP_PUNCT )
+	{
+		while( start < end && ispunct( *start ) )
+			start++;
+
+		while( end > start && ispunct( end[-1] ) )
+			end--;
+	}
+
+	size_t length = end - start;
+
+	if( length > MAX_WORD_LENGTH - 1 )
+		length = MAX_WORD_LENGTH - 1;
+
+	for( size_t i = 0; i < length; i++ )
+		term[i] = ( Flags & NORM_FOLD_CASE ) ? tolower( start[i] ) : start[i];
+
+	term[length] = '\0';
+
+	if( Flags & NORM_STEM )
+		Stem_Plural( term, &length );
+
+	if( length == 0 )
+		return EMPTY;
+
+	if( ( Flags & NORM_STOPWORDS ) && bsearch( &term, Stopword, Stopword_count, sizeof( char* ), Compare_Stopword ) != NULL )
+		return EMPTY;
+
+	return SUCCESS;
+}
+
+
+/**/
+Status Load_Stopwords( const char *filename )
+{
+	FILE *fptr = fopen( filename, "r" );
+	if( fptr == NULL )
+	{
+		printf("[INFO]: Could not open stopword list '%s'\n", filename );
+		return FILENOTFOUND;
+	}
+
+	Free_Stopwords();
+
+	// Stopwords go through the same stages as indexed terms ( without the stopword check )
+	unsigned saved = Flags;
+	Flags &= ~NORM_STOPWORDS;
+
+	size_t capacity = 0;
+	WORD word;
+	WORD term;
+	Status status = SUCCESS;
+
+	while( fscanf( fptr, "%99s", word ) == 1 )
+	{
+		if( Normalize_Word( word, term ) != SUCCESS )
+			continue;
+
+		if( Stopword_count == capacity )
+		{
+			capacity = capacity ? capacity * 2 : 64;
+
+			char **grown = realloc( Stopword, capacity * sizeof( char* ) );
+			if( grown == NULL )
+			{
+				perror("Realloc failed for stopword list");
+				status = FAILURE;
+				break;
+			}
+
+			Stopword = grown;
+		}
+
+		if( ( Stopword[ Stopword_count ] = strdup( term ) ) == NULL )
+		{
+			status = FAILURE;
+			break;
+		}
+
+		Stopword_count++;
+	}
+
+	fclose( fptr );
+
+	qsort( Stopword, Stopword_count, sizeof( char* ), Compare_Stopword );
+
+	Flags = saved;
+	Set_Normalizer( Stopword_count > 0 ? Flags | NORM_STOPWORDS : Flags );
+
+	printf("[INFO]: %zu stopword%s loaded from '%s'\n", Stopword_count, Stopword_count == 1 ? "" : "s", filename );
+	return status;
+}
+
+
+/**/
+void Free_Stopwords( void )
+{
+	for( size_t i = 0; i < Stopword_count; i++ )
+		free( Stopword[i] );
+
+	free( Stopword );
+	Stopword = NULL;
+	Stopword_count = 0;
+	Flags &= ~NORM_STOPWORDS;
+}
@@ -12,13 +12,13 @@
  *
  *      → Add_To_List( LIST **head, char *filename, FILE *fptr )
  *              Creates a new LIST node and appends it to the end of the linked list.
- *              Stores filename and the already-open file pointer for later processing.
+ *              Stores filename ( a file or a directory ) and an optional file pointer.
  *              Ensures dynamic memory allocation for each incoming file node.
  *
  * Input Details :
  *      • head     → Pointer to the head pointer of the file list
  *      • filename → Filename to store in the new node
- *      • fptr     → Valid file pointer associated with filename
+ *      • fptr     → File pointer associated with filename, NULL when it is not kept open
  *
  * Return Values :
  *      Print_List : SUCCESS → List printed successfully
@@ -29,7 +29,8 @@
  *
  * Notes :
  *      • Maintains insertion order – new files always added at the end.
- *      • File pointer remains open for later use in building the inverted index.
+ *      • Read_and_Validate() lists files closed ( NULL ); Create_DataBase() opens each one only
+ *        while it is indexed.
  *      • Safe dynamic allocation ensures flexible file handling.
  *
  *******************************************************************************************************************************************************************/
@@ -0,0 +1,386 @@
+/*******************************************************************************************************************************************************************
+ * File        : Parallel_Build.c
+ * Project     : Inverted Search Engine (Project-2)
+ *
+ * Description :
+ *      Multi-threaded Create_DataBase(). Worker threads take batches of files ( up to
+ *      BUILD_BATCH_FILES files or BUILD_BATCH_BYTES of text ), tokenize each batch into a private
+ *      partial index (its own HASH_T, arenas included), and hand the partial back through a small
+ *      ring of slots. The calling thread merges the partials into
+ *      the global table strictly in file order, so the result is identical to the sequential build:
+ *      same words, same letter-group order, same posting order, same counts.
+ *
+ * Function Overview :
+ *
+ *      → Create_DataBase_Parallel( HASH_T *Hash_T, LIST **head, int threads )
+ *            • threads <= 1 falls back to Create_DataBase()
+ *            • Files come from the walker (Corpus.c) as it discovers them; the calling thread registers
+ *              each new one as it fills a slot, so doc ids follow discovery order
+ *
+ *      → Merge_Partial_Index( HASH_T *Hash_T, HASH_T *partial )
+ *            • Adds every posting of partial to Hash_T through Add_Term_Posting(), positions included
+ *              when both tables keep them; each word is looked up once and its postings are
+ *              appended at the tail of its chain
+ *            • Partial doc ids are translated through the document names, once per document;
+ *              deleted documents of partial ( Compact_Index() ) are left out
+ *            • Adds the partial's tokenizer totals to Hash_T and copies document lengths
+ *
+ * Flow :
+ *      caller : next file → register → add to slot j % RING until the batch is full ( while fewer
+ *               than RING slots are unmerged ) → wait for the oldest slot → merge → free partial
+ *               → release slot
+ *      worker : claim filled slot j → for each file: open → Index_File() into the partial → close
+ *               → publish
+ *
+ * Notes :
+ *      • Memory is bounded by RING partial indexes of one batch each, whatever the number of files
+ *      • At most one file per worker is open at a time
+ *      • Doc ids are handed out before a worker opens the file; one it cannot open is skipped,
+ *        as the sequential build skips it, and its id is tombstoned before the merge
+ *      • The merge is one hash lookup per distinct word per batch plus one tail append per
+ *        ( word, file ), far cheaper than tokenizing, and it runs on the calling thread only
+ *
+ *******************************************************************************************************************************************************************/
+
+
+#include "Inverted_Search.h"
+#include "Types.h"
+#include <pthread.h>
+#include <sys/stat.h>
+
+
+typedef struct Build_Slot
+{
+	HASH_T partial;
+	char *path[ BUILD_BATCH_FILES ];    // files of this slot in doc id order, owned by the slot
+	DOC_ID doc_id[ BUILD_BATCH_FILES ]; // their ids in the target table
+	char unopened[ BUILD_BATCH_FILES ]; // could not be opened by the worker: skipped, not a failure
+	int files;
+	int failed;                     // first file that could not be indexed, -1 for none
+	int ready;
+	Status status;
+
+} BUILD_SLOT;
+
+
+typedef struct Build_State
+{
+	long filled;                    // jobs handed to slots by the calling thread
+	long next_job;                  // next job a worker will claim
+	long merged;                    // jobs already merged by the calling thread
+	int finished;                   // no more jobs will be filled
+
+	BUILD_SLOT *slot;
+	long ring;
+
+	int positional;                 // partials use the posting form of the target table
+
+	pthread_mutex_t lock;
+	pthread_cond_t changed;
+
+} BUILD_STATE;
+
+
+/**/
+Status Merge_Partial_Index( HASH_T *Hash_T, HASH_T *partial )
+{
+	TERM_CURSOR cursor;
+	TERM_REF term;
+	INDEX group;
+
+	Hash_T -> Tokens.bytes += partial -> Tokens.bytes;
+	Hash_T -> Tokens.tokens += partial -> Tokens.tokens;
+	Hash_T -> Tokens.truncated += partial -> Tokens.truncated;
+	Hash_T -> Tokens.dropped += partial -> Tokens.dropped;
+
+	// Partial doc ids are translated once per document, not once per posting
+	DOC_ID *global = malloc( ( partial -> Docs.count ? partial -> Docs.count : 1 ) * sizeof( DOC_ID ) );
+	if( global == NULL )
+		return FAILURE;
+
+	Status status = SUCCESS;
+
+	for( size_t id = 0; id < partial -> Docs.count && status == SUCCESS; id++ )
+	{
+		if( partial -> Docs.doc[id].deleted )
+			continue;
+
+		status = Register_Document( &Hash_T -> Docs, partial -> Docs.doc[id].name, &global[id] );
+
+		if( status == SUCCESS )
+			Set_Document_Length( &Hash_T -> Docs, global[id], partial -> Docs.doc[id].length );
+	}
+
+	Term_Cursor_Init( &cursor, partial );
+
+	while( status == SUCCESS && Term_Cursor_Next( &cursor, &term, &group ) == SUCCESS )
+	{
+		POSTING_ITER it;
+		MAIN_NODE *node = NULL;         // the word is looked up once, not once per posting
+
+		Posting_Iter_Init_Term( &it, &term );
+
+		while( status == SUCCESS && Posting_Iter_Next( &it ) == SUCCESS )
+		{
+			if( it.doc_id >= partial -> Docs.count )
+				status = FAILURE;
+			else
+				status = Add_Term_Posting( Hash_T, &node, ( char* ) term.word, global[ it.doc_id ], it.word_count, it.positions );
+		}
+	}
+
+	free( global );
+	return status;
+}
+
+
+/* Hand the slot being filled to the workers */
+static void Publish_Slot( BUILD_STATE *state )
+{
+	pthread_mutex_lock( &state -> lock );
+	state -> filled++;
+	pthread_cond_broadcast( &state -> changed );
+	pthread_mutex_unlock( &state -> lock );
+}
+
+
+/* Worker: build one partial index per claimed batch of files */
+static void* Build_Worker( void *arg )
+{
+	BUILD_STATE *state = arg;
+
+	pthread_mutex_lock( &state -> lock );
+
+	while( state -> next_job < state -> filled || !state -> finished )
+	{
+		// Slots are filled no further ahead of the merger than the ring allows
+		if( state -> next_job == state -> filled )
+		{
+			pthread_cond_wait( &state -> changed, &state -> lock );
+			continue;
+		}
+
+		long j = state -> next_job++;
+		pthread_mutex_unlock( &state -> lock );
+
+		BUILD_SLOT *slot = &state -> slot[ j % state -> ring ];
+
+		Status status = Initialise_Hash_Table( &slot -> partial );
+		slot -> partial.Positional = state -> positional;
+
+		// The files of a batch share one partial, so a word is merged once per batch
+		slot -> failed = -1;
+
+		for( int f = 0; status == SUCCESS && f < slot -> files; f++ )
+		{
+			DOC_ID local_id;
+			FILE *fptr = fopen( slot -> path[f], "r" );
+
+			// Skipped as the sequential build skips it; the calling thread drops its id
+			slot -> unopened[f] = fptr == NULL;
+			if( fptr == NULL )
+				continue;
+
+			Status indexed = Register_Document( &slot -> partial.Docs, slot -> path[f], &local_id );
+
+			if( indexed == SUCCESS )
+				indexed = Index_File( &slot -> partial, fptr, local_id );
+
+			if( fptr != NULL )
+				fclose( fptr );
+
+			// The rest of the batch is still indexed; the first failure is reported
+			if( indexed == FAILURE && slot -> failed < 0 )
+				slot -> failed = f;
+		}
+
+		pthread_mutex_lock( &state -> lock );
+		slot -> status = status;
+		slot -> ready = 1;
+		pthread_cond_broadcast( &state -> changed );
+	}
+
+	pthread_mutex_unlock( &state -> lock );
+	return NULL;
+}
+
+
+/**/
+Status Create_DataBase_Parallel( HASH_T *Hash_T, LIST **head, int threads )
+{
+	if( threads <= 1 )
+		return Create_DataBase( Hash_T, head );
+
+	if( head == NULL )
+	{
+		printf("[INFO]: No File to add to the List.\n");
+		return FAILURE;
+	}
+
+	Adopt_Posting_Form( Hash_T );
+
+	if( Materialise_Mapped_Index( Hash_T ) == FAILURE )
+		return FAILURE;
+
+	BUILD_STATE state;
+	state.ring = 2L * threads;
+	state.positional = Hash_T -> Positional;
+	state.slot = calloc( state.ring, sizeof( BUILD_SLOT ) );
+
+	if( state.slot == NULL )
+	{
+		perror("Malloc failed for parallel build");
+		return FAILURE;
+	}
+
+	CORPUS *corpus = Open_Corpus( *head );
+	if( corpus == NULL )
+	{
+		free( state.slot );
+		return FAILURE;
+	}
+
+	state.filled = 0;
+	state.next_job = 0;
+	state.merged = 0;
+	state.finished = 0;
+	pthread_mutex_init( &state.lock, NULL );
+	pthread_cond_init( &state.changed, NULL );
+
+	pthread_t *worker = malloc( threads * sizeof( pthread_t ) );
+	int started = 0;
+
+	for( int i = 0; worker != NULL && i < threads; i++ )
+	{
+		if( pthread_create( &worker[i], NULL, Build_Worker, &state ) == 0 )
+			started++;
+	}
+
+	Status status = SUCCESS;
+	int discovered = 0;             // the walker has no more files
+	off_t batch_bytes = 0;          // file bytes in the slot being filled
+
+	if( started == 0 )
+	{
+		printf("[INFO]: Could not start indexing threads\n");
+		status = FAILURE;
+		discovered = 1;
+	}
+
+	char filename[FILENAME_MAX];
+
+	while( 1 )
+	{
+		// Doc ids are handed out here, in discovery order, exactly as the sequential build does
+		while( !discovered && state.filled < state.merged + state.ring )
+		{
+			if( Next_Corpus_File( corpus, filename ) == FAILURE )
+			{
+				discovered = 1;
+				break;
+			}
+
+			if( File_Already_Indexed( filename, Hash_T ) == EXISTS )
+			{
+				printf("[INFO]: '%s' already present in database. Skipping...\n", filename );
+				continue;
+			}
+
+			BUILD_SLOT *slot = &state.slot[ state.filled % state.ring ];
+			DOC_ID doc_id;
+			struct stat st;
+
+			slot -> path[ slot -> files ] = strdup( filename );
+
+			if( slot -> path[ slot -> files ] == NULL || Register_Document( &Hash_T -> Docs, filename, &doc_id ) == FAILURE )
+			{
+				printf("[INFO]: Could not register '%s'. Skipping...\n", filename );
+
+				free( slot -> path[ slot -> files ] );
+				slot -> path[ slot -> files ] = NULL;
+				continue;
+			}
+
+			Record_Document_File( &Hash_T -> Docs, doc_id, filename, NULL );
+
+			slot -> doc_id[ slot -> files ] = doc_id;
+			slot -> files++;
+			batch_bytes += stat( filename, &st ) == 0 ? st.st_size : 0;
+
+			// Small files are batched into one partial; a large one fills a slot by itself
+			if( slot -> files < BUILD_BATCH_FILES && batch_bytes < BUILD_BATCH_BYTES )
+				continue;
+
+			Publish_Slot( &state );
+			batch_bytes = 0;
+		}
+
+		// The walker is done: the last, partly filled batch goes out as it is
+		if( discovered && state.filled < state.merged + state.ring && state.slot[ state.filled % state.ring ].files > 0 )
+			Publish_Slot( &state );
+
+		if( state.merged == state.filled )
+			break;
+
+		// Merge partials in file order as they become ready
+		BUILD_SLOT *slot = &state.slot[ state.merged % state.ring ];
+
+		pthread_mutex_lock( &state.lock );
+		while( !slot -> ready )
+			pthread_cond_wait( &state.changed, &state.lock );
+		pthread_mutex_unlock( &state.lock );
+
+		// Files the worker could not open were registered here already; they leave only a tombstone
+		for( int f = 0; f < slot -> files; f++ )
+		{
+			if( slot -> unopened[f] )
+			{
+				printf("[INFO]: Could not open '%s'. Skipping...\n", slot -> path[f] );
+				Delete_Document( &Hash_T -> Docs, slot -> doc_id[f] );
+				Skip_Corpus_File( corpus );
+			}
+		}
+
+		if( slot -> status == FAILURE || Merge_Partial_Index( Hash_T, &slot -> partial ) == FAILURE )
+			status = FAILURE;
+
+		if( slot -> failed >= 0 )
+		{
+			printf("[INFO]: Indexing '%s' failed\n", slot -> path[ slot -> failed ] );
+			status = FAILURE;
+		}
+
+		Free_Hash_Table( &slot -> partial );
+
+		for( int f = 0; f < slot -> files; f++ )
+		{
+			free( slot -> path[f] );
+			slot -> path[f] = NULL;
+		}
+
+		slot -> files = 0;
+
+		pthread_mutex_lock( &state.lock );
+		slot -> ready = 0;
+		state.merged++;
+		pthread_cond_broadcast( &state.changed );
+		pthread_mutex_unlock( &state.lock );
+	}
+
+	pthread_mutex_lock( &state.lock );
+	state.finished = 1;
+	pthread_cond_broadcast( &state.changed );
+	pthread_mutex_unlock( &state.lock );
+
+	for( int i = 0; i < started; i++ )
+		pthread_join( worker[i], NULL );
+
+	Close_Corpus( corpus );
+
+	pthread_mutex_destroy( &state.lock );
+	pthread_cond_destroy( &state.changed );
+	free( worker );
+	free( state.slot );
+
+	return status;
+}
@@ -0,0 +1,676 @@
+/*******************************************************************************************************************************************************************
+ * File        : Postings.c
+ * Project     : Inverted Search Engine (Project-2)
+ *
+ * Description :
+ *      Compact "frozen" posting lists. Once an index is built, every MAIN_NODE's SUB_NODE chain
+ *      is replaced by a doc-id sorted byte array in which each posting is stored as
+ *
+ *          varint( doc_id - previous doc_id ), varint( word_count )
+ *
+ *      A typical posting shrinks from a 24 byte SUB_NODE to 2 bytes. The SUB_NODE arena is
+ *      released after freezing, and readers decode postings on the fly through POSTING_ITER.
+ *
+ *      In a positional table ( --positions ) each posting is followed by its word_count token
+ *      positions, delta encoded from 0:
+ *
+ *          varint( doc delta ), varint( word_count ), varint( position delta ) x word_count
+ *
+ *      While building, a POS_SUB_NODE keeps the same position bytes in a buffer that doubles
+ *      inside the SUB_NODE arena, so freezing copies them as they are.
+ *
+ *      Lists with more than POSTING_SKIP_INTERVAL postings are preceded by a skip table with one
+ *      POSTING_SKIP { last_doc, offset } per interval, so Posting_Iter_Seek() can gallop over
+ *      whole blocks instead of decoding them. The table size follows from file_count alone.
+ *
+ * Function Overview :
+ *
+ *      → Freeze_Hash_Table( HASH_T *Hash_T )
+ *            • Encodes every posting chain into the posting arena and drops the SUB_NODE arena
+ *
+ *      → Thaw_Main_Node( HASH_T *Hash_T, MAIN_NODE *node )
+ *            • Decodes one frozen word back into a SUB_NODE chain so it can be modified again
+ *
+ *      → Posting_Iter_Init( POSTING_ITER *it, MAIN_NODE *node, int positional )
+ *      → Posting_Iter_Init_Term( POSTING_ITER *it, TERM_REF *ref )
+ *      → Posting_Iter_Next( POSTING_ITER *it )
+ *            • Walks the postings of a word in either form; SUCCESS per posting, FAILURE at end
+ *            • it -> positions points at the position deltas of a positional posting
+ *            • Through a TERM_REF, postings of deleted documents ( tombstones ) are skipped;
+ *              Posting_Iter_Init() sees every posting, as Thaw_Main_Node() needs
+ *
+ *      → Concat_Postings( TERM_REF *part, const DOC_ID *base, int count, unsigned char **buffer, size_t *capacity )
+ *            • Encodes the frozen lists of count parts as one frozen list, with the doc ids of
+ *              part i shifted by base[i]; the shifted parts must follow each other in doc order
+ *            • Returns the length written to *buffer ( grown as needed ), or -1
+ *
+ *      → Add_Frozen_Term( HASH_T *Hash_T, const char *word, const unsigned char *postings, unsigned int length, No_Of_Files file_count )
+ *            • Adds a new word with an already frozen list, copied into the posting arena
+ *
+ *      → Live_File_Count( TERM_REF *ref )
+ *            • Files of a word that are not deleted; file_count itself while there are no tombstones
+ *
+ *      → Append_Positions( HASH_T *Hash_T, SUB_NODE *sub, Word_Count count, const unsigned char *deltas )
+ *            • Appends count positions, given as deltas from 0, to a positional chain posting
+ *
+ *      → Posting_Iter_Seek( POSTING_ITER *it, DOC_ID target )
+ *            • Moves forward to the first posting with doc_id >= target; cost is logarithmic in
+ *              the skipped blocks plus at most one block of decoding
+ *            • Chains are walked linearly and must already be in doc order
+ *
+ *      → Frozen_Last_Doc( MAIN_NODE *node, int positional )
+ *            • Largest doc id in the frozen bytes of a word: a skip table jump plus one block of decoding
+ *
+ *      → Posting_Skip_Bytes( No_Of_Files file_count )
+ *            • Size of the skip table in front of a frozen list with file_count postings
+ *
+ *      → Varint_Encode( unsigned char *out, unsigned long value )
+ *      → Varint_Decode( const unsigned char **in )
+ *            • LEB128 style 7 bits per byte, high bit set on all but the last byte
+ *
+ * Notes :
+ *      • Postings are sorted by doc id while freezing, so lists can be merged / intersected
+ *      • Insert_To_Hash_Table() thaws a frozen word transparently before modifying it, unless the
+ *        new doc id is past its last one: those postings are chained after the frozen bytes
+ *        ( Postings_count of them stay frozen ), which iterators walk in that order
+ *
+ *******************************************************************************************************************************************************************/
+
+
+#include "Inverted_Search.h"
+#include "Types.h"
+
+
+/**/
+int Varint_Encode( unsigned char *out, unsigned long value )
+{
+	int length = 0;
+
+	while( value >= 0x80 )
+	{
+		out[length++] = ( unsigned char )( value | 0x80 );
+		value >>= 7;
+	}
+
+	out[length++] = ( unsigned char ) value;
+	return length;
+}
+
+
+/**/
+unsigned long Varint_Decode( const unsigned char **in )
+{
+	const unsigned char *p = *in;
+	unsigned long value = 0;
+	int shift = 0;
+
+	while( *p & 0x80 )
+	{
+		value |= ( unsigned long )( *p++ & 0x7F ) << shift;
+		shift += 7;
+	}
+
+	value |= ( unsigned long )( *p++ ) << shift;
+
+	*in = p;
+	return value;
+}
+
+
+/**/
+size_t Posting_Skip_Bytes( No_Of_Files file_count )
+{
+	if( file_count <= POSTING_SKIP_INTERVAL )
+		return 0;
+
+	return ( ( file_count - 1 ) / POSTING_SKIP_INTERVAL ) * sizeof( POSTING_SKIP );
+}
+
+
+/**/
+Status Append_Positions( HASH_T *Hash_T, SUB_NODE *sub, Word_Count count, const unsigned char *deltas )
+{
+	POS_SUB_NODE *pos_sub = ( POS_SUB_NODE* ) sub;
+	unsigned long position = 0;
+
+	for( Word_Count i = 0; i < count; i++ )
+	{
+		position += Varint_Decode( &deltas );
+
+		if( pos_sub -> positions_len + POSITION_MAX_BYTES > pos_sub -> positions_capacity )
+		{
+			// The old buffer stays in the arena until the chain is frozen
+			unsigned int capacity = pos_sub -> positions_capacity ? pos_sub -> positions_capacity * 2 : POSITION_INITIAL_BYTES;
+
+			unsigned char *bigger = Arena_Alloc( &Hash_T -> Sub_arena, capacity );
+			if( bigger == NULL )
+				return FAILURE;
+
+			if( pos_sub -> positions_len > 0 )
+				memcpy( bigger, pos_sub -> positions, pos_sub -> positions_len );
+
+			pos_sub -> positions = bigger;
+			pos_sub -> positions_capacity = capacity;
+		}
+
+		pos_sub -> positions_len += Varint_Encode( pos_sub -> positions + pos_sub -> positions_len,
+		                                           position - pos_sub -> last_position );
+		pos_sub -> last_position = position;
+	}
+
+	return SUCCESS;
+}
+
+
+/* Step over count varints without running past end */
+static const unsigned char* Skip_Varints( const unsigned char *p, const unsigned char *end, Word_Count count )
+{
+	while( count-- > 0 && p < end )
+	{
+		while( p < end && ( *p & 0x80 ) )
+			p++;
+
+		p++;
+	}
+
+	return p;
+}
+
+
+/* qsort comparator on doc id */
+static int Compare_Sub_Node( const void *a, const void *b )
+{
+	DOC_ID x = ( *( SUB_NODE* const* ) a ) -> doc_id;
+	DOC_ID y = ( *( SUB_NODE* const* ) b ) -> doc_id;
+
+	return ( x > y ) - ( x < y );
+}
+
+
+/* Encode one chain into buffer, growing it when needed; returns encoded length or -1 */
+static long Encode_Chain( MAIN_NODE *node, int positional, unsigned char **buffer, size_t *capacity,
+                          SUB_NODE ***order, size_t *order_capacity )
+{
+	size_t skip_bytes = Posting_Skip_Bytes( node -> file_count );
+	size_t needed = skip_bytes + ( size_t ) node -> file_count * POSTING_MAX_BYTES;
+
+	if( ( size_t ) node -> file_count > *order_capacity )
+	{
+		SUB_NODE **bigger = realloc( *order, node -> file_count * sizeof( SUB_NODE* ) );
+		if( bigger == NULL )
+			return -1;
+
+		*order = bigger;
+		*order_capacity = node -> file_count;
+	}
+
+	// Chains built file after file are already sorted; loaded ones may not be
+	size_t count = 0;
+	int sorted = 1;
+
+	for( SUB_NODE *sub = node -> Next_Sub_node; sub != NULL; sub = sub -> link )
+	{
+		if( count > 0 && ( *order )[count - 1] -> doc_id > sub -> doc_id )
+			sorted = 0;
+
+		( *order )[count++] = sub;
+
+		if( positional )
+			needed += ( ( POS_SUB_NODE* ) sub ) -> positions_len;
+	}
+
+	if( needed > *capacity )
+	{
+		unsigned char *bigger = realloc( *buffer, needed );
+		if( bigger == NULL )
+			return -1;
+
+		*buffer = bigger;
+		*capacity = needed;
+	}
+
+	if( !sorted )
+		qsort( *order, count, sizeof( SUB_NODE* ), Compare_Sub_Node );
+
+	long length = skip_bytes;
+	DOC_ID previous = 0;
+
+	for( size_t i = 0; i < count; i++ )
+	{
+		// Every interval boundary gets a skip entry pointing at the posting that starts it
+		if( i > 0 && i % POSTING_SKIP_INTERVAL == 0 )
+		{
+			POSTING_SKIP skip = { previous, ( uint32_t )( length - skip_bytes ) };
+			memcpy( *buffer + ( i / POSTING_SKIP_INTERVAL - 1 ) * sizeof( POSTING_SKIP ), &skip, sizeof( skip ) );
+		}
+
+		length += Varint_Encode( *buffer + length, ( *order )[i] -> doc_id - previous );
+		length += Varint_Encode( *buffer + length, ( *order )[i] -> word_count );
+		previous = ( *order )[i] -> doc_id;
+
+		if( positional )
+		{
+			POS_SUB_NODE *pos_sub = ( POS_SUB_NODE* )( *order )[i];
+
+			memcpy( *buffer + length, pos_sub -> positions, pos_sub -> positions_len );
+			length += pos_sub -> positions_len;
+		}
+	}
+
+	return length;
+}
+
+
+/**/
+Status Freeze_Hash_Table( HASH_T *Hash_T )
+{
+	unsigned char *buffer = NULL;
+	size_t capacity = 0;
+	SUB_NODE **order = NULL;
+	size_t order_capacity = 0;
+
+	for( int i = 0; i < LETTER_GROUPS; i++ )
+	{
+		for( MAIN_NODE *node = Hash_T -> Letter[i].link; node != NULL; node = node -> Next_Main_node )
+		{
+			if( node -> Next_Sub_node == NULL )
+				continue;           // already frozen
+
+			// A frozen list with postings chained after it is decoded whole and encoded again
+			if( node -> Postings != NULL && Thaw_Main_Node( Hash_T, node ) == FAILURE )
+			{
+				free( buffer );
+				free( order );
+				return FAILURE;
+			}
+
+			long length = Encode_Chain( node, Hash_T -> Positional, &buffer, &capacity, &order, &order_capacity );
+			if( length < 0 )
+			{
+				free( buffer );
+				free( order );
+				return FAILURE;
+			}
+
+			unsigned char *postings = Arena_Alloc( &Hash_T -> Post_arena, length );
+			if( postings == NULL )
+			{
+				free( buffer );
+				free( order );
+				return FAILURE;
+			}
+
+			memcpy( postings, buffer, length );
+			node -> Postings = postings;
+			node -> Postings_len = length;
+			node -> Postings_count = node -> file_count;
+		}
+	}
+
+	free( buffer );
+	free( order );
+
+	// Every chain is encoded; only now is it safe to drop the SUB_NODEs
+	for( int i = 0; i < LETTER_GROUPS; i++ )
+	{
+		for( MAIN_NODE *node = Hash_T -> Letter[i].link; node != NULL; node = node -> Next_Main_node )
+		{
+			node -> Next_Sub_node = NULL;
+			node -> Last_Sub_node = NULL;
+		}
+	}
+
+	Arena_Release( &Hash_T -> Sub_arena );
+
+	return SUCCESS;
+}
+
+
+/**/
+Status Thaw_Main_Node( HASH_T *Hash_T, MAIN_NODE *node )
+{
+	if( node -> Postings == NULL )
+		return SUCCESS;
+
+	POSTING_ITER it;
+	SUB_NODE *head = NULL;
+	SUB_NODE *tail = NULL;
+
+	Posting_Iter_Init( &it, node, Hash_T -> Positional );
+	it.sub = NULL;              // the chained tail is kept as it is
+
+	while( Posting_Iter_Next( &it ) == SUCCESS )
+	{
+		SUB_NODE *sub = Create_Sub_Node( Hash_T, it.doc_id );
+		if( sub == NULL )
+			return FAILURE;
+
+		sub -> word_count = it.word_count;
+
+		if( it.positions != NULL && Append_Positions( Hash_T, sub, it.word_count, it.positions ) == FAILURE )
+			return FAILURE;
+
+		if( tail == NULL )
+			head = sub;
+		else
+			tail -> link = sub;
+
+		tail = sub;
+	}
+
+	// Postings chained after the frozen bytes follow the decoded ones
+	if( node -> Next_Sub_node != NULL )
+	{
+		if( tail == NULL )
+			head = node -> Next_Sub_node;
+		else
+			tail -> link = node -> Next_Sub_node;
+
+		tail = node -> Last_Sub_node;
+	}
+
+	// The encoded bytes stay in the posting arena until the table is released
+	node -> Next_Sub_node = head;
+	node -> Last_Sub_node = tail;
+	node -> Postings = NULL;
+	node -> Postings_len = 0;
+	node -> Postings_count = 0;
+
+	return SUCCESS;
+}
+
+
+/* Frozen form: step over the skip table that long lists carry */
+static void Posting_Iter_Frozen( POSTING_ITER *it, const unsigned char *bytes, unsigned int length, No_Of_Files file_count, int positional )
+{
+	size_t skip_bytes = Posting_Skip_Bytes( file_count );
+
+	it -> sub = NULL;
+	it -> skip = bytes;
+	it -> skip_count = skip_bytes / sizeof( POSTING_SKIP );
+	it -> data = bytes + skip_bytes;
+	it -> pos = it -> data;
+	it -> end = bytes + length;
+	it -> index = 0;
+	it -> positional = positional;
+	it -> doc_id = 0;
+	it -> word_count = 0;
+	it -> positions = NULL;
+	it -> docs = NULL;
+	it -> doc_limit = 0;
+}
+
+
+/**/
+void Posting_Iter_Init( POSTING_ITER *it, MAIN_NODE *node, int positional )
+{
+	if( node -> Postings != NULL )
+	{
+		Posting_Iter_Frozen( it, node -> Postings, node -> Postings_len, node -> Postings_count, positional );
+		it -> sub = node -> Next_Sub_node;
+		return;
+	}
+
+	it -> sub = node -> Next_Sub_node;
+	it -> pos = NULL;
+	it -> end = NULL;
+	it -> skip_count = 0;
+	it -> index = 0;
+	it -> positional = positional;
+	it -> doc_id = 0;
+	it -> word_count = 0;
+	it -> positions = NULL;
+	it -> docs = NULL;
+	it -> doc_limit = 0;
+}
+
+
+/**/
+void Posting_Iter_Init_Term( POSTING_ITER *it, TERM_REF *ref )
+{
+	// Mapped term: same encoding, bytes live inside the mapped file
+	if( ref -> node != NULL )
+		Posting_Iter_Init( it, ref -> node, ref -> positional );
+	else
+		Posting_Iter_Frozen( it, ref -> postings, ref -> postings_len, ref -> file_count, ref -> positional );
+
+	it -> docs = ref -> docs;
+	it -> doc_limit = ref -> doc_limit;
+}
+
+
+/* One posting forward, deleted documents included */
+static Status Posting_Iter_Step( POSTING_ITER *it )
+{
+	// The frozen bytes come first, then the chain ( all of a thawed list, the tail of a frozen one )
+	if( it -> pos != NULL && it -> pos < it -> end )
+	{
+		it -> doc_id += ( DOC_ID ) Varint_Decode( &it -> pos );
+		it -> word_count = ( Word_Count ) Varint_Decode( &it -> pos );
+		it -> index++;
+
+		// Only the doc and term sections are checksummed on open: a damaged mapped list ends here
+		if( it -> doc_limit != 0 && it -> doc_id >= it -> doc_limit )
+		{
+			it -> pos = it -> end;
+			return FAILURE;
+		}
+
+		if( it -> positional )
+		{
+			it -> positions = it -> pos;
+			it -> pos = Skip_Varints( it -> pos, it -> end, it -> word_count );
+		}
+
+		return SUCCESS;
+	}
+
+	if( it -> sub != NULL )
+	{
+		it -> doc_id = it -> sub -> doc_id;
+		it -> word_count = it -> sub -> word_count;
+		it -> positions = it -> positional ? ( ( POS_SUB_NODE* ) it -> sub ) -> positions : NULL;
+		it -> sub = it -> sub -> link;
+		return SUCCESS;
+	}
+
+	return FAILURE;
+}
+
+
+/**/
+Status Posting_Iter_Next( POSTING_ITER *it )
+{
+	while( Posting_Iter_Step( it ) == SUCCESS )
+	{
+		if( it -> docs == NULL || it -> doc_id >= it -> docs -> count || !it -> docs -> doc[ it -> doc_id ].deleted )
+			return SUCCESS;
+	}
+
+	return FAILURE;
+}
+
+
+/**/
+long Concat_Postings( TERM_REF *part, const DOC_ID *base, int count, unsigned char **buffer, size_t *capacity )
+{
+	No_Of_Files file_count = 0;
+	size_t needed = 0;
+
+	// A list's first doc delta may grow once shifted; every other posting keeps its bytes
+	for( int i = 0; i < count; i++ )
+	{
+		// A heap term carries its frozen bytes in the node; a linked list cannot be sized here
+		if( part[i].node != NULL && ( part[i].node -> Postings == NULL || part[i].node -> Next_Sub_node != NULL ) )
+			return -1;
+
+		file_count += part[i].file_count;
+		needed += ( part[i].node != NULL ? part[i].node -> Postings_len : part[i].postings_len ) + POSTING_MAX_BYTES;
+	}
+
+	size_t skip_bytes = Posting_Skip_Bytes( file_count );
+	needed += skip_bytes;
+
+	if( needed > *capacity )
+	{
+		unsigned char *bigger = realloc( *buffer, needed );
+		if( bigger == NULL )
+			return -1;
+
+		*buffer = bigger;
+		*capacity = needed;
+	}
+
+	long length = skip_bytes;
+	DOC_ID previous = 0;
+	size_t index = 0;
+
+	for( int i = 0; i < count; i++ )
+	{
+		POSTING_ITER it;
+		Posting_Iter_Init_Term( &it, &part[i] );
+
+		while( Posting_Iter_Step( &it ) == SUCCESS )
+		{
+			DOC_ID doc_id = base[i] + it.doc_id;
+
+			if( index > 0 && index % POSTING_SKIP_INTERVAL == 0 )
+			{
+				POSTING_SKIP skip = { previous, ( uint32_t )( length - skip_bytes ) };
+				memcpy( *buffer + ( index / POSTING_SKIP_INTERVAL - 1 ) * sizeof( POSTING_SKIP ), &skip, sizeof( skip ) );
+			}
+
+			length += Varint_Encode( *buffer + length, doc_id - previous );
+			length += Varint_Encode( *buffer + length, it.word_count );
+			previous = doc_id;
+			index++;
+
+			if( it.positional )
+			{
+				memcpy( *buffer + length, it.positions, it.pos - it.positions );
+				length += it.pos - it.positions;
+			}
+		}
+	}
+
+	return length;
+}
+
+
+
+/**/
+Status Add_Frozen_Term( HASH_T *Hash_T, const char *word, const unsigned char *postings, unsigned int length, No_Of_Files file_count )
+{
+	size_t word_length = strlen( word );
+	MAIN_NODE *node = Arena_Alloc( &Hash_T -> Main_arena, sizeof( MAIN_NODE ) + word_length + 1 );
+	unsigned char *bytes = Arena_Alloc( &Hash_T -> Post_arena, length ? length : 1 );
+
+	if( node == NULL || bytes == NULL )
+		return FAILURE;
+
+	memcpy( node -> word, word, word_length + 1 );
+	memcpy( bytes, postings, length );
+
+	node -> file_count = file_count;
+	node -> Next_Sub_node = NULL;
+	node -> Last_Sub_node = NULL;
+	node -> Postings = bytes;
+	node -> Postings_len = length;
+	node -> Postings_count = file_count;
+
+	return Link_Main_Node( Hash_T, node );
+}
+
+
+/**/
+No_Of_Files Live_File_Count( TERM_REF *ref )
+{
+	if( ref -> docs == NULL )
+		return ref -> file_count;
+
+	POSTING_ITER it;
+	No_Of_Files live = 0;
+
+	Posting_Iter_Init_Term( &it, ref );
+
+	while( Posting_Iter_Next( &it ) == SUCCESS )
+		live++;
+
+	return live;
+}
+
+
+/* Skip entry k of a frozen list */
+static POSTING_SKIP Skip_Entry( const POSTING_ITER *it, unsigned long k )
+{
+	POSTING_SKIP skip;
+	memcpy( &skip, it -> skip + k * sizeof( POSTING_SKIP ), sizeof( skip ) );
+
+	return skip;
+}
+
+
+/**/
+Status Posting_Iter_Seek( POSTING_ITER *it, DOC_ID target )
+{
+	// Entry k jumps to posting ( k + 1 ) * POSTING_SKIP_INTERVAL; only forward jumps are useful
+	unsigned long k = it -> index / POSTING_SKIP_INTERVAL;
+
+	if( k < it -> skip_count && Skip_Entry( it, k ).last_doc < target )
+	{
+		// Gallop for an entry at or past target, then binary search the last one below it
+		unsigned long low = k;
+		unsigned long step = 1;
+		unsigned long high = k + step;
+
+		while( high < it -> skip_count && Skip_Entry( it, high ).last_doc < target )
+		{
+			low = high;
+			step *= 2;
+			high = k + step;
+		}
+
+		if( high > it -> skip_count )
+			high = it -> skip_count;
+
+		while( high - low > 1 )
+		{
+			unsigned long middle = low + ( high - low ) / 2;
+
+			if( Skip_Entry( it, middle ).last_doc < target )
+				low = middle;
+			else
+				high = middle;
+		}
+
+		POSTING_SKIP skip = Skip_Entry( it, low );
+
+		// A damaged table ( mapped file ) must not send the cursor outside the list
+		if( skip.offset < ( size_t )( it -> end - it -> data ) && ( low + 1 ) * POSTING_SKIP_INTERVAL > it -> index )
+		{
+			it -> pos = it -> data + skip.offset;
+			it -> doc_id = skip.last_doc;
+			it -> index = ( low + 1 ) * POSTING_SKIP_INTERVAL;
+		}
+	}
+
+	while( Posting_Iter_Next( it ) == SUCCESS )
+	{
+		if( it -> doc_id >= target )
+			return SUCCESS;
+	}
+
+	return FAILURE;
+}
+
+
+/**/
+DOC_ID Frozen_Last_Doc( MAIN_NODE *node, int positional )
+{
+	POSTING_ITER it;
+
+	Posting_Iter_Frozen( &it, node -> Postings, node -> Postings_len, node -> Postings_count, positional );
+	Posting_Iter_Seek( &it, ( DOC_ID ) -1 );
+
+	return it.doc_id;
+}
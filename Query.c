@@ -0,0 +1,1402 @@
+/*******************************************************************************************************************************************************************
+ * File        : Query.c
+ * Project     : Inverted Search Engine (Project-2)
+ *
+ * Description :
+ *      Boolean query engine on top of the index. A query such as
+ *
+ *          kichu AND ( report OR header ) NOT draft
+ *
+ *      is parsed into a QUERY_NODE tree and evaluated into the ascending list of matching
+ *      documents. On an index built with --positions, "inverted search" matches the words at
+ *      consecutive positions and kichu NEAR/3 report matches them at most 3 positions apart.
+ *      inv*, in?ex, apple..banana and kichu~1 stand for every term they match in the sorted
+ *      term dictionary (Term_Dict.c).
+ *
+ *      Conjunctions are driven by their rarest operand: every other operand is a cursor that
+ *      only moves forward, terms through Posting_Iter_Seek() ( skip tables ) and evaluated
+ *      sub-queries through galloping search, so a rare term ANDed with a common one
+ *      costs time proportional to the rare list.
+ *
+ * Grammar :
+ *      or_expr   := and_expr ( OR and_expr )*
+ *      and_expr  := unary ( [AND] unary )*         adjacent operands are ANDed
+ *      unary     := NOT unary | '(' or_expr ')' | '"' word* '"' | word [ NEAR/k word ] | pattern | range | fuzzy
+ *      pattern   := word with '*' ( any run of characters ) or '?' ( one character )
+ *      range     := [ word ] '..' [ word ]         inclusive, an empty side is open
+ *      fuzzy     := word '~' [ k ]                  edit distance <= k ( 0..FUZZY_MAX_DISTANCE ),
+ *                                                  Auto_Fuzzy_Distance() without k
+ *
+ *      AND / OR / NOT / NEAR/k are operators only in upper case. Words are normalized like
+ *      indexed text; a word that normalizes away ( stopword, punctuation ) is left out of its
+ *      expression. Positions count indexed terms only, so the phrase stays consecutive when
+ *      a stopword is dropped from both the text and the query.
+ *
+ * Function Overview :
+ *
+ *      → Parse_Query( const char *text, QUERY *query )
+ *            • Builds the tree in query -> arena; FAILURE with query -> error on a syntax error
+ *
+ *      → Expand_Query_Terms( HASH_T *H_Table, QUERY *query )
+ *            • Fills terms / term_count of every pattern, range and fuzzy node; FAILURE with
+ *              query -> error when one expands to more than TERM_EXPANSION_MAX terms
+ *
+ *      → Evaluate_Query( HASH_T *H_Table, QUERY *query, QUERY_RESULT *result )
+ *            • Matching doc ids, ascending; result -> doc is malloc'd
+ *            • FAILURE with query -> error when the query needs positions the index lacks
+ *
+ *      → Free_Query( QUERY *query )  /  Free_Query_Result( QUERY_RESULT *result )
+ *
+ *      → Search_Query( HASH_T *H_Table, char *text )
+ *            • Menu search: a single word keeps the Search_DataBase() output, anything else
+ *              prints the matching files
+ *
+ * Notes :
+ *      • NOT alone matches every indexed document without the operand; deleted documents never match
+ *      • OR operands and NOT sub-queries are materialised; frozen terms inside AND never are
+ *      • Unfrozen chains ( a loaded save file ) are sorted into a set before use
+ *      • Phrase / NEAR candidates come from the same rarest-first intersection; positions are
+ *        only decoded for documents that contain every word
+ *      • On a count-only index phrase / NEAR queries fail with query -> error set
+ *      • An expanded pattern / range / fuzzy word is one k-way merge of its terms' posting cursors on a
+ *        min-heap, not a chain of pairwise unions; it cannot appear inside a phrase or NEAR
+ *
+ *******************************************************************************************************************************************************************/
+
+
+#include "Inverted_Search.h"
+#include "Types.h"
+
+#define QUERY_ARENA_SIZE 4096
+
+
+/* Decoded positions of one posting */
+typedef struct Position_List
+{
+	unsigned long *pos;
+	size_t count;
+	size_t capacity;
+
+} POSITION_LIST;
+
+
+typedef struct Query_Lexer
+{
+	const char *pos;
+	char token[MAX_WORD_LENGTH];
+	int is_word;                    // token is a word ( or keyword ), not a parenthesis
+	int at_end;
+
+} QUERY_LEXER;
+
+
+/* One operand of a conjunction: a posting cursor or an evaluated set */
+typedef struct And_Operand
+{
+	int negated;
+	int is_term;
+
+	POSTING_ITER it;                // is_term
+	int valid;                      // it holds a current posting
+
+	QUERY_RESULT set;               // !is_term
+	size_t pos;
+
+	size_t estimate;                // upper bound on matches, picks the driver
+
+} AND_OPERAND;
+
+
+/* Read the next token: '(' , ')' , '"' or a run of other non-space characters */
+static void Next_Token( QUERY_LEXER *lexer )
+{
+	while( isspace( ( unsigned char ) *lexer -> pos ) )
+		lexer -> pos++;
+
+	lexer -> at_end = ( *lexer -> pos == '\0' );
+	lexer -> is_word = 0;
+
+	if( lexer -> at_end )
+	{
+		lexer -> token[0] = '\0';
+		return;
+	}
+
+	if( *lexer -> pos == '(' || *lexer -> pos == ')' || *lexer -> pos == '"' )
+	{
+		lexer -> token[0] = *lexer -> pos++;
+		lexer -> token[1] = '\0';
+		return;
+	}
+
+	size_t length = 0;
+
+	while( *lexer -> pos != '\0' && !isspace( ( unsigned char ) *lexer -> pos ) && *lexer -> pos != '(' && *lexer -> pos != ')' && *lexer -> pos != '"' )
+	{
+		if( length < MAX_WORD_LENGTH - 1 )
+			lexer -> token[length++] = *lexer -> pos;
+
+		lexer -> pos++;
+	}
+
+	lexer -> token[length] = '\0';
+	lexer -> is_word = 1;
+}
+
+
+static int Is_Keyword( QUERY_LEXER *lexer, const char *keyword )
+{
+	return lexer -> is_word && strcmp( lexer -> token, keyword ) == 0;
+}
+
+
+/* NEAR/k with k made of digits only */
+static int Is_Near( QUERY_LEXER *lexer, unsigned long *distance )
+{
+	if( !lexer -> is_word || strncmp( lexer -> token, "NEAR/", 5 ) != 0 || lexer -> token[5] == '\0' )
+		return 0;
+
+	for( const char *p = lexer -> token + 5; *p != '\0'; p++ )
+		if( !isdigit( ( unsigned char ) *p ) )
+			return 0;
+
+	*distance = strtoul( lexer -> token + 5, NULL, 10 );
+	return 1;
+}
+
+
+static QUERY_NODE* New_Query_Node( QUERY *query, QUERY_KIND kind )
+{
+	QUERY_NODE *node = Arena_Alloc( &query -> arena, sizeof( QUERY_NODE ) );
+	if( node == NULL )
+		return NULL;
+
+	node -> kind = kind;
+	node -> word = NULL;
+	node -> child = NULL;
+	node -> next = NULL;
+	node -> child_count = 0;
+	node -> distance = 0;
+	node -> upper = NULL;
+	node -> terms = NULL;
+	node -> term_count = 0;
+
+	return node;
+}
+
+
+/* Operand order does not matter for AND / OR, so operands are pushed in front */
+static void Add_Operand( QUERY_NODE *parent, QUERY_NODE *operand )
+{
+	operand -> next = parent -> child;
+	parent -> child = operand;
+	parent -> child_count++;
+}
+
+
+static Status Parse_Or( QUERY_LEXER *lexer, QUERY *query, QUERY_NODE **out );
+
+
+/* Current token as a normalized QUERY_TERM; *out stays NULL when the word normalizes away */
+static Status Parse_Word( QUERY_LEXER *lexer, QUERY *query, QUERY_NODE **out )
+{
+	WORD term;
+	Status normalized = Normalize_Word( lexer -> token, term );
+
+	*out = NULL;
+	Next_Token( lexer );
+
+	if( normalized != SUCCESS )
+		return SUCCESS;                 // stopword: no operand
+
+	if( ( *out = New_Query_Node( query, QUERY_TERM ) ) == NULL )
+		return FAILURE;
+
+	size_t length = strlen( term ) + 1;
+	if( ( ( *out ) -> word = Arena_Alloc( &query -> arena, length ) ) == NULL )
+		return FAILURE;
+
+	memcpy( ( *out ) -> word, term, length );
+	return SUCCESS;
+}
+
+
+/* QUERY_PATTERN for a word with '*' / '?', QUERY_RANGE for from..to, QUERY_FUZZY for word~ / word~k, QUERY_TERM otherwise */
+static QUERY_KIND Word_Kind( QUERY_LEXER *lexer )
+{
+	if( strpbrk( lexer -> token, "*?" ) != NULL )
+		return QUERY_PATTERN;
+
+	const char *tilde = strrchr( lexer -> token, '~' );
+
+	if( tilde != NULL && tilde != lexer -> token && strspn( tilde + 1, "0123456789" ) == strlen( tilde + 1 ) )
+		return QUERY_FUZZY;
+
+	// "..." and ".." stay ordinary words; either bound of a range may be left empty
+	const char *dots = strstr( lexer -> token, ".." );
+
+	if( dots != NULL && dots[2] != '.' && !( dots == lexer -> token && dots[2] == '\0' ) )
+		return QUERY_RANGE;
+
+	return QUERY_TERM;
+}
+
+
+/* Current token as a QUERY_PATTERN / QUERY_RANGE; only case folding applies, the rest is matched as stored */
+static Status Parse_Expansion( QUERY_LEXER *lexer, QUERY *query, QUERY_KIND kind, QUERY_NODE **out )
+{
+	size_t length = strlen( lexer -> token ) + 1;
+	char *text = Arena_Alloc( &query -> arena, length );
+
+	if( text == NULL || ( *out = New_Query_Node( query, kind ) ) == NULL )
+		return FAILURE;
+
+	for( size_t i = 0; i < length; i++ )
+		text[i] = ( Normalizer_Flags() & NORM_FOLD_CASE ) ? tolower( ( unsigned char ) lexer -> token[i] ) : lexer -> token[i];
+
+	( *out ) -> word = text;
+
+	if( kind == QUERY_RANGE )
+	{
+		char *dots = strstr( text, ".." );
+
+		*dots = '\0';
+		( *out ) -> upper = dots + 2;
+	}
+
+	Next_Token( lexer );
+	return SUCCESS;
+}
+
+
+/* word~ or word~k; the word is normalized like any other, k defaults to Auto_Fuzzy_Distance() */
+static Status Parse_Fuzzy( QUERY_LEXER *lexer, QUERY *query, QUERY_NODE **out )
+{
+	char *tilde = strrchr( lexer -> token, '~' );
+	int automatic = ( tilde[1] == '\0' );
+	unsigned long distance = automatic ? 0 : strtoul( tilde + 1, NULL, 10 );
+
+	if( distance > FUZZY_MAX_DISTANCE )
+	{
+		char *message = Arena_Alloc( &query -> arena, 64 );
+
+		if( message != NULL )
+			snprintf( message, 64, "fuzzy distance above %d", FUZZY_MAX_DISTANCE );
+
+		query -> error = message != NULL ? message : "fuzzy distance too large";
+		return FAILURE;
+	}
+
+	*tilde = '\0';
+
+	if( Parse_Word( lexer, query, out ) == FAILURE )
+		return FAILURE;
+
+	if( *out == NULL )
+		return SUCCESS;                 // stopword: no operand
+
+	( *out ) -> kind = QUERY_FUZZY;
+	( *out ) -> distance = automatic ? ( unsigned long ) Auto_Fuzzy_Distance( ( *out ) -> word ) : distance;
+	return SUCCESS;
+}
+
+
+/* Collapse a one-operand AND / OR / phrase into its operand */
+static QUERY_NODE* Simplify( QUERY_NODE *node )
+{
+	if( node -> child_count == 0 )
+		return NULL;
+
+	return node -> child_count == 1 ? node -> child : node;
+}
+
+
+/* '"' word* '"' ; words keep their order */
+static Status Parse_Phrase( QUERY_LEXER *lexer, QUERY *query, QUERY_NODE **out )
+{
+	QUERY_NODE *node = New_Query_Node( query, QUERY_PHRASE );
+	QUERY_NODE *tail = NULL;
+
+	if( node == NULL )
+		return FAILURE;
+
+	Next_Token( lexer );
+
+	while( lexer -> is_word )
+	{
+		QUERY_NODE *term;
+
+		if( Word_Kind( lexer ) != QUERY_TERM )
+		{
+			query -> error = "wildcard, range or fuzzy word inside a phrase";
+			return FAILURE;
+		}
+
+		if( Parse_Word( lexer, query, &term ) == FAILURE )
+			return FAILURE;
+
+		if( term == NULL )
+			continue;
+
+		if( tail == NULL )
+			node -> child = term;
+		else
+			tail -> next = term;
+
+		tail = term;
+		node -> child_count++;
+	}
+
+	if( lexer -> token[0] != '"' )
+	{
+		query -> error = lexer -> at_end ? "missing closing '\"'" : "parenthesis inside a phrase";
+		return FAILURE;
+	}
+
+	Next_Token( lexer );
+
+	*out = Simplify( node );
+	return SUCCESS;
+}
+
+
+/* unary := NOT unary | '(' or_expr ')' | '"' word* '"' | word [ NEAR/k word ] */
+static Status Parse_Unary( QUERY_LEXER *lexer, QUERY *query, QUERY_NODE **out )
+{
+	*out = NULL;
+
+	if( lexer -> at_end )
+	{
+		query -> error = "missing operand";
+		return FAILURE;
+	}
+
+	if( Is_Keyword( lexer, "NOT" ) )
+	{
+		QUERY_NODE *operand;
+
+		Next_Token( lexer );
+		if( Parse_Unary( lexer, query, &operand ) == FAILURE )
+			return FAILURE;
+
+		if( operand == NULL )
+			return SUCCESS;
+
+		if( ( *out = New_Query_Node( query, QUERY_NOT ) ) == NULL )
+			return FAILURE;
+
+		Add_Operand( *out, operand );
+		return SUCCESS;
+	}
+
+	if( !lexer -> is_word && lexer -> token[0] == '(' )
+	{
+		Next_Token( lexer );
+		if( Parse_Or( lexer, query, out ) == FAILURE )
+			return FAILURE;
+
+		if( lexer -> is_word || lexer -> token[0] != ')' )
+		{
+			query -> error = "missing ')'";
+			return FAILURE;
+		}
+
+		Next_Token( lexer );
+		return SUCCESS;
+	}
+
+	if( !lexer -> is_word && lexer -> token[0] == '"' )
+		return Parse_Phrase( lexer, query, out );
+
+	unsigned long distance;
+
+	if( !lexer -> is_word || Is_Keyword( lexer, "AND" ) || Is_Keyword( lexer, "OR" ) || Is_Near( lexer, &distance ) )
+	{
+		query -> error = "operator or ')' where a word was expected";
+		return FAILURE;
+	}
+
+	QUERY_KIND kind = Word_Kind( lexer );
+
+	if( kind == QUERY_FUZZY )
+		return Parse_Fuzzy( lexer, query, out );
+
+	if( kind != QUERY_TERM )
+		return Parse_Expansion( lexer, query, kind, out );
+
+	if( Parse_Word( lexer, query, out ) == FAILURE )
+		return FAILURE;
+
+	if( !Is_Near( lexer, &distance ) )
+		return SUCCESS;
+
+	unsigned long other;
+
+	Next_Token( lexer );
+
+	if( !lexer -> is_word || Is_Keyword( lexer, "AND" ) || Is_Keyword( lexer, "OR" ) || Is_Keyword( lexer, "NOT" ) || Is_Near( lexer, &other ) || Word_Kind( lexer ) != QUERY_TERM )
+	{
+		query -> error = "NEAR/k needs a word on both sides";
+		return FAILURE;
+	}
+
+	QUERY_NODE *right;
+
+	if( Parse_Word( lexer, query, &right ) == FAILURE )
+		return FAILURE;
+
+	// A side that normalized away leaves the other word on its own
+	if( *out == NULL || right == NULL )
+	{
+		if( *out == NULL )
+			*out = right;
+
+		return SUCCESS;
+	}
+
+	QUERY_NODE *near = New_Query_Node( query, QUERY_NEAR );
+	if( near == NULL )
+		return FAILURE;
+
+	near -> distance = distance;
+	near -> child = *out;
+	near -> child -> next = right;
+	near -> child_count = 2;
+
+	*out = near;
+	return SUCCESS;
+}
+
+
+/* and_expr := unary ( [AND] unary )* */
+static Status Parse_And( QUERY_LEXER *lexer, QUERY *query, QUERY_NODE **out )
+{
+	QUERY_NODE *node = New_Query_Node( query, QUERY_AND );
+	if( node == NULL )
+		return FAILURE;
+
+	while( 1 )
+	{
+		QUERY_NODE *operand;
+
+		if( Parse_Unary( lexer, query, &operand ) == FAILURE )
+			return FAILURE;
+
+		if( operand != NULL )
+			Add_Operand( node, operand );
+
+		if( Is_Keyword( lexer, "AND" ) )
+			Next_Token( lexer );
+		else if( lexer -> at_end || Is_Keyword( lexer, "OR" ) || ( !lexer -> is_word && lexer -> token[0] == ')' ) )
+			break;
+	}
+
+	*out = Simplify( node );
+	return SUCCESS;
+}
+
+
+/* or_expr := and_expr ( OR and_expr )* */
+static Status Parse_Or( QUERY_LEXER *lexer, QUERY *query, QUERY_NODE **out )
+{
+	QUERY_NODE *node = New_Query_Node( query, QUERY_OR );
+	if( node == NULL )
+		return FAILURE;
+
+	while( 1 )
+	{
+		QUERY_NODE *operand;
+
+		if( Parse_And( lexer, query, &operand ) == FAILURE )
+			return FAILURE;
+
+		if( operand != NULL )
+			Add_Operand( node, operand );
+
+		if( !Is_Keyword( lexer, "OR" ) )
+			break;
+
+		Next_Token( lexer );
+	}
+
+	*out = Simplify( node );
+	return SUCCESS;
+}
+
+
+/**/
+Status Parse_Query( const char *text, QUERY *query )
+{
+	QUERY_LEXER lexer;
+
+	Arena_Init( &query -> arena, QUERY_ARENA_SIZE, ARENA_ALIGN );
+	query -> root = NULL;
+	query -> error = NULL;
+
+	lexer.pos = text;
+	Next_Token( &lexer );
+
+	if( lexer.at_end )
+	{
+		query -> error = "empty query";
+		return FAILURE;
+	}
+
+	if( Parse_Or( &lexer, query, &query -> root ) == FAILURE )
+	{
+		if( query -> error == NULL )
+			query -> error = "out of memory";
+
+		return FAILURE;
+	}
+
+	if( !lexer.at_end )
+	{
+		query -> error = "unexpected ')'";
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+
+/**/
+void Free_Query( QUERY *query )
+{
+	Arena_Release( &query -> arena );
+	query -> root = NULL;
+}
+
+
+/**/
+void Free_Query_Result( QUERY_RESULT *result )
+{
+	free( result -> doc );
+	result -> doc = NULL;
+	result -> count = 0;
+}
+
+
+/* First index >= low whose doc is >= target; exponential then binary search */
+static size_t Gallop( const DOC_ID *doc, size_t low, size_t count, DOC_ID target )
+{
+	if( low >= count || doc[low] >= target )
+		return low;
+
+	size_t step = 1;
+
+	while( low + step < count && doc[ low + step ] < target )
+	{
+		low += step;
+		step *= 2;
+	}
+
+	size_t high = low + step < count ? low + step : count;
+
+	while( high - low > 1 )
+	{
+		size_t middle = low + ( high - low ) / 2;
+
+		if( doc[middle] < target )
+			low = middle;
+		else
+			high = middle;
+	}
+
+	return high;
+}
+
+
+static Status Result_Alloc( QUERY_RESULT *result, size_t capacity )
+{
+	result -> count = 0;
+	result -> capacity = capacity;
+	result -> doc = malloc( ( capacity ? capacity : 1 ) * sizeof( DOC_ID ) );
+
+	if( result -> doc == NULL )
+	{
+		perror("Malloc failed for query result");
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+
+/* Results are sized from file counts; a list holding more postings than its count is damaged and releases result */
+static Status Result_Push( QUERY_RESULT *result, DOC_ID doc )
+{
+	if( result -> count == result -> capacity )
+	{
+		printf("\n[INFO]: A posting list holds more documents than its file count. Index is corrupt.\n");
+		Free_Query_Result( result );
+		return FAILURE;
+	}
+
+	result -> doc[ result -> count++ ] = doc;
+	return SUCCESS;
+}
+
+
+/* qsort comparator on doc id */
+static int Compare_Doc( const void *a, const void *b )
+{
+	DOC_ID x = *( const DOC_ID* ) a;
+	DOC_ID y = *( const DOC_ID* ) b;
+
+	return ( x > y ) - ( x < y );
+}
+
+
+/* Frozen and mapped lists are in doc order; a chain loaded from a save file may not be */
+static int Is_Frozen_Term( TERM_REF *term )
+{
+	return term -> node == NULL || term -> node -> Postings != NULL;
+}
+
+
+/* All postings of one term, ascending */
+static Status Term_Postings( TERM_REF *term, QUERY_RESULT *result )
+{
+	if( Result_Alloc( result, term -> file_count ) == FAILURE )
+		return FAILURE;
+
+	POSTING_ITER it;
+	int sorted = 1;
+
+	Posting_Iter_Init_Term( &it, term );
+
+	while( Posting_Iter_Next( &it ) == SUCCESS )
+	{
+		if( result -> count > 0 && result -> doc[ result -> count - 1 ] > it.doc_id )
+			sorted = 0;
+
+		if( Result_Push( result, it.doc_id ) == FAILURE )
+			return FAILURE;
+	}
+
+	if( !sorted )
+		qsort( result -> doc, result -> count, sizeof( DOC_ID ), Compare_Doc );
+
+	return SUCCESS;
+}
+
+
+static Status Eval_Term( HASH_T *H_Table, QUERY_NODE *node, QUERY_RESULT *result )
+{
+	TERM_REF term;
+
+	if( Lookup_Term( H_Table, node -> word, &term ) == FAILURE )
+		return Result_Alloc( result, 0 );
+
+	return Term_Postings( &term, result );
+}
+
+
+/* Sorted union of two results; a and b are released */
+static Status Union( QUERY_RESULT *a, QUERY_RESULT *b, QUERY_RESULT *out )
+{
+	if( Result_Alloc( out, a -> count + b -> count ) == FAILURE )
+	{
+		Free_Query_Result( a );
+		Free_Query_Result( b );
+		return FAILURE;
+	}
+
+	size_t i = 0;
+	size_t j = 0;
+
+	while( i < a -> count || j < b -> count )
+	{
+		if( j == b -> count || ( i < a -> count && a -> doc[i] < b -> doc[j] ) )
+			out -> doc[ out -> count++ ] = a -> doc[i++];
+		else if( i == a -> count || b -> doc[j] < a -> doc[i] )
+			out -> doc[ out -> count++ ] = b -> doc[j++];
+		else
+		{
+			out -> doc[ out -> count++ ] = a -> doc[i++];
+			j++;
+		}
+	}
+
+	Free_Query_Result( a );
+	Free_Query_Result( b );
+	return SUCCESS;
+}
+
+
+/* Every live document of the index that is not in excluded; excluded is released */
+static Status Complement( HASH_T *H_Table, QUERY_RESULT *excluded, QUERY_RESULT *out )
+{
+	size_t total = H_Table -> Docs.count;
+
+	if( Result_Alloc( out, total ) == FAILURE )
+	{
+		Free_Query_Result( excluded );
+		return FAILURE;
+	}
+
+	size_t j = 0;
+
+	for( size_t d = 0; d < total; d++ )
+	{
+		if( j < excluded -> count && excluded -> doc[j] == d )
+			j++;
+		else if( !H_Table -> Docs.doc[d].deleted )
+			out -> doc[ out -> count++ ] = ( DOC_ID ) d;
+	}
+
+	Free_Query_Result( excluded );
+	return SUCCESS;
+}
+
+
+static Status Eval_Node( HASH_T *H_Table, QUERY_NODE *node, QUERY_RESULT *result );
+
+
+/* Move an operand to its first doc >= target; 0 when it has none left */
+static int Operand_Seek( AND_OPERAND *op, DOC_ID target, DOC_ID *current )
+{
+	if( op -> is_term )
+	{
+		if( !op -> valid || op -> it.doc_id < target )
+			op -> valid = ( Posting_Iter_Seek( &op -> it, target ) == SUCCESS );
+
+		*current = op -> it.doc_id;
+		return op -> valid;
+	}
+
+	op -> pos = Gallop( op -> set.doc, op -> pos, op -> set.count, target );
+
+	if( op -> pos >= op -> set.count )
+		return 0;
+
+	*current = op -> set.doc[ op -> pos ];
+	return 1;
+}
+
+
+/* Conjunction led by its rarest positive operand */
+static Status Eval_And( HASH_T *H_Table, QUERY_NODE *node, QUERY_RESULT *result )
+{
+	// One extra slot for the "all documents" operand of a purely negative conjunction
+	AND_OPERAND *op = calloc( node -> child_count + 1, sizeof( AND_OPERAND ) );
+	if( op == NULL )
+		return FAILURE;
+
+	int count = 0;
+	int empty = 0;
+	Status status = SUCCESS;
+
+	for( QUERY_NODE *child = node -> child; child != NULL && status == SUCCESS && !empty; child = child -> next )
+	{
+		AND_OPERAND *o = &op[count];
+		QUERY_NODE *target = child;
+
+		memset( o, 0, sizeof( *o ) );
+
+		if( child -> kind == QUERY_NOT )
+		{
+			o -> negated = 1;
+			target = child -> child;
+		}
+
+		TERM_REF term;
+
+		if( target -> kind == QUERY_TERM && Lookup_Term( H_Table, target -> word, &term ) == FAILURE )
+		{
+			empty = !o -> negated;      // a missing positive term empties the conjunction
+			continue;
+		}
+
+		if( target -> kind == QUERY_TERM && Is_Frozen_Term( &term ) )
+		{
+			o -> is_term = 1;
+			o -> estimate = term.file_count;
+			Posting_Iter_Init_Term( &o -> it, &term );
+		}
+		else
+		{
+			status = Eval_Node( H_Table, target, &o -> set );
+			if( status == FAILURE )
+				break;
+
+			o -> estimate = o -> set.count;
+			empty = !o -> negated && o -> set.count == 0;
+		}
+
+		count++;
+	}
+
+	// Pick the driver: the positive operand with the fewest documents
+	int driver = -1;
+
+	for( int i = 0; i < count; i++ )
+		if( !op[i].negated && ( driver < 0 || op[i].estimate < op[driver].estimate ) )
+			driver = i;
+
+	if( status == SUCCESS && !empty && driver < 0 )
+	{
+		QUERY_RESULT none = { NULL, 0 };
+
+		status = Complement( H_Table, &none, &op[count].set );
+		op[count].estimate = op[count].set.count;
+		driver = count++;
+	}
+
+	if( status == SUCCESS )
+		status = Result_Alloc( result, empty ? 0 : op[driver].estimate );
+
+	DOC_ID target = 0;
+	DOC_ID doc;
+
+	while( status == SUCCESS && !empty && Operand_Seek( &op[driver], target, &doc ) )
+	{
+		int match = 1;
+		int done = 0;
+
+		for( int i = 0; i < count && match; i++ )
+		{
+			DOC_ID other;
+
+			if( i == driver || op[i].negated )
+				continue;
+
+			if( !Operand_Seek( &op[i], doc, &other ) )
+			{
+				done = 1;               // an operand ran out: nothing further can match
+				match = 0;
+			}
+			else if( other != doc )
+			{
+				target = other;         // leap the driver to where this operand is
+				match = 0;
+			}
+		}
+
+		if( done )
+			break;
+
+		if( !match )
+			continue;
+
+		for( int i = 0; i < count && match; i++ )
+		{
+			DOC_ID other;
+
+			if( op[i].negated && Operand_Seek( &op[i], doc, &other ) && other == doc )
+				match = 0;
+		}
+
+		if( match && ( status = Result_Push( result, doc ) ) == FAILURE )
+			break;
+
+		target = doc + 1;
+	}
+
+	for( int i = 0; i < count; i++ )
+		if( !op[i].is_term )
+			Free_Query_Result( &op[i].set );
+
+	free( op );
+	return status;
+}
+
+
+/* Heap of operand indexes ordered by their current doc; sift the entry at i down */
+static void Merge_Sift_Down( int *heap, int count, int i, const DOC_ID *current )
+{
+	while( 1 )
+	{
+		int smallest = i;
+		int left = 2 * i + 1;
+		int right = left + 1;
+
+		if( left < count && current[ heap[left] ] < current[ heap[smallest] ] )
+			smallest = left;
+
+		if( right < count && current[ heap[right] ] < current[ heap[smallest] ] )
+			smallest = right;
+
+		if( smallest == i )
+			return;
+
+		int swap = heap[i];
+		heap[i] = heap[smallest];
+		heap[smallest] = swap;
+		i = smallest;
+	}
+}
+
+
+/* Wildcard / range / fuzzy word: union of the expanded terms' postings, one k-way merge on a min-heap */
+static Status Eval_Expansion( HASH_T *H_Table, QUERY_NODE *node, QUERY_RESULT *result )
+{
+	int count = ( int ) node -> term_count;
+	AND_OPERAND *op = calloc( count ? count : 1, sizeof( AND_OPERAND ) );
+	DOC_ID *current = malloc( ( count ? count : 1 ) * sizeof( DOC_ID ) );
+	int *heap = malloc( ( count ? count : 1 ) * sizeof( int ) );
+	Status status = SUCCESS;
+	size_t total = 0;
+	int size = 0;
+
+	if( op == NULL || current == NULL || heap == NULL )
+		status = FAILURE;
+
+	for( int i = 0; i < count && status == SUCCESS; i++ )
+	{
+		TERM_REF *term = &node -> terms[i];
+
+		if( Is_Frozen_Term( term ) )
+		{
+			op[i].is_term = 1;
+			Posting_Iter_Init_Term( &op[i].it, term );
+		}
+		else
+			status = Term_Postings( term, &op[i].set );
+
+		total += term -> file_count;
+
+		if( status == SUCCESS && Operand_Seek( &op[i], 0, &current[i] ) )
+			heap[ size++ ] = i;
+	}
+
+	// No result can hold more documents than the index has
+	if( status == SUCCESS )
+		status = Result_Alloc( result, total < H_Table -> Docs.count ? total : H_Table -> Docs.count );
+
+	for( int i = size / 2 - 1; i >= 0; i-- )
+		Merge_Sift_Down( heap, size, i, current );
+
+	while( status == SUCCESS && size > 0 )
+	{
+		int top = heap[0];
+		DOC_ID doc = current[top];
+
+		if( ( result -> count == 0 || result -> doc[ result -> count - 1 ] != doc ) && ( status = Result_Push( result, doc ) ) == FAILURE )
+			break;
+
+		if( !Operand_Seek( &op[top], doc + 1, &current[top] ) )
+			heap[0] = heap[ --size ];
+
+		Merge_Sift_Down( heap, size, 0, current );
+	}
+
+	for( int i = 0; op != NULL && i < count; i++ )
+		if( !op[i].is_term )
+			Free_Query_Result( &op[i].set );
+
+	free( op );
+	free( current );
+	free( heap );
+	return status;
+}
+
+
+/* Absolute positions of the posting it is on */
+static Status Decode_Positions( POSTING_ITER *it, POSITION_LIST *list )
+{
+	if( ( size_t ) it -> word_count > list -> capacity )
+	{
+		unsigned long *bigger = realloc( list -> pos, it -> word_count * sizeof( unsigned long ) );
+		if( bigger == NULL )
+			return FAILURE;
+
+		list -> pos = bigger;
+		list -> capacity = it -> word_count;
+	}
+
+	const unsigned char *p = it -> positions;
+	unsigned long position = 0;
+
+	for( Word_Count i = 0; i < it -> word_count; i++ )
+	{
+		position += Varint_Decode( &p );
+		list -> pos[i] = position;
+	}
+
+	list -> count = it -> word_count;
+	return SUCCESS;
+}
+
+
+/* Some occurrence of word 0 at p has word i at p + i, for every i */
+static int Phrase_Match( POSITION_LIST *list, int count )
+{
+	size_t *next = calloc( count, sizeof( size_t ) );
+	if( next == NULL )
+		return 0;
+
+	int match = 0;
+
+	for( size_t k = 0; k < list[0].count && !match; k++ )
+	{
+		unsigned long start = list[0].pos[k];
+		match = 1;
+
+		for( int i = 1; i < count && match; i++ )
+		{
+			// Starts only grow, so each list is scanned once overall
+			while( next[i] < list[i].count && list[i].pos[ next[i] ] < start + i )
+				next[i]++;
+
+			match = next[i] < list[i].count && list[i].pos[ next[i] ] == start + i;
+		}
+	}
+
+	free( next );
+	return match;
+}
+
+
+/* Some occurrences of the two words are at most distance positions apart */
+static int Near_Match( POSITION_LIST *a, POSITION_LIST *b, unsigned long distance )
+{
+	size_t i = 0;
+	size_t j = 0;
+
+	while( i < a -> count && j < b -> count )
+	{
+		unsigned long x = a -> pos[i];
+		unsigned long y = b -> pos[j];
+
+		if( ( x > y ? x - y : y - x ) <= distance )
+			return 1;
+
+		// Advancing the smaller position is the only way to get closer
+		if( x < y )
+			i++;
+		else
+			j++;
+	}
+
+	return 0;
+}
+
+
+/* Phrase / NEAR: documents holding every word, then a check of their positions */
+static Status Eval_Positional( HASH_T *H_Table, QUERY_NODE *node, QUERY_RESULT *result )
+{
+	int count = node -> child_count;
+	AND_OPERAND *op = calloc( count, sizeof( AND_OPERAND ) );
+	POSITION_LIST *list = calloc( count, sizeof( POSITION_LIST ) );
+	Status status = SUCCESS;
+	int empty = 0;
+	int driver = 0;
+
+	if( op == NULL || list == NULL )
+	{
+		free( op );
+		free( list );
+		return FAILURE;
+	}
+
+	int i = 0;
+
+	for( QUERY_NODE *child = node -> child; child != NULL; child = child -> next, i++ )
+	{
+		TERM_REF term;
+
+		if( Lookup_Term( H_Table, child -> word, &term ) == FAILURE )
+		{
+			empty = 1;
+			break;
+		}
+
+		op[i].is_term = 1;
+		op[i].estimate = term.file_count;
+		Posting_Iter_Init_Term( &op[i].it, &term );
+
+		if( op[i].estimate < op[driver].estimate )
+			driver = i;
+	}
+
+	status = Result_Alloc( result, empty ? 0 : op[driver].estimate );
+
+	DOC_ID target = 0;
+	DOC_ID doc;
+
+	while( status == SUCCESS && !empty && Operand_Seek( &op[driver], target, &doc ) )
+	{
+		int match = 1;
+		int done = 0;
+
+		for( i = 0; i < count && match; i++ )
+		{
+			DOC_ID other;
+
+			if( i == driver )
+				continue;
+
+			if( !Operand_Seek( &op[i], doc, &other ) )
+			{
+				done = 1;
+				match = 0;
+			}
+			else if( other != doc )
+			{
+				target = other;
+				match = 0;
+			}
+		}
+
+		if( done )
+			break;
+
+		if( !match )
+			continue;
+
+		target = doc + 1;
+
+		for( i = 0; i < count && status == SUCCESS; i++ )
+			status = Decode_Positions( &op[i].it, &list[i] );
+
+		if( status == FAILURE )
+			break;
+
+		if( node -> kind == QUERY_PHRASE ? Phrase_Match( list, count ) : Near_Match( &list[0], &list[1], node -> distance ) )
+			status = Result_Push( result, doc );
+	}
+
+	for( i = 0; i < count; i++ )
+		free( list[i].pos );
+
+	free( list );
+	free( op );
+	return status;
+}
+
+
+static Status Eval_Node( HASH_T *H_Table, QUERY_NODE *node, QUERY_RESULT *result )
+{
+	switch( node -> kind )
+	{
+		case QUERY_PHRASE:
+		case QUERY_NEAR:
+			return Eval_Positional( H_Table, node, result );
+
+		case QUERY_TERM:
+			return Eval_Term( H_Table, node, result );
+
+		case QUERY_PATTERN:
+		case QUERY_RANGE:
+		case QUERY_FUZZY:
+			return Eval_Expansion( H_Table, node, result );
+
+		case QUERY_AND:
+			return Eval_And( H_Table, node, result );
+
+		case QUERY_NOT:
+			{
+				QUERY_RESULT operand;
+
+				if( Eval_Node( H_Table, node -> child, &operand ) == FAILURE )
+					return FAILURE;
+
+				return Complement( H_Table, &operand, result );
+			}
+
+		case QUERY_OR:
+			{
+				if( Result_Alloc( result, 0 ) == FAILURE )
+					return FAILURE;
+
+				for( QUERY_NODE *child = node -> child; child != NULL; child = child -> next )
+				{
+					QUERY_RESULT operand;
+					QUERY_RESULT merged;
+
+					if( Eval_Node( H_Table, child, &operand ) == FAILURE )
+					{
+						Free_Query_Result( result );
+						return FAILURE;
+					}
+
+					if( Union( result, &operand, &merged ) == FAILURE )
+						return FAILURE;
+
+					*result = merged;
+				}
+
+				return SUCCESS;
+			}
+	}
+
+	return FAILURE;
+}
+
+
+/* Phrase or NEAR anywhere in the tree */
+static int Needs_Positions( QUERY_NODE *node )
+{
+	for( ; node != NULL; node = node -> next )
+		if( node -> kind == QUERY_PHRASE || node -> kind == QUERY_NEAR || Needs_Positions( node -> child ) )
+			return 1;
+
+	return 0;
+}
+
+
+/* Expand every wildcard / range / fuzzy node below node into terms; buffer holds TERM_EXPANSION_MAX refs */
+static Status Expand_Nodes( HASH_T *H_Table, QUERY *query, QUERY_NODE *node, TERM_REF *buffer )
+{
+	for( ; node != NULL; node = node -> next )
+	{
+		if( node -> kind != QUERY_PATTERN && node -> kind != QUERY_RANGE && node -> kind != QUERY_FUZZY )
+		{
+			if( Expand_Nodes( H_Table, query, node -> child, buffer ) == FAILURE )
+				return FAILURE;
+
+			continue;
+		}
+
+		if( node -> terms != NULL )
+			continue;
+
+		size_t matched;
+		char suffix[MAX_WORD_LENGTH + 8] = "";
+
+		if( node -> kind == QUERY_PATTERN )
+			matched = Expand_Pattern( H_Table, node -> word, buffer, TERM_EXPANSION_MAX );
+		else if( node -> kind == QUERY_RANGE )
+		{
+			matched = Expand_Range( H_Table, node -> word, node -> upper, buffer, TERM_EXPANSION_MAX );
+			snprintf( suffix, sizeof( suffix ), "..%s", node -> upper );
+		}
+		else
+		{
+			matched = Expand_Fuzzy( H_Table, node -> word, ( int ) node -> distance, buffer, NULL, TERM_EXPANSION_MAX );
+			snprintf( suffix, sizeof( suffix ), "~%lu", node -> distance );
+		}
+
+		if( matched > TERM_EXPANSION_MAX )
+		{
+			char *message = Arena_Alloc( &query -> arena, 2 * MAX_WORD_LENGTH + 64 );
+
+			if( message != NULL )
+			{
+				snprintf( message, 2 * MAX_WORD_LENGTH + 64, "'%s%s' matches more than %d terms",
+						node -> word,
+						suffix,
+						TERM_EXPANSION_MAX );
+			}
+
+			query -> error = message != NULL ? message : "wildcard, range or fuzzy word matches too many terms";
+			return FAILURE;
+		}
+
+		if( ( node -> terms = Arena_Alloc( &query -> arena, ( matched ? matched : 1 ) * sizeof( TERM_REF ) ) ) == NULL )
+			return FAILURE;
+
+		memcpy( node -> terms, buffer, matched * sizeof( TERM_REF ) );
+		node -> term_count = matched;
+	}
+
+	return SUCCESS;
+}
+
+
+/**/
+Status Expand_Query_Terms( HASH_T *H_Table, QUERY *query )
+{
+	TERM_REF *buffer = malloc( TERM_EXPANSION_MAX * sizeof( TERM_REF ) );
+	if( buffer == NULL )
+	{
+		perror("Malloc failed for query expansion");
+		return FAILURE;
+	}
+
+	Status status = Expand_Nodes( H_Table, query, query -> root, buffer );
+
+	free( buffer );
+	return status;
+}
+
+
+/**/
+Status Evaluate_Query( HASH_T *H_Table, QUERY *query, QUERY_RESULT *result )
+{
+	if( query -> root == NULL )
+		return Result_Alloc( result, 0 );
+
+	if( !H_Table -> Positional && Needs_Positions( query -> root ) )
+	{
+		query -> error = "phrase and NEAR queries need an index built with --positions";
+		result -> doc = NULL;
+		result -> count = 0;
+		return FAILURE;
+	}
+
+	if( Expand_Query_Terms( H_Table, query ) == FAILURE )
+	{
+		result -> doc = NULL;
+		result -> count = 0;
+		return FAILURE;
+	}
+
+	return Eval_Node( H_Table, query -> root, result );
+}
+
+
+/**/
+Status Search_Query( HASH_T *H_Table, char *text )
+{
+	QUERY query;
+
+	if( Parse_Query( text, &query ) == FAILURE )
+	{
+		printf("\n[INFO]: Invalid query '%s': %s\n", text, query.error );
+		Free_Query( &query );
+		return FAILURE;
+	}
+
+	// A single word keeps the detailed per-file counts
+	if( query.root != NULL && query.root -> kind == QUERY_TERM )
+	{
+		Status status = Search_DataBase( H_Table, query.root -> word );
+		Free_Query( &query );
+		return status;
+	}
+
+	if( query.root == NULL )
+	{
+		printf("\n[INFO]: '%s' has only stopwords or no searchable characters.\n", text );
+		Free_Query( &query );
+		return FAILURE;
+	}
+
+	QUERY_RESULT result;
+	Status status = Evaluate_Query( H_Table, &query, &result );
+
+	// The error message may live in the query arena
+	if( status == FAILURE && query.error != NULL )
+		printf("\n[INFO]: Cannot answer '%s': %s\n", text, query.error );
+
+	Free_Query( &query );
+
+	if( status == FAILURE )
+		return FAILURE;
+
+	if( result.count == 0 )
+	{
+		printf("\n[INFO]: No file matches '%s'.\n", text );
+		Free_Query_Result( &result );
+		return FAILURE;
+	}
+
+	printf("\n============================================================\n");
+	printf(" 🔍  Query: %-19s | Matches %zu file%s\n",
+				text,
+				result.count,
+				( result.count > 1 ? "s" : "" ));
+	printf("------------------------------------------------------------\n");
+
+	for( size_t i = 0; i < result.count; i++ )
+		printf(" [%02zu] %s\n", i + 1, Doc_Name( &H_Table -> Docs, result.doc[i] ) );
+
+	printf("============================================================\n\n");
+	printf("[INFO]: Search Successful\n");
+
+	Free_Query_Result( &result );
+	return SUCCESS;
+}
@@ -0,0 +1,587 @@
+/*******************************************************************************************************************************************************************
+ * File        : Rank.c
+ * Project     : Inverted Search Engine (Project-2)
+ *
+ * Description :
+ *      Ranked retrieval. The words of a query are scored with Okapi BM25 and only the best k
+ *      documents are kept, in a bounded min-heap, instead of listing every matching file.
+ *
+ *          score( d ) = Σ idf( t ) · tf · ( k1 + 1 ) / ( tf + k1 · ( 1 - b + b · |d| / avgdl ) )
+ *          idf( t )   = ln( 1 + ( N - df + 0.5 ) / ( df + 0.5 ) )
+ *
+ *      with k1 = BM25_K1, b = BM25_B, |d| the number of terms indexed from d and N the number of
+ *      indexed documents. Deleted documents count in neither N, df nor avgdl.
+ *
+ *      Documents are scored one at a time in doc id order ( document-at-a-time ) with MaxScore
+ *      pruning: every term has an upper bound idf · ( k1 + 1 ). Once the heap is full, terms
+ *      whose bounds add up to no more than the k-th best score cannot put a document in the
+ *      top k on their own; they stop generating candidates and are only probed, through
+ *      Posting_Iter_Seek(), for documents found by the other terms, and a candidate is dropped
+ *      as soon as its score plus the remaining bounds cannot beat the k-th score.
+ *
+ * Function Overview :
+ *
+ *      → Rank_Query( HASH_T *H_Table, const char *text, size_t k, int prune, RANK_RESULT *result )
+ *            • Best k documents, highest score first ( ties: lower doc id first )
+ *            • prune = 0 scores every matching document; the result is the same
+ *            • result -> scored counts the documents that were looked at
+ *
+ *      → Rank_Query_Scope( HASH_T *H_Table, const char *text, size_t k, int prune, const RANK_SCOPE *scope,
+ *                          RANK_RESULT *result )
+ *            • Rank_Query() on one shard of a sharded index (Shard.c): N, df and avgdl are those of
+ *              every shard in scope, so scores match those of one table holding all documents
+ *            • scope = NULL is Rank_Query()
+ *
+ *      → Update_Doc_Lengths( HASH_T *H_Table )
+ *            • Rebuilds stale document lengths now rather than on the first ranked query
+ *
+ *      → Free_Rank_Result( RANK_RESULT *result )
+ *
+ *      → Ranked_Search( HASH_T *H_Table, char *text, size_t k )
+ *            • Menu search: prints the ranked files with their scores
+ *
+ * Notes :
+ *      • Query words go through Parse_Query(); operators are ignored apart from NOT, whose
+ *        words are not scored. Repeated words count once
+ *      • A wildcard, range or fuzzy word scores every term it expands to, as if they were typed out
+ *      • Document lengths come from the build; after a load they are rebuilt from the postings
+ *        ( sum of the word counts of each document ) the first time a ranked query runs
+ *      • Unfrozen chains ( a loaded save file ) are copied and sorted before scoring
+ *
+ *******************************************************************************************************************************************************************/
+
+
+#include "Inverted_Search.h"
+#include "Types.h"
+#include <math.h>
+
+
+typedef struct Rank_Posting
+{
+	DOC_ID doc_id;
+	Word_Count word_count;
+
+} RANK_POSTING;
+
+
+/* Posting cursor of one query term */
+typedef struct Rank_Term
+{
+	const char *word;
+
+	POSTING_ITER it;                // frozen or mapped list
+	RANK_POSTING *list;             // unfrozen chain, sorted copy
+	size_t list_count;
+	size_t list_pos;
+
+	int valid;                      // doc_id / word_count hold a posting
+	DOC_ID doc_id;
+	Word_Count word_count;
+
+	double idf;
+	double bound;                   // highest score the term can add to a document
+
+} RANK_TERM;
+
+
+/* Rebuild document lengths after a load: |d| = Σ word counts of d */
+static void Refresh_Doc_Lengths( HASH_T *H_Table )
+{
+	DOC_TABLE *Docs = &H_Table -> Docs;
+	TERM_CURSOR cursor;
+	TERM_REF term;
+	INDEX group;
+
+	for( size_t i = 0; i < Docs -> count; i++ )
+		Docs -> doc[i].length = 0;
+
+	Docs -> total_length = 0;
+
+	Term_Cursor_Init( &cursor, H_Table );
+
+	while( Term_Cursor_Next( &cursor, &term, &group ) == SUCCESS )
+	{
+		POSTING_ITER it;
+		Posting_Iter_Init_Term( &it, &term );
+
+		while( Posting_Iter_Next( &it ) == SUCCESS )
+		{
+			Docs -> doc[ it.doc_id ].length += it.word_count;
+			Docs -> total_length += it.word_count;
+		}
+	}
+
+	Docs -> lengths_stale = 0;
+}
+
+
+static int Compare_Rank_Posting( const void *a, const void *b )
+{
+	DOC_ID x = ( ( const RANK_POSTING* ) a ) -> doc_id;
+	DOC_ID y = ( ( const RANK_POSTING* ) b ) -> doc_id;
+
+	return ( x > y ) - ( x < y );
+}
+
+
+/* Move to the next posting; valid drops to 0 at the end */
+static void Rank_Term_Next( RANK_TERM *t )
+{
+	if( t -> list == NULL )
+	{
+		t -> valid = Posting_Iter_Next( &t -> it ) == SUCCESS;
+		t -> doc_id = t -> it.doc_id;
+		t -> word_count = t -> it.word_count;
+		return;
+	}
+
+	t -> valid = t -> list_pos < t -> list_count;
+
+	if( t -> valid )
+	{
+		t -> doc_id = t -> list[ t -> list_pos ].doc_id;
+		t -> word_count = t -> list[ t -> list_pos ].word_count;
+		t -> list_pos++;
+	}
+}
+
+
+/* Move to the first posting with doc_id >= target */
+static void Rank_Term_Seek( RANK_TERM *t, DOC_ID target )
+{
+	if( !t -> valid || t -> doc_id >= target )
+		return;
+
+	if( t -> list == NULL )
+	{
+		t -> valid = Posting_Iter_Seek( &t -> it, target ) == SUCCESS;
+		t -> doc_id = t -> it.doc_id;
+		t -> word_count = t -> it.word_count;
+		return;
+	}
+
+	while( t -> valid && t -> doc_id < target )
+		Rank_Term_Next( t );
+}
+
+
+/* Open a cursor on one term; FAILURE only when out of memory */
+static Status Rank_Term_Open( HASH_T *H_Table, RANK_TERM *t, TERM_REF *term, const RANK_SCOPE *scope )
+{
+	t -> list = NULL;
+	t -> list_count = 0;
+	t -> list_pos = 0;
+
+	Posting_Iter_Init_Term( &t -> it, term );
+
+	// Frozen and mapped lists are already in doc order
+	if( term -> node != NULL && term -> node -> Postings == NULL )
+	{
+		t -> list = malloc( ( term -> file_count ? term -> file_count : 1 ) * sizeof( RANK_POSTING ) );
+		if( t -> list == NULL )
+		{
+			perror("Malloc failed for ranked postings");
+			return FAILURE;
+		}
+
+		while( Posting_Iter_Next( &t -> it ) == SUCCESS && t -> list_count < ( size_t ) term -> file_count )
+		{
+			t -> list[ t -> list_count ].doc_id = t -> it.doc_id;
+			t -> list[ t -> list_count ].word_count = t -> it.word_count;
+			t -> list_count++;
+		}
+
+		qsort( t -> list, t -> list_count, sizeof( RANK_POSTING ), Compare_Rank_Posting );
+	}
+
+	// Deleted documents ( tombstones ) are neither in N nor in df
+	double N = H_Table -> Docs.count - H_Table -> Docs.deleted;
+	double df = Live_File_Count( term );
+
+	// A shard scores with the statistics of the whole index
+	if( scope != NULL )
+	{
+		N = scope -> documents;
+		df = 0;
+
+		for( int i = 0; i < scope -> count; i++ )
+		{
+			TERM_REF other;
+
+			if( Lookup_Term( &scope -> table[i], term -> word, &other ) == SUCCESS )
+				df += Live_File_Count( &other );
+		}
+	}
+
+	t -> idf = log( 1.0 + ( N - df + 0.5 ) / ( df + 0.5 ) );
+	t -> bound = t -> idf * ( BM25_K1 + 1.0 );
+
+	Rank_Term_Next( t );
+	return SUCCESS;
+}
+
+
+/* Add one word to word[] unless it is already there */
+static size_t Add_Word( const char **word, size_t count, const char *text )
+{
+	size_t i = 0;
+	while( i < count && strcmp( word[i], text ) != 0 )
+		i++;
+
+	if( i == count )
+		word[ count++ ] = text;
+
+	return count;
+}
+
+
+/* Query words outside NOT, wildcard / range / fuzzy expansions included, deduplicated, into word[]; returns how many */
+static size_t Collect_Words( QUERY_NODE *node, const char **word, size_t count )
+{
+	for( ; node != NULL; node = node -> next )
+	{
+		if( node -> kind == QUERY_NOT )
+			continue;
+
+		if( node -> kind == QUERY_PATTERN || node -> kind == QUERY_RANGE || node -> kind == QUERY_FUZZY )
+		{
+			for( size_t i = 0; i < node -> term_count; i++ )
+				count = Add_Word( word, count, node -> terms[i].word );
+
+			continue;
+		}
+
+		if( node -> kind != QUERY_TERM )
+		{
+			count = Collect_Words( node -> child, word, count );
+			continue;
+		}
+
+		count = Add_Word( word, count, node -> word );
+	}
+
+	return count;
+}
+
+
+static size_t Count_Terms( QUERY_NODE *node )
+{
+	size_t count = 0;
+
+	for( ; node != NULL; node = node -> next )
+	{
+		if( node -> kind == QUERY_PATTERN || node -> kind == QUERY_RANGE || node -> kind == QUERY_FUZZY )
+			count += node -> term_count;
+		else
+			count += node -> kind == QUERY_TERM ? 1 : Count_Terms( node -> child );
+	}
+
+	return count;
+}
+
+
+/* a ranks below b: lower score, or the same score and a higher doc id */
+static int Rank_Below( const RANK_HIT *a, const RANK_HIT *b )
+{
+	return a -> score < b -> score || ( a -> score == b -> score && a -> doc_id > b -> doc_id );
+}
+
+
+/* Restore the min-heap below position i */
+static void Heap_Sift_Down( RANK_HIT *heap, size_t count, size_t i )
+{
+	while( 1 )
+	{
+		size_t low = i;
+		size_t left = 2 * i + 1;
+		size_t right = left + 1;
+
+		if( left < count && Rank_Below( &heap[left], &heap[low] ) )
+			low = left;
+
+		if( right < count && Rank_Below( &heap[right], &heap[low] ) )
+			low = right;
+
+		if( low == i )
+			return;
+
+		RANK_HIT swap = heap[i];
+		heap[i] = heap[low];
+		heap[low] = swap;
+		i = low;
+	}
+}
+
+
+/* Keep hit if it belongs in the top k; heap[0] is the weakest kept hit */
+static void Heap_Offer( RANK_HIT *heap, size_t *count, size_t k, RANK_HIT hit )
+{
+	if( *count < k )
+	{
+		size_t i = ( *count )++;
+		heap[i] = hit;
+
+		while( i > 0 && Rank_Below( &heap[i], &heap[ ( i - 1 ) / 2 ] ) )
+		{
+			RANK_HIT swap = heap[i];
+			heap[i] = heap[ ( i - 1 ) / 2 ];
+			heap[ ( i - 1 ) / 2 ] = swap;
+			i = ( i - 1 ) / 2;
+		}
+		return;
+	}
+
+	if( Rank_Below( &heap[0], &hit ) )
+	{
+		heap[0] = hit;
+		Heap_Sift_Down( heap, *count, 0 );
+	}
+}
+
+
+static int Compare_Bound( const void *a, const void *b )
+{
+	double x = ( ( const RANK_TERM* ) a ) -> bound;
+	double y = ( ( const RANK_TERM* ) b ) -> bound;
+
+	return ( x > y ) - ( x < y );
+}
+
+
+static int Compare_Hit( const void *a, const void *b )
+{
+	const RANK_HIT *x = a;
+	const RANK_HIT *y = b;
+
+	if( Rank_Below( x, y ) )
+		return 1;
+
+	return Rank_Below( y, x ) ? -1 : 0;
+}
+
+
+/* BM25 contribution of term t to the document it is positioned on */
+static double Term_Score( RANK_TERM *t, double length, double average )
+{
+	double tf = t -> word_count;
+
+	return t -> idf * tf * ( BM25_K1 + 1.0 ) / ( tf + BM25_K1 * ( 1.0 - BM25_B + BM25_B * length / average ) );
+}
+
+
+/* MaxScore document-at-a-time loop over terms sorted by ascending bound */
+static void Score_Documents( HASH_T *H_Table, RANK_TERM *term, size_t term_count, double *prefix,
+                             size_t k, int prune, double average, RANK_HIT *heap, RANK_RESULT *result )
+{
+	DOC_TABLE *Docs = &H_Table -> Docs;
+	size_t first_essential = 0;     // terms below it only refine candidates
+	double threshold = 0.0;
+
+	if( average <= 0.0 )
+		average = 1.0;
+
+	while( 1 )
+	{
+		// Next candidate: the lowest doc id among the essential terms
+		int found = 0;
+		DOC_ID doc_id = 0;
+
+		for( size_t i = first_essential; i < term_count; i++ )
+		{
+			if( term[i].valid && ( !found || term[i].doc_id < doc_id ) )
+			{
+				doc_id = term[i].doc_id;
+				found = 1;
+			}
+		}
+
+		if( !found )
+			break;
+
+		double length = Docs -> doc[ doc_id ].length;
+		double score = 0.0;
+
+		for( size_t i = first_essential; i < term_count; i++ )
+		{
+			if( term[i].valid && term[i].doc_id == doc_id )
+			{
+				score += Term_Score( &term[i], length, average );
+				Rank_Term_Next( &term[i] );
+			}
+		}
+
+		// Non-essential terms, highest bound first, while the document can still make the top k
+		size_t i = first_essential;
+
+		while( i-- > 0 )
+		{
+			if( prune && result -> count == k && score + prefix[i] <= threshold )
+				break;
+
+			Rank_Term_Seek( &term[i], doc_id );
+
+			if( term[i].valid && term[i].doc_id == doc_id )
+				score += Term_Score( &term[i], length, average );
+		}
+
+		result -> scored++;
+
+		RANK_HIT hit = { doc_id, score };
+		Heap_Offer( heap, &result -> count, k, hit );
+
+		if( result -> count == k )
+		{
+			threshold = heap[0].score;
+
+			// A document found only by these terms scores at most prefix[i] <= threshold
+			while( prune && first_essential < term_count && prefix[ first_essential ] <= threshold )
+				first_essential++;
+		}
+	}
+}
+
+
+/**/
+void Update_Doc_Lengths( HASH_T *H_Table )
+{
+	if( H_Table -> Docs.lengths_stale )
+		Refresh_Doc_Lengths( H_Table );
+}
+
+
+/**/
+Status Rank_Query( HASH_T *H_Table, const char *text, size_t k, int prune, RANK_RESULT *result )
+{
+	return Rank_Query_Scope( H_Table, text, k, prune, NULL, result );
+}
+
+
+/**/
+Status Rank_Query_Scope( HASH_T *H_Table, const char *text, size_t k, int prune, const RANK_SCOPE *scope, RANK_RESULT *result )
+{
+	QUERY query;
+
+	result -> hit = NULL;
+	result -> count = 0;
+	result -> scored = 0;
+
+	// Syntax errors are reported by the caller ( menu or batch line )
+	if( Parse_Query( text, &query ) == FAILURE || Expand_Query_Terms( H_Table, &query ) == FAILURE )
+	{
+		Free_Query( &query );
+		return FAILURE;
+	}
+
+	Update_Doc_Lengths( H_Table );
+
+	DOC_TABLE *Docs = &H_Table -> Docs;
+	size_t live = Docs -> count - Docs -> deleted;
+	double average = live > 0 ? ( double ) Docs -> total_length / live : 1.0;
+
+	if( scope != NULL )
+		average = scope -> average;
+
+	size_t word_count = Count_Terms( query.root );
+	const char **word = malloc( ( word_count ? word_count : 1 ) * sizeof( char* ) );
+	RANK_TERM *term = malloc( ( word_count ? word_count : 1 ) * sizeof( RANK_TERM ) );
+	double *prefix = malloc( ( word_count ? word_count : 1 ) * sizeof( double ) );
+	result -> hit = malloc( ( k ? k : 1 ) * sizeof( RANK_HIT ) );
+
+	Status status = SUCCESS;
+	size_t term_count = 0;
+
+	if( word == NULL || term == NULL || prefix == NULL || result -> hit == NULL )
+	{
+		perror("Malloc failed for ranked search");
+		status = FAILURE;
+	}
+	else
+	{
+		word_count = Collect_Words( query.root, word, 0 );
+
+		for( size_t i = 0; i < word_count && status == SUCCESS; i++ )
+		{
+			TERM_REF ref;
+
+			// Words missing from the index add nothing to any score
+			if( Lookup_Term( H_Table, word[i], &ref ) == FAILURE || ref.file_count == 0 )
+				continue;
+
+			term[ term_count ].word = word[i];
+			status = Rank_Term_Open( H_Table, &term[ term_count ], &ref, scope );
+
+			if( status == SUCCESS )
+				term_count++;
+		}
+	}
+
+	if( status == SUCCESS && k > 0 && term_count > 0 )
+	{
+		qsort( term, term_count, sizeof( RANK_TERM ), Compare_Bound );
+
+		for( size_t i = 0; i < term_count; i++ )
+			prefix[i] = term[i].bound + ( i > 0 ? prefix[ i - 1 ] : 0.0 );
+
+		Score_Documents( H_Table, term, term_count, prefix, k, prune, average, result -> hit, result );
+
+		qsort( result -> hit, result -> count, sizeof( RANK_HIT ), Compare_Hit );
+	}
+
+	for( size_t i = 0; i < term_count; i++ )
+		free( term[i].list );
+
+	free( term );
+	free( word );
+	free( prefix );
+	Free_Query( &query );
+
+	if( status == FAILURE )
+		Free_Rank_Result( result );
+
+	return status;
+}
+
+
+/**/
+void Free_Rank_Result( RANK_RESULT *result )
+{
+	free( result -> hit );
+	result -> hit = NULL;
+	result -> count = 0;
+}
+
+
+/**/
+Status Ranked_Search( HASH_T *H_Table, char *text, size_t k )
+{
+	RANK_RESULT result;
+
+	if( Rank_Query( H_Table, text, k, 1, &result ) == FAILURE )
+	{
+		printf("\n[INFO]: Could not rank '%s' ( invalid query, a wildcard matching too many terms, or out of memory )\n", text );
+		return FAILURE;
+	}
+
+	if( result.count == 0 )
+	{
+		printf("\n[INFO]: No file matches '%s'.\n", text );
+		Free_Rank_Result( &result );
+		return FAILURE;
+	}
+
+	printf("\n============================================================\n");
+	printf(" 🏆  Ranked: %-18s | Top %zu, %zu scored\n",
+				text,
+				result.count,
+				result.scored );
+	printf("------------------------------------------------------------\n");
+
+	for( size_t i = 0; i < result.count; i++ )
+		printf(" [%02zu] %-34s →  %.4f\n", i + 1, Doc_Name( &H_Table -> Docs, result.hit[i].doc_id ), result.hit[i].score );
+
+	printf("============================================================\n\n");
+	printf("[INFO]: Search Successful\n");
+
+	Free_Rank_Result( &result );
+	return SUCCESS;
+}
@@ -5,25 +5,52 @@
  *                    three user-selected save modes if the default save file exists:
  *
  *                        1. Overwrite the existing save file.
- *                        2. Append new entries to the existing save file.
+ *                        2. Append the changes since the last save as a new generation ( delta save ).
  *                        3. Save the database to a new, user-specified file.
  *
  *                    If the default save file does not exist, a new one is created automatically without prompting.
  *
  *                    The database is serialized in the format:
  *
+ *                        @documents; n; filename0; filename1; ... #
+ *                        @sections; 64; offset0; ... offset64; #
  *                        #index; word; file_count; filename1; count1; filename2; count2; ... #
  *
  *                    where:
- *                        • index      → Hash table index (0–26)
+ *                        • index      → Letter group index (0–26)
  *                        • word       → Unique word stored in MAIN_NODE
  *                        • file_count → Number of files containing the word
- *                        • filename   → File name from SUB_NODE
+ *                        • filename   → File name of the SUB_NODE doc id (document table)
  *                        • count      → Occurrence count of the word in that file
+ *                        • @documents → Live documents in doc id order
+ *                        • offset     → Byte offset of each of the SAVE_SECTIONS equal runs of words,
+ *                                       the last one the end of the records ( parallel load )
+ *
+ *                    A delta save appends one generation to a file this table was saved to or loaded from:
+ *
+ *                        @generation; n; length; #                 ( length: bytes of the lines below )
+ *                        @remove; filename; #                      ( documents removed or re-indexed since )
+ *                        @documents; k; filename1; ... #           ( documents added since )
+ *                        #index; word; k; filename1; count1; ... #  ( only documents added since )
+ *
+ *                    A re-indexed document is removed and listed again, so its new version replaces
+ *                    the saved one even when it has no terms left ( see Load_DataBase_File() ).
  *
  * Prototype        : Status Save_DataBase( HASH_T *H_Table );
+ *                    Status Save_DataBase_File( HASH_T *H_Table, const char *filename, int append );
+ *                        → non-interactive writer used by Save_DataBase() and batch mode
+ *                        → append writes a delta, or a full save when H_Table -> Saved is not this file
+ *                    void Set_Save_Mark( HASH_T *H_Table, const char *filename, unsigned int generation );
+ *                    void Clear_Save_Mark( HASH_T *H_Table );
+ *                        → the file the table is in step with ( also set by Load_DataBase_File() )
+ *                    void Record_Save_Word( HASH_T *H_Table, MAIN_NODE *node, SUB_NODE *first );
+ *                    void Record_Save_Removal( HASH_T *H_Table, DOC_ID doc_id );
+ *                        → what the next delta holds: words given their first posting since the save
+ *                          ( Create_DataBase.c ) and saved documents removed or re-indexed ( Live_Update.c )
+ *                    void Forget_Save_Changes( HASH_T *H_Table );
+ *                        → drops them, when the mark is cleared or the table is compacted
  *
- * Input Parameters : H_Table → Pointer to the 27-element hash table whose contents are to be saved.
+ * Input Parameters : H_Table → Pointer to the hash table whose contents are to be saved.
  *
  * Return Value     : SUCCESS → Database saved or appended successfully.
  *                    FAILURE → File cannot be created or opened.
@@ -38,32 +65,48 @@
  * Special Cases    :
  *                    • If default save file does not exist → New file created automatically.
  *                    • If the database is empty → No entries written; only info message displayed.
- *                    • If append mode is chosen → Duplicate entries may be introduced into file.
+ *                    • If append mode is chosen but the file was not saved from this table, was
+ *                      changed since, or the table was compacted since → a full save is written.
  *                    • If user enters filename without .txt → Extension is automatically corrected.
  *
  * Algorithm        :
  *                    1. Try opening the default save file in read mode.
  *                    2. If file exists, prompt user for overwrite / append / new filename.
- *                    3. Open file in the correct write mode based on user selection.
- *                    4. Traverse through all hash table buckets:
- *                         a. For each MAIN_NODE:
+ *                    3. Open the temporary file ( full save ) or buffer the generation ( delta save ).
+ *                    4. Traverse through all 27 letter groups ( TERM_CURSOR, heap or mapped index ):
+ *                         a. For each word:
  *                               - Write index, word, and file_count.
- *                               - For each linked SUB_NODE:
+ *                               - For each posting (chain or frozen form):
  *                                     * Write filename and word_count.
  *                               - Terminate each record with “ #\n”.
- *                    5. If no MAIN_NODE exists in all buckets → Notify user.
- *                    6. Close file and return SUCCESS if saved successfully.
+ *                    5. If no MAIN_NODE exists in any group → Notify user.
+ *                    6. Sync the file, rename it over the save file ( or append the buffered generation ),
+ *                       drop the write-ahead log and return SUCCESS if saved successfully.
  *
  * Notes            :
  *                    • Function performs only serialization, no insertion into hash table.
  *                    • Helpful prompts reduce risk of accidental data loss.
  *                    • Output format is critical to ensure reliable reloading when needed.
+ *                    • A full save is written to filename.tmp, synced and renamed over filename; a delta
+ *                      save is one synced append. Either way the write-ahead log of the file is dropped
+ *                      afterwards ( Write_Ahead_Log.c ).
+ *                    • Positions are not written; a database loaded from text is count-only.
+ *                    • Deleted documents are compacted away first ( Compact_Index(), Live_Update.c ) by a
+ *                      full save; a delta save never compacts, doc ids must stay in step with the file.
+ *                    • The section table is written with fixed-width offsets before the records and
+ *                      rewritten in place after them; a word count pass sizes the sections first.
+ *                    • A delta writes only the words and removals recorded since the save, a chain from
+ *                      the first new posting and a frozen list from a Posting_Iter_Seek() to the first
+ *                      unsaved doc id, so it costs in proportion to the change, not to the vocabulary.
+ *                      A change that could not be recorded ( out of memory ) makes the next save full.
  *
  *******************************************************************************************************************************************************************/
 
 
 #include "Types.h"
 #include "Inverted_Search.h"
+#include <sys/stat.h>
+#include <unistd.h>
 
 Status Save_DataBase( HASH_T* H_Table )
 {
@@ -83,7 +126,7 @@ Status Save_DataBase( HASH_T* H_Table )
         printf(" 💾  Save file '%s' already exists.\n", filename);
         printf("============================================================\n");
         printf("  1️⃣  Overwrite existing file\n");
-        printf("  2️⃣  Append new data( may contain duplicates)\n");
+        printf("  2️⃣  Append changes since the last save\n");
         printf("  3️⃣  Save as a new file\n");
         printf("------------------------------------------------------------\n");
         printf("  Enter your choice: ");
@@ -130,50 +173,378 @@ Status Save_DataBase( HASH_T* H_Table )
     }
 
 
-    // Open file based on append mode
-    FILE* fptr = fopen( filename, append_mode ? "a" : "w" );
+    return Save_DataBase_File( H_Table, filename, append_mode );
+}
+
+
+/* Room for one more entry in a list of the save mark; 0 when it cannot grow */
+static int Grow_Save_List( void **list, size_t *capacity, size_t count, size_t size )
+{
+    if( count < *capacity )
+        return 1;
+
+    size_t bigger = *capacity ? *capacity * 2 : 64;
+    void *grown = realloc( *list, bigger * size );
+
+    if( grown == NULL )
+        return 0;
+
+    *list = grown;
+    *capacity = bigger;
+
+    return 1;
+}
+
+
+/**/
+void Record_Save_Word( HASH_T* H_Table, MAIN_NODE *node, SUB_NODE *first )
+{
+    SAVE_MARK *mark = &H_Table -> Saved;
+
+    if( mark -> file == NULL || mark -> generation == 0 || mark -> lost )
+        return;
+
+    if( !Grow_Save_List( ( void** ) &mark -> words, &mark -> word_capacity, mark -> word_count, sizeof( SAVE_CHANGE ) ) )
+    {
+        mark -> lost = 1;
+        return;
+    }
+
+    mark -> words[ mark -> word_count ].node = node;
+    mark -> words[ mark -> word_count ].first = first;
+    mark -> word_count++;
+}
+
+
+/**/
+void Record_Save_Removal( HASH_T* H_Table, DOC_ID doc_id )
+{
+    SAVE_MARK *mark = &H_Table -> Saved;
+
+    // Documents added since are simply not listed by the delta
+    if( mark -> file == NULL || mark -> generation == 0 || mark -> lost || doc_id >= mark -> docs )
+        return;
+
+    if( !Grow_Save_List( ( void** ) &mark -> removed, &mark -> removed_capacity, mark -> removed_count, sizeof( DOC_ID ) ) )
+    {
+        mark -> lost = 1;
+        return;
+    }
+
+    mark -> removed[ mark -> removed_count++ ] = doc_id;
+}
+
+
+/**/
+void Forget_Save_Changes( HASH_T* H_Table )
+{
+    SAVE_MARK *mark = &H_Table -> Saved;
+
+    free( mark -> words );
+    free( mark -> removed );
+
+    mark -> words = NULL;
+    mark -> word_count = mark -> word_capacity = 0;
+    mark -> removed = NULL;
+    mark -> removed_count = mark -> removed_capacity = 0;
+    mark -> lost = 0;
+}
+
+
+/**/
+void Clear_Save_Mark( HASH_T* H_Table )
+{
+    Forget_Save_Changes( H_Table );
+    free( H_Table -> Saved.file );
+    memset( &H_Table -> Saved, 0, sizeof( SAVE_MARK ) );
+}
+
+
+/**/
+void Set_Save_Mark( HASH_T* H_Table, const char *filename, unsigned int generation )
+{
+    struct stat st;
+
+    Clear_Save_Mark( H_Table );
+
+    if( stat( filename, &st ) != 0 || ( H_Table -> Saved.file = strdup( filename ) ) == NULL )
+        return;
+
+    H_Table -> Saved.docs = H_Table -> Docs.count;
+    H_Table -> Saved.generation = generation;
+    H_Table -> Saved.bytes = st.st_size;
+    H_Table -> Saved.logging = 1;
+}
+
+
+/* A delta can only follow the generations this table wrote or read, untouched since */
+static int Delta_Possible( HASH_T* H_Table, const char *filename )
+{
+    struct stat st;
+    SAVE_MARK *mark = &H_Table -> Saved;
+
+    return mark -> file != NULL && mark -> generation > 0 && !mark -> lost && strcmp( mark -> file, filename ) == 0
+           && stat( filename, &st ) == 0 && st.st_size == mark -> bytes;
+}
+
+
+/* First posting of doc id first or later; from, when set, is a chain posting known to be the first of them */
+static Status Start_Postings( POSTING_ITER *it, TERM_REF *term, DOC_ID first, SUB_NODE *from )
+{
+    Posting_Iter_Init_Term( it, term );
+
+    if( from == NULL )
+        return Posting_Iter_Seek( it, first );
+
+    it -> sub = from;
+    return Posting_Iter_Next( it );
+}
+
+
+/* Write one record with the postings of doc ids from first on; 0 when the word has none */
+static int Write_Record( FILE* fptr, HASH_T* H_Table, TERM_REF *term, INDEX i, DOC_ID first, SUB_NODE *from )
+{
+    POSTING_ITER it;
+    No_Of_Files file_count = first == 0 ? Live_File_Count( term ) : 0;
+
+    // A delta counts first: file_count comes before the postings
+    for( Status found = first > 0 ? Start_Postings( &it, term, first, from ) : FAILURE; found == SUCCESS; found = Posting_Iter_Next( &it ) )
+    {
+        if( it.doc_id >= first )
+            file_count++;
+    }
+
+    if( file_count == 0 )
+        return 0;
+
+    fprintf( fptr, "#%d; %s; %ld;", i, term -> word, file_count );
+
+    for( Status found = Start_Postings( &it, term, first, from ); found == SUCCESS; found = Posting_Iter_Next( &it ) )
+    {
+        if( it.doc_id >= first )
+            fprintf( fptr, " %s; %ld;", Doc_Name( &H_Table -> Docs, it.doc_id ), it.word_count );
+    }
+
+    fprintf( fptr, " #\n" );
+    return 1;
+}
+
+
+/* qsort() order of the recorded words */
+static int Compare_Changes( const void *a, const void *b )
+{
+    return Compare_Terms( ( ( const SAVE_CHANGE* ) a ) -> node -> word, ( ( const SAVE_CHANGE* ) b ) -> node -> word );
+}
+
+
+/* Append the documents added and removed since the last save as the next generation */
+static Status Save_DataBase_Delta( HASH_T* H_Table, const char *filename )
+{
+    SAVE_MARK *mark = &H_Table -> Saved;
+    DOC_TABLE *Docs = &H_Table -> Docs;
+
+    // The generation is assembled first: its header carries its length, so a torn one is detected
+    char *body = NULL;
+    size_t length = 0;
+
+    FILE* mem = open_memstream( &body, &length );
+    if( mem == NULL )
+    {
+        perror("[INFO]: Could not buffer the database changes");
+        return FAILURE;
+    }
+
+    unsigned int generation = mark -> generation + 1;
+    size_t added = 0;
+    size_t removed = 0;
+    long records = 0;
+
+    // Saved versions removed or re-indexed since, as Remove_Document() / Reindex_Document() recorded them
+    for( size_t r = 0; r < mark -> removed_count; r++ )
+    {
+        fprintf( mem, "@remove; %s; #\n", Docs -> doc[ mark -> removed[r] ].name );
+        removed++;
+    }
+
+    // New versions are listed, so one without any term still replaces the saved one
+    for( DOC_ID id = mark -> docs; id < Docs -> count; id++ )
+        added += !Docs -> doc[id].deleted;
+
+    if( added > 0 )
+    {
+        fprintf( mem, "@documents; %zu;", added );
+
+        for( DOC_ID id = mark -> docs; id < Docs -> count; id++ )
+        {
+            if( !Docs -> doc[id].deleted )
+                fprintf( mem, " %s;", Docs -> doc[id].name );
+        }
+
+        fprintf( mem, " #\n" );
+    }
+
+    // Only the words that were given postings since; in dictionary order like a full save's groups
+    qsort( mark -> words, mark -> word_count, sizeof( SAVE_CHANGE ), Compare_Changes );
+
+    for( size_t w = 0; added > 0 && w < mark -> word_count; w++ )
+    {
+        MAIN_NODE *node = mark -> words[w].node;
+        TERM_REF term;
+
+        if( Lookup_Term( H_Table, node -> word, &term ) == FAILURE )
+            continue;
+
+        // A list frozen since lost its chain postings; its new ones are found with a seek
+        records += Write_Record( mem, H_Table, &term, Find_Index( node -> word[0] ), mark -> docs,
+                                 node -> Postings == NULL ? mark -> words[w].first : NULL );
+    }
+
+    Status status = fclose( mem ) == 0 ? SUCCESS : FAILURE;
+
+    // A generation torn by a crash ( reported by Load_DataBase_File() ) is cut off first
+    if( status == SUCCESS && mark -> torn > 0 && truncate( filename, mark -> bytes - mark -> torn ) != 0 )
+        status = FAILURE;
+
+    // One append, synced before the log it replaces is dropped
+    FILE* fptr = status == SUCCESS ? fopen( filename, "a" ) : NULL;
+
+    if( fptr != NULL )
+    {
+        fprintf( fptr, "@generation; %u; %zu; #\n", generation, length );
+        fwrite( body, 1, length, fptr );
+
+        status = Sync_Close( fptr );
+    }
+
+    free( body );
+
+    if( fptr == NULL || status == FAILURE )
+    {
+        printf("[INFO]: Could not write '%s'\n", filename );
+        Clear_Save_Mark( H_Table );
+        return FAILURE;
+    }
+
+    Set_Save_Mark( H_Table, filename, generation );
+    Discard_Document_Log( filename );
+
+    printf("\n[INFO]: Generation %u appended to '%s' ( %zu new document%s, %zu removed, %ld records )\n",
+           generation, filename, added, added == 1 ? "" : "s", removed, records );
+
+    return SUCCESS;
+}
+
+
+/* "@sections; n; offset0; ... offsetn; #": fixed width, written first and filled in last */
+static void Write_Section_Table( FILE* fptr, const long *offset )
+{
+    fprintf( fptr, "@sections; %d;", SAVE_SECTIONS );
+
+    for( int s = 0; s <= SAVE_SECTIONS; s++ )
+        fprintf( fptr, " %020ld;", offset[s] );
+
+    fprintf( fptr, " #\n" );
+}
+
+
+/**/
+Status Save_DataBase_File( HASH_T* H_Table, const char *filename, int append_mode )
+{
+    if( append_mode && Delta_Possible( H_Table, filename ) )
+        return Save_DataBase_Delta( H_Table, filename );
+
+    if( append_mode )
+        printf("\n[INFO]: '%s' is not in step with this database, writing a full save instead\n", filename );
+
+    // Drop the postings of deleted documents first so every file_count written is exact
+    if( Compact_Index( H_Table ) == FAILURE )
+        return FAILURE;
+
+    // The old file stays intact until the new one is complete on disk
+    char temp_name[FILENAME_MAX];
+    snprintf( temp_name, sizeof( temp_name ), "%s.tmp", filename );
+
+    FILE* fptr = fopen( temp_name, "w" );
     if( fptr == NULL )
     {
         perror("[INFO]: Could not open file to save database");
         return FAILURE;
     }
 
+    // Documents in doc id order, so a loader can resolve names before it reads any record
+    DOC_TABLE *Docs = &H_Table -> Docs;
+
+    fprintf( fptr, "@documents; %zu;", Docs -> count - Docs -> deleted );
+
+    for( DOC_ID id = 0; id < Docs -> count; id++ )
+    {
+        if( !Docs -> doc[id].deleted )
+            fprintf( fptr, " %s;", Docs -> doc[id].name );
+    }
+
+    fprintf( fptr, " #\n" );
+
     //  Write data from database to save file
     int is_empty = 1;
 
-    for( int i = 0; i < 27; i++ )
+    TERM_CURSOR cursor;
+    TERM_REF term;
+    INDEX i;
+
+    // Sections are equal runs of words; their offsets are known only once they are written
+    long table_at = ftell( fptr );
+    long offset[ SAVE_SECTIONS + 1 ];
+    size_t words = 0;
+
+    for( int s = 0; s <= SAVE_SECTIONS; s++ )
+        offset[s] = -1;
+
+    Write_Section_Table( fptr, offset );
+
+    Term_Cursor_Init( &cursor, H_Table );
+    while( Term_Cursor_Next( &cursor, &term, &i ) == SUCCESS )
+        words++;
+
+    size_t per_section = words > SAVE_SECTIONS ? ( words + SAVE_SECTIONS - 1 ) / SAVE_SECTIONS : 1;
+    size_t n = 0;
+
+    Term_Cursor_Init( &cursor, H_Table );
+
+    while( Term_Cursor_Next( &cursor, &term, &i ) == SUCCESS )
     {
-        MAIN_NODE* main_node = H_Table[i].link;
+        if( n++ % per_section == 0 )
+            offset[ ( n - 1 ) / per_section ] = ftell( fptr );
 
-        while( main_node )
-        {
-            is_empty = 0;
-            fprintf(    fptr, "#%d; %s; %ld;",
-                        i,
-                        main_node -> word,
-                        main_node -> file_count );
-
-            SUB_NODE* sub_node = main_node -> Next_Sub_node;
-            while( sub_node )
-            {
-                fprintf( fptr, " %s; %ld;", sub_node -> File_name, sub_node -> word_count );
-                
-                sub_node = sub_node -> link;
-            }
-
-            fprintf( fptr, " #\n" );
-            main_node = main_node -> Next_Main_node;
-        }
+        is_empty &= !Write_Record( fptr, H_Table, &term, i, 0, NULL );
     }
 
     if( is_empty )
         printf("[INFO]: No DataBase data to save\n");
 
-    fclose( fptr );
+    // Unused sections are empty and end where the save ends
+    offset[ SAVE_SECTIONS ] = ftell( fptr );
+
+    for( int s = 0; s < SAVE_SECTIONS; s++ )
+    {
+        if( offset[s] < 0 )
+            offset[s] = offset[ SAVE_SECTIONS ];
+    }
+
+    fseek( fptr, table_at, SEEK_SET );
+    Write_Section_Table( fptr, offset );
+
+    if( Sync_Close( fptr ) == FAILURE || Commit_File( temp_name, filename ) == FAILURE )
+    {
+        printf("[INFO]: Could not write '%s', the previous save is kept\n", filename );
+        remove( temp_name );
+        return FAILURE;
+    }
+
+    // Later delta saves append to this file, and its log is now part of it
+    Set_Save_Mark( H_Table, filename, 1 );
+    Discard_Document_Log( filename );
 
-    printf("\n[INFO]: Database successfully %ssaved to '%s'\n",
-           append_mode ? "appended and " : "",
-           filename);
+    printf("\n[INFO]: Database successfully saved to '%s'\n", filename );
 
     return SUCCESS;
-}
\ No newline at end of file
+}
@@ -0,0 +1,850 @@
+/*******************************************************************************************************************************************************************
+ * File        : Segment_Index.c
+ * Project     : Inverted Search Engine (Project-2)
+ *
+ * Description :
+ *      Log-structured index: a list of immutable segments, each a complete HASH_T that is never
+ *      written again once published, read by many threads while documents keep being added.
+ *      Readers take the current snapshot ( the list of published segments ) with one atomic load
+ *      and never lock, wait or see a MAIN_NODE / SUB_NODE chain being built:
+ *
+ *          writer : index documents into a private table ( the write buffer ) → Publish_Segment()
+ *                       → new snapshot = old segments + this one → swapped in atomically
+ *          merger : tiered policy picks SEGMENT_MERGE_FANIN adjacent segments of one tier
+ *                       → merged off-line into one segment → swapped in for them
+ *          reader : Enter_Snapshot() → query every segment of the snapshot → Leave_Snapshot()
+ *
+ *      A replaced snapshot, and the segments a merge replaced, may still be in use by readers
+ *      that entered before the swap, so they are freed by epoch-based reclamation: every reader
+ *      announces the epoch it entered in, every swap advances the epoch, and what was retired in
+ *      epoch e is freed once no reader is still inside an epoch <= e.
+ *
+ *      With a segment store every segment is also a binary index file BASE.<generation>, listed
+ *      in order by the manifest BASE. Adding documents writes one new small file and rewrites
+ *      the manifest; a merge writes the merged file, rewrites the manifest and removes the files
+ *      it replaced. Nothing else on disk is rewritten.
+ *
+ * Function Overview :
+ *
+ *      → Open_Segment_Index( int readers )
+ *            • Empty index for reader slots 0 .. readers-1; NULL on failure
+ *
+ *      → Attach_Segment_Store( SEGMENT_INDEX *index, const char *base )
+ *            • Maps the segments listed by the manifest base, or starts a new store when it does
+ *              not exist; every later segment is written to the store
+ *
+ *      → Start_Segment_Merger( SEGMENT_INDEX *index )
+ *            • Starts the background merge thread
+ *
+ *      → Publish_Segment( SEGMENT_INDEX *index, HASH_T *segment )
+ *            • Settles segment ( frozen, resize finished, dictionary sorted, lengths known ),
+ *              writes it to the store, and makes it visible to readers entering from now on
+ *            • The index owns the table afterwards; *segment may be initialised again
+ *
+ *      → Segment_Index_Documents( SEGMENT_INDEX *index, DOC_TABLE *seen )
+ *            • Registers the documents of every published segment in seen ( duplicate checks )
+ *
+ *      → Enter_Snapshot( SEGMENT_INDEX *index, int reader )  /  Leave_Snapshot( SEGMENT_INDEX *index, int reader )
+ *            • The snapshot stays valid, and unchanged, between the two calls
+ *
+ *      → Snapshot_Segments( const SNAPSHOT *snapshot )  /  Snapshot_Documents( const SNAPSHOT *snapshot )
+ *
+ *      → Snapshot_Term_Postings( const SNAPSHOT *snapshot, const char *word, SHARD_RESULT *result )
+ *      → Snapshot_Evaluate_Query( const SNAPSHOT *snapshot, const char *text, SHARD_RESULT *result, char *error, size_t size )
+ *            • One word's postings / a boolean query over every segment; hit -> shard is the segment
+ *
+ *      → Snapshot_Doc_Name( const SNAPSHOT *snapshot, const SHARD_HIT *hit )
+ *
+ *      → Close_Segment_Index( SEGMENT_INDEX *index )
+ *            • Lets the merger finish the merges the policy still asks for, then frees every
+ *              snapshot and segment; no reader may be inside
+ *
+ * Merge Policy :
+ *      • A segment of d documents is in tier t when SEGMENT_DEFAULT_DOCS * FANIN^t <= d, with
+ *        FANIN = SEGMENT_MERGE_FANIN, the highest such t ( tier 0 below FANIN segments' worth )
+ *      • FANIN adjacent segments of the same tier are merged, newest first, so every document
+ *        is rewritten about log_FANIN( documents ) times in all
+ *      • Only adjacent segments merge, so documents stay in publication order; the merger is
+ *        the only thread that removes segments, so the ones it picked are still adjacent when
+ *        it swaps the result in
+ *
+ * Notes :
+ *      • Segments are numbered in snapshot order and documents in a segment by doc id, so
+ *        results are in the order a one-table build of the same files would give
+ *      • A settled table is only read by queries ( see Shard.c ) and by merges, so segments
+ *        need no lock; publications and merges take the writer lock only to swap snapshots
+ *      • The manifest is written to BASE.tmp, synced and renamed over BASE ( Commit_File() )
+ *
+ *******************************************************************************************************************************************************************/
+
+
+#include "Inverted_Search.h"
+#include "Types.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define SEGMENT_MANIFEST_MAGIC "INVSRCH-SEGMENTS"
+
+
+typedef struct Segment
+{
+	HASH_T table;
+	unsigned long generation;       // file BASE.<generation> of a segment store, 0 in memory only
+	int tier;
+
+} SEGMENT;
+
+
+struct Snapshot
+{
+	SEGMENT **segment;              // published segments, oldest first
+	int count;
+	size_t documents;
+
+	unsigned long retired;          // epoch it was replaced in
+	SEGMENT **dropped;              // segments merged away by that replacement, freed with it
+	int dropped_count;
+	struct Snapshot *next;          // retired list
+
+};
+
+
+struct Segment_Index
+{
+	_Atomic( SNAPSHOT* ) current;
+	atomic_ulong epoch;             // starts at 1; 0 marks a reader outside any snapshot
+	atomic_ulong *active;           // per reader: epoch it entered in, or 0
+	int readers;
+
+	pthread_mutex_t lock;           // writers: swaps, the retired list, the store
+	pthread_cond_t changed;         // a segment was published, or closing
+	SNAPSHOT *retired;              // replaced snapshots not yet freed
+
+	char *store;                    // manifest of the segment store, NULL in memory only
+	unsigned long next_generation;
+
+	pthread_t merger;
+	int merging;                    // the merge thread runs
+	int closing;
+	long merges;
+
+};
+
+
+/* Tier of a segment of documents documents */
+static int Segment_Tier( size_t documents )
+{
+	int tier = 0;
+
+	for( size_t size = SEGMENT_DEFAULT_DOCS * SEGMENT_MERGE_FANIN; documents >= size; size *= SEGMENT_MERGE_FANIN )
+		tier++;
+
+	return tier;
+}
+
+
+/* Segment file of one generation */
+static void Segment_File_Name( char *name, const char *base, unsigned long generation )
+{
+	snprintf( name, FILENAME_MAX, "%s.%lu", base, generation );
+}
+
+
+/* Release a segment that no snapshot or reader can reach */
+static void Free_Segment( SEGMENT *segment )
+{
+	Free_Hash_Table( &segment -> table );
+	free( segment );
+}
+
+
+/* Readers only ever read a published table, so nothing may be left to do lazily */
+static Status Settle_Segment( HASH_T *table )
+{
+	if( Freeze_Hash_Table( table ) == FAILURE )
+		printf("[INFO]: Could not compress segment postings, keeping linked lists\n");
+
+	Finish_Rehash( table );
+	Update_Doc_Lengths( table );
+
+	return Update_Term_Dict( table );
+}
+
+
+/**/
+SEGMENT_INDEX* Open_Segment_Index( int readers )
+{
+	SEGMENT_INDEX *index = calloc( 1, sizeof( SEGMENT_INDEX ) );
+	SNAPSHOT *empty = calloc( 1, sizeof( SNAPSHOT ) );
+
+	if( index != NULL )
+		index -> active = calloc( readers > 0 ? readers : 1, sizeof( atomic_ulong ) );
+
+	if( index == NULL || empty == NULL || index -> active == NULL )
+	{
+		perror("Malloc failed for the segment index");
+
+		if( index != NULL )
+			free( index -> active );
+
+		free( index );
+		free( empty );
+		return NULL;
+	}
+
+	index -> readers = readers;
+	index -> next_generation = 1;
+
+	for( int reader = 0; reader < readers; reader++ )
+		atomic_init( &index -> active[reader], 0 );
+
+	atomic_init( &index -> epoch, 1 );
+	atomic_init( &index -> current, empty );
+
+	pthread_mutex_init( &index -> lock, NULL );
+	pthread_cond_init( &index -> changed, NULL );
+
+	return index;
+}
+
+
+/* Free a retired snapshot together with the segments merged away when it was replaced */
+static void Free_Snapshot( SNAPSHOT *snapshot )
+{
+	for( int i = 0; i < snapshot -> dropped_count; i++ )
+		Free_Segment( snapshot -> dropped[i] );
+
+	free( snapshot -> dropped );
+	free( snapshot -> segment );
+	free( snapshot );
+}
+
+
+/* Free the retired snapshots no reader can still be using; writer lock held */
+static void Reclaim_Snapshots( SEGMENT_INDEX *index )
+{
+	unsigned long oldest = 0;
+
+	for( int reader = 0; reader < index -> readers; reader++ )
+	{
+		unsigned long entered = atomic_load( &index -> active[reader] );
+
+		if( entered != 0 && ( oldest == 0 || entered < oldest ) )
+			oldest = entered;
+	}
+
+	SNAPSHOT **link = &index -> retired;
+
+	while( *link != NULL )
+	{
+		SNAPSHOT *snapshot = *link;
+
+		// A reader that entered after the epoch advanced past 'retired' loaded a newer snapshot
+		if( oldest == 0 || snapshot -> retired < oldest )
+		{
+			*link = snapshot -> next;
+			Free_Snapshot( snapshot );
+		}
+		else
+		{
+			link = &snapshot -> next;
+		}
+	}
+}
+
+
+/* Rewrite the manifest for snapshot; writer lock held */
+static Status Save_Manifest( SEGMENT_INDEX *index, const SNAPSHOT *snapshot )
+{
+	char temp_name[FILENAME_MAX];
+	snprintf( temp_name, sizeof( temp_name ), "%s.tmp", index -> store );
+
+	FILE *fptr = fopen( temp_name, "w" );
+	if( fptr == NULL )
+	{
+		printf("[INFO]: Could not write segment manifest '%s'\n", temp_name );
+		return FAILURE;
+	}
+
+	fprintf( fptr, "%s %lu\n", SEGMENT_MANIFEST_MAGIC, index -> next_generation );
+
+	for( int i = 0; i < snapshot -> count; i++ )
+		fprintf( fptr, "%lu %zu\n", snapshot -> segment[i] -> generation, snapshot -> segment[i] -> table.Docs.count );
+
+	if( Sync_Close( fptr ) == FAILURE || Commit_File( temp_name, index -> store ) == FAILURE )
+	{
+		printf("[INFO]: Could not write segment manifest '%s'\n", index -> store );
+		remove( temp_name );
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+
+/* Swap in a snapshot in which segment replaces the count segments from first on ( count 0 and
+   first == count of segments appends ); writer lock held */
+static Status Replace_Segments( SEGMENT_INDEX *index, int first, int count, SEGMENT *segment )
+{
+	SNAPSHOT *old = atomic_load( &index -> current );
+	SNAPSHOT *next = calloc( 1, sizeof( SNAPSHOT ) );
+	int total = old -> count - count + ( segment != NULL );
+
+	if( next != NULL )
+		next -> segment = malloc( ( total > 0 ? total : 1 ) * sizeof( SEGMENT* ) );
+
+	if( count > 0 && next != NULL )
+		next -> dropped = malloc( count * sizeof( SEGMENT* ) );
+
+	if( next == NULL || next -> segment == NULL || ( count > 0 && next -> dropped == NULL ) )
+	{
+		perror("Malloc failed for a new snapshot");
+
+		if( next != NULL )
+		{
+			free( next -> segment );
+			free( next -> dropped );
+		}
+
+		free( next );
+		return FAILURE;
+	}
+
+	for( int i = 0; i < old -> count; i++ )
+	{
+		if( i == first && segment != NULL )
+			next -> segment[ next -> count++ ] = segment;
+
+		if( i < first || i >= first + count )
+			next -> segment[ next -> count++ ] = old -> segment[i];
+	}
+
+	if( first == old -> count && segment != NULL )
+		next -> segment[ next -> count++ ] = segment;
+
+	for( int i = 0; i < next -> count; i++ )
+		next -> documents += next -> segment[i] -> table.Docs.count - next -> segment[i] -> table.Docs.deleted;
+
+	// The old snapshot takes the dropped segments with it: readers inside it may still use them
+	SEGMENT **dropped = next -> dropped;
+	next -> dropped = NULL;
+
+	// Swap first, then advance the epoch: a reader announcing the new epoch sees the new snapshot
+	atomic_store( &index -> current, next );
+
+	if( count > 0 )
+		memcpy( dropped, old -> segment + first, count * sizeof( SEGMENT* ) );
+
+	old -> dropped = dropped;
+	old -> dropped_count = count;
+	old -> retired = atomic_fetch_add( &index -> epoch, 1 );
+	old -> next = index -> retired;
+	index -> retired = old;
+
+	Reclaim_Snapshots( index );
+	pthread_cond_broadcast( &index -> changed );
+
+	return index -> store != NULL ? Save_Manifest( index, next ) : SUCCESS;
+}
+
+
+/* Next generation number of the store; writer lock taken here */
+static unsigned long Next_Generation( SEGMENT_INDEX *index )
+{
+	pthread_mutex_lock( &index -> lock );
+	unsigned long generation = index -> next_generation++;
+	pthread_mutex_unlock( &index -> lock );
+
+	return generation;
+}
+
+
+/* Write a settled segment to the store under a new generation */
+static Status Store_Segment( SEGMENT_INDEX *index, SEGMENT *segment )
+{
+	char name[FILENAME_MAX];
+
+	segment -> generation = Next_Generation( index );
+	Segment_File_Name( name, index -> store, segment -> generation );
+
+	return Save_Binary_Index( &segment -> table, name );
+}
+
+
+/**/
+Status Attach_Segment_Store( SEGMENT_INDEX *index, const char *base )
+{
+	index -> store = strdup( base );
+	if( index -> store == NULL )
+		return FAILURE;
+
+	FILE *fptr = fopen( base, "r" );
+	if( fptr == NULL )
+	{
+		if( errno != ENOENT )
+		{
+			printf("[INFO]: Could not open segment manifest '%s'\n", base );
+			return FAILURE;
+		}
+
+		printf("[INFO]: New segment store '%s'\n", base );
+		return SUCCESS;
+	}
+
+	char magic[32];
+	unsigned long generation;
+	size_t documents;
+	Status status = SUCCESS;
+
+	if( fscanf( fptr, "%31s %lu", magic, &index -> next_generation ) != 2 || strcmp( magic, SEGMENT_MANIFEST_MAGIC ) != 0 )
+	{
+		printf("[INFO]: '%s' is not a segment manifest\n", base );
+		status = FAILURE;
+	}
+
+	while( status == SUCCESS && fscanf( fptr, "%lu %zu", &generation, &documents ) == 2 )
+	{
+		char name[FILENAME_MAX];
+		SEGMENT *segment = calloc( 1, sizeof( SEGMENT ) );
+
+		Segment_File_Name( name, base, generation );
+
+		status = segment != NULL && generation < index -> next_generation ? Initialise_Hash_Table( &segment -> table ) : FAILURE;
+
+		if( status == SUCCESS )
+			status = Load_Binary_Index( &segment -> table, name );
+
+		if( status == SUCCESS && segment -> table.Docs.count != documents )
+		{
+			printf("[INFO]: Segment '%s' does not match the manifest\n", name );
+			status = FAILURE;
+		}
+
+		if( status == SUCCESS )
+			status = Settle_Segment( &segment -> table );
+
+		if( status == FAILURE )
+		{
+			if( segment != NULL )
+				Free_Segment( segment );
+
+			break;
+		}
+
+		segment -> generation = generation;
+		segment -> tier = Segment_Tier( documents );
+
+		pthread_mutex_lock( &index -> lock );
+		SNAPSHOT *current = atomic_load( &index -> current );
+		status = Replace_Segments( index, current -> count, 0, segment );
+		pthread_mutex_unlock( &index -> lock );
+	}
+
+	if( status == SUCCESS && !feof( fptr ) )
+	{
+		printf("[INFO]: Segment manifest '%s' is corrupt\n", base );
+		status = FAILURE;
+	}
+
+	fclose( fptr );
+
+	if( status == SUCCESS )
+	{
+		SNAPSHOT *current = atomic_load( &index -> current );
+		printf("[INFO]: Segment store '%s': %d segment%s, %zu documents\n",
+				base, current -> count, current -> count == 1 ? "" : "s", current -> documents );
+	}
+
+	return status;
+}
+
+
+/**/
+Status Publish_Segment( SEGMENT_INDEX *index, HASH_T *table )
+{
+	if( Settle_Segment( table ) == FAILURE )
+		return FAILURE;
+
+	SEGMENT *segment = calloc( 1, sizeof( SEGMENT ) );
+	if( segment == NULL )
+	{
+		perror("Malloc failed for a new segment");
+		return FAILURE;
+	}
+
+	segment -> table = *table;
+	segment -> tier = Segment_Tier( table -> Docs.count );
+
+	if( index -> store != NULL && Store_Segment( index, segment ) == FAILURE )
+	{
+		*table = segment -> table;
+		free( segment );
+		return FAILURE;
+	}
+
+	pthread_mutex_lock( &index -> lock );
+	SNAPSHOT *current = atomic_load( &index -> current );
+	Status status = Replace_Segments( index, current -> count, 0, segment );
+	pthread_mutex_unlock( &index -> lock );
+
+	memset( table, 0, sizeof( HASH_T ) );
+	return status;
+}
+
+
+/* Newest run of SEGMENT_MERGE_FANIN adjacent segments of one tier, -1 when there is none */
+static int Pick_Merge( const SNAPSHOT *snapshot )
+{
+	for( int first = snapshot -> count - SEGMENT_MERGE_FANIN; first >= 0; first-- )
+	{
+		int same = 1;
+
+		for( int i = 1; i < SEGMENT_MERGE_FANIN && same; i++ )
+			same = snapshot -> segment[ first + i ] -> tier == snapshot -> segment[first] -> tier;
+
+		if( same )
+			return first;
+	}
+
+	return -1;
+}
+
+
+/* Merge the picked segments into a new settled ( and stored ) segment; NULL on failure */
+static SEGMENT* Merge_Segments( SEGMENT_INDEX *index, SEGMENT **part )
+{
+	HASH_T *table[SEGMENT_MERGE_FANIN];
+	SEGMENT *merged = calloc( 1, sizeof( SEGMENT ) );
+
+	if( merged == NULL )
+		return NULL;
+
+	for( int i = 0; i < SEGMENT_MERGE_FANIN; i++ )
+		table[i] = &part[i] -> table;
+
+	if( Merge_Index_Tables( table, SEGMENT_MERGE_FANIN, &merged -> table ) == FAILURE )
+	{
+		free( merged );
+		return NULL;
+	}
+
+	merged -> tier = Segment_Tier( merged -> table.Docs.count );
+
+	if( Settle_Segment( &merged -> table ) == FAILURE || ( index -> store != NULL && Store_Segment( index, merged ) == FAILURE ) )
+	{
+		Free_Segment( merged );
+		return NULL;
+	}
+
+	return merged;
+}
+
+
+/* Merge thread: apply the policy whenever a publication changes the segments */
+static void* Segment_Merger( void *arg )
+{
+	SEGMENT_INDEX *index = arg;
+
+	pthread_mutex_lock( &index -> lock );
+
+	while( 1 )
+	{
+		SNAPSHOT *current = atomic_load( &index -> current );
+		int first = Pick_Merge( current );
+
+		if( first < 0 )
+		{
+			if( index -> closing )
+				break;
+
+			pthread_cond_wait( &index -> changed, &index -> lock );
+			continue;
+		}
+
+		SEGMENT *part[SEGMENT_MERGE_FANIN];
+		unsigned long generation[SEGMENT_MERGE_FANIN];
+		memcpy( part, current -> segment + first, sizeof( part ) );
+
+		// Once swapped out the parts may be reclaimed at once; their files are named from these
+		for( int i = 0; i < SEGMENT_MERGE_FANIN; i++ )
+			generation[i] = part[i] -> generation;
+
+		// The parts are immutable: readers and publications go on while they are merged
+		pthread_mutex_unlock( &index -> lock );
+		SEGMENT *merged = Merge_Segments( index, part );
+		pthread_mutex_lock( &index -> lock );
+
+		if( merged == NULL )
+		{
+			printf("[INFO]: Segment merge failed, merging stopped\n");
+			break;
+		}
+
+		if( Replace_Segments( index, first, SEGMENT_MERGE_FANIN, merged ) == FAILURE )
+		{
+			// Not swapped in ( or the manifest still lists the parts ): their files stay
+			printf("[INFO]: Could not record a segment merge, merging stopped\n");
+			break;
+		}
+
+		index -> merges++;
+
+		// Readers may still map the old files; removing them only drops the names
+		for( int i = 0; index -> store != NULL && i < SEGMENT_MERGE_FANIN; i++ )
+		{
+			char name[FILENAME_MAX];
+			Segment_File_Name( name, index -> store, generation[i] );
+			remove( name );
+		}
+	}
+
+	pthread_mutex_unlock( &index -> lock );
+	return NULL;
+}
+
+
+/**/
+Status Start_Segment_Merger( SEGMENT_INDEX *index )
+{
+	if( pthread_create( &index -> merger, NULL, Segment_Merger, index ) != 0 )
+	{
+		printf("[INFO]: Could not start the segment merge thread\n");
+		return FAILURE;
+	}
+
+	index -> merging = 1;
+	return SUCCESS;
+}
+
+
+/**/
+Status Segment_Index_Documents( SEGMENT_INDEX *index, DOC_TABLE *seen )
+{
+	Status status = SUCCESS;
+
+	pthread_mutex_lock( &index -> lock );
+	SNAPSHOT *current = atomic_load( &index -> current );
+
+	for( int i = 0; i < current -> count && status == SUCCESS; i++ )
+	{
+		DOC_TABLE *Docs = &current -> segment[i] -> table.Docs;
+
+		for( size_t id = 0; id < Docs -> count && status == SUCCESS; id++ )
+		{
+			DOC_ID doc_id;
+
+			// A file that failed to index left only a tombstone and may be ingested again
+			if( Docs -> doc[id].deleted )
+				continue;
+
+			status = Register_Document( seen, Docs -> doc[id].name, &doc_id );
+
+			if( status == SUCCESS )
+				Record_Document_File( seen, doc_id, Docs -> doc[id].name, NULL );
+		}
+	}
+
+	pthread_mutex_unlock( &index -> lock );
+	return status;
+}
+
+
+/**/
+const SNAPSHOT* Enter_Snapshot( SEGMENT_INDEX *index, int reader )
+{
+	atomic_store( &index -> active[reader], atomic_load( &index -> epoch ) );
+
+	return atomic_load( &index -> current );
+}
+
+
+/**/
+void Leave_Snapshot( SEGMENT_INDEX *index, int reader )
+{
+	atomic_store( &index -> active[reader], 0 );
+}
+
+
+/**/
+int Snapshot_Segments( const SNAPSHOT *snapshot )
+{
+	return snapshot -> count;
+}
+
+
+/**/
+size_t Snapshot_Documents( const SNAPSHOT *snapshot )
+{
+	return snapshot -> documents;
+}
+
+
+/**/
+const char* Snapshot_Doc_Name( const SNAPSHOT *snapshot, const SHARD_HIT *hit )
+{
+	return Doc_Name( &snapshot -> segment[ hit -> shard ] -> table.Docs, hit -> doc_id );
+}
+
+
+/* Make room for count more hits */
+static Status Grow_Result( SHARD_RESULT *result, size_t *capacity, size_t count )
+{
+	if( result -> count + count <= *capacity )
+		return SUCCESS;
+
+	size_t grown = *capacity ? *capacity * 2 : 16;
+
+	while( grown < result -> count + count )
+		grown *= 2;
+
+	SHARD_HIT *hit = realloc( result -> hit, grown * sizeof( SHARD_HIT ) );
+	if( hit == NULL )
+		return FAILURE;
+
+	result -> hit = hit;
+	*capacity = grown;
+
+	return SUCCESS;
+}
+
+
+/* Append one hit, capacity already reserved */
+static void Add_Hit( SHARD_RESULT *result, int segment, DOC_ID doc_id, Word_Count word_count )
+{
+	SHARD_HIT *hit = &result -> hit[ result -> count++ ];
+
+	hit -> shard = segment;
+	hit -> doc_id = doc_id;
+	hit -> word_count = word_count;
+	hit -> score = 0.0;
+}
+
+
+/**/
+Status Snapshot_Term_Postings( const SNAPSHOT *snapshot, const char *word, SHARD_RESULT *result )
+{
+	size_t capacity = 0;
+
+	result -> hit = NULL;
+	result -> count = 0;
+
+	for( int segment = 0; segment < snapshot -> count; segment++ )
+	{
+		TERM_REF term;
+
+		if( Lookup_Term( &snapshot -> segment[segment] -> table, word, &term ) == FAILURE )
+			continue;
+
+		if( Grow_Result( result, &capacity, term.file_count ) == FAILURE )
+		{
+			Free_Shard_Result( result );
+			return FAILURE;
+		}
+
+		size_t end = result -> count + term.file_count;
+
+		POSTING_ITER it;
+		Posting_Iter_Init_Term( &it, &term );
+
+		while( result -> count < end && Posting_Iter_Next( &it ) == SUCCESS )
+			Add_Hit( result, segment, it.doc_id, it.word_count );
+	}
+
+	return SUCCESS;
+}
+
+
+/**/
+Status Snapshot_Evaluate_Query( const SNAPSHOT *snapshot, const char *text, SHARD_RESULT *result, char *error, size_t size )
+{
+	size_t capacity = 0;
+	Status status = SUCCESS;
+
+	result -> hit = NULL;
+	result -> count = 0;
+
+	snprintf( error, size, "out of memory" );
+
+	for( int segment = 0; status == SUCCESS && segment < snapshot -> count; segment++ )
+	{
+		HASH_T *table = &snapshot -> segment[segment] -> table;
+		QUERY parsed;
+		QUERY_RESULT matches;
+
+		// Pattern expansions live in the parsed tree, so every segment parses its own copy
+		status = Parse_Query( text, &parsed );
+
+		if( status == SUCCESS )
+			status = Expand_Query_Terms( table, &parsed );
+
+		if( status == SUCCESS )
+			status = Evaluate_Query( table, &parsed, &matches );
+
+		if( status == FAILURE )
+		{
+			if( parsed.error != NULL )
+				snprintf( error, size, "%s", parsed.error );
+
+			Free_Query( &parsed );
+			break;
+		}
+
+		status = Grow_Result( result, &capacity, matches.count );
+
+		for( size_t i = 0; status == SUCCESS && i < matches.count; i++ )
+			Add_Hit( result, segment, matches.doc[i], 0 );
+
+		Free_Query_Result( &matches );
+		Free_Query( &parsed );
+	}
+
+	if( status == FAILURE )
+		Free_Shard_Result( result );
+
+	return status;
+}
+
+
+/**/
+void Close_Segment_Index( SEGMENT_INDEX *index )
+{
+	if( index == NULL )
+		return;
+
+	if( index -> merging )
+	{
+		pthread_mutex_lock( &index -> lock );
+		index -> closing = 1;
+		pthread_cond_broadcast( &index -> changed );
+		pthread_mutex_unlock( &index -> lock );
+
+		pthread_join( index -> merger, NULL );
+
+		if( index -> merges > 0 )
+			printf("[INFO]: %ld segment merge%s, %d segment%s left\n", index -> merges, index -> merges == 1 ? "" : "s",
+					atomic_load( &index -> current ) -> count, atomic_load( &index -> current ) -> count == 1 ? "" : "s" );
+	}
+
+	SNAPSHOT *current = atomic_load( &index -> current );
+
+	// The current snapshot lists every live segment; retired ones carry those merged away
+	for( int i = 0; i < current -> count; i++ )
+		Free_Segment( current -> segment[i] );
+
+	current -> next = index -> retired;
+
+	while( current != NULL )
+	{
+		SNAPSHOT *next = current -> next;
+		Free_Snapshot( current );
+		current = next;
+	}
+
+	pthread_mutex_destroy( &index -> lock );
+	pthread_cond_destroy( &index -> changed );
+
+	free( index -> store );
+	free( index -> active );
+	free( index );
+}
@@ -0,0 +1,1097 @@
+/*******************************************************************************************************************************************************************
+ * File        : Shard.c
+ * Project     : Inverted Search Engine (Project-2)
+ *
+ * Description :
+ *      Document-partitioned index. With --shards N the batch commands keep N complete tables
+ *      instead of one; every document lives in exactly one shard, with its postings, its length
+ *      and its tombstone. Shards are built, loaded, saved and compacted independently, and every
+ *      query is scattered to all shards on a pool of one thread per shard and gathered here:
+ *
+ *          boolean / single word : union of the per-shard matches, in global document order
+ *          ranked                : each shard scores with the statistics of the whole index
+ *                                  ( RANK_SCOPE ) and returns its top k; the best k of those win
+ *
+ *      A file is assigned to shard ( n mod N ), n counting the opened files in discovery order.
+ *      Global document order is therefore ( local doc id, shard ), which is the order of a
+ *      one-table build of the same files: sharded and unsharded builds answer alike. ( A text
+ *      save file numbers documents as they first appear in it, for one table or a shard. )
+ *
+ * Function Overview :
+ *
+ *      → Open_Shard_Set( SHARD_SET *set, HASH_T *table, int count )
+ *            • count <= 1 wraps table itself, and every operation below is the one-table call,
+ *              run in the calling thread
+ *            • Otherwise allocates count tables and starts the pool ( one thread per shard )
+ *
+ *      → Close_Shard_Set( SHARD_SET *set )
+ *            • Stops the pool and frees the shard tables it allocated
+ *
+ *      → Shard_File_Name( char *name, const char *base, int shard, int count )
+ *            • Save file of one shard: base itself for one table, base.<shard> otherwise
+ *
+ *      → Build_Shards( SHARD_SET *set, LIST **head, int threads )
+ *            • One table: Create_DataBase_Parallel() with threads
+ *            • Shards: the calling thread walks the list (Corpus.c), drops files already seen or
+ *              that do not open, and deals the rest, opened, to per-shard queues; every shard
+ *              indexes its own files
+ *
+ *      → Load_Shards( SHARD_SET *set, const char *db, const char *index, int verify )
+ *            • FAILURE when a shard file is missing, or when base.<count> exists ( saved with more shards )
+ *
+ *      → Save_Shards( SHARD_SET *set, const char *save, const char *save_index )
+ *      → Freeze_Shards( SHARD_SET *set )  /  Compact_Shards( SHARD_SET *set )
+ *            • The one-table operation on every shard in parallel, with Shard_File_Name() names
+ *
+ *      → Shard_Remove_Document( SHARD_SET *set, const char *filename )
+ *      → Shard_Reindex_Document( SHARD_SET *set, const char *filename )
+ *            • Act on the shard holding filename; a new file goes to the shard with the fewest
+ *              live documents
+ *
+ *      → Shard_Evaluate_Query( SHARD_SET *set, const char *text, SHARD_RESULT *result, char *error, size_t size )
+ *      → Shard_Term_Postings( SHARD_SET *set, const char *word, SHARD_RESULT *result )
+ *      → Shard_Rank_Query( SHARD_SET *set, const char *text, size_t k, int prune, SHARD_RESULT *result )
+ *            • Scatter-gather forms of Evaluate_Query(), one word's postings and Rank_Query()
+ *
+ *      → Shard_Live_Terms( SHARD_SET *set )
+ *            • Distinct words with a live posting in any shard ( merge of the sorted dictionaries )
+ *
+ *      → Free_Shard_Result( SHARD_RESULT *result )
+ *
+ * Notes :
+ *      • Before a scatter every shard is settled: resizes finished, term dictionary sorted and
+ *        document lengths rebuilt. Reading a settled table changes nothing, so shards ( and the
+ *        df lookups of ranked queries into other shards ) can be read at the same time
+ *      • The pool runs one scatter at a time; the calling thread waits for it to finish
+ *      • The interactive menu keeps one table
+ *
+ *******************************************************************************************************************************************************************/
+
+
+#include "Inverted_Search.h"
+#include "Types.h"
+#include <pthread.h>
+#include <unistd.h>
+
+#define SHARD_ERROR_SIZE ( 2 * MAX_WORD_LENGTH + 64 )
+
+
+typedef Status ( *SHARD_TASK )( SHARD_SET *set, int shard, void *context );
+
+
+struct Shard_Pool
+{
+	pthread_t *worker;
+
+	SHARD_TASK task;                // current scatter, NULL while idle
+	void *context;
+	int next;                       // next shard a worker will take
+	int pending;                    // shards of the scatter not finished yet
+	Status status;                  // FAILURE if any shard failed
+	int stop;
+
+	pthread_mutex_t lock;
+	pthread_cond_t changed;
+
+};
+
+
+typedef struct Shard_Feed
+{
+	char *path[SHARD_FEED_SIZE];
+	FILE *file[SHARD_FEED_SIZE];    // opened by the dealer
+	size_t head;
+	size_t count;
+
+} SHARD_FEED;
+
+
+typedef struct Feed_State
+{
+	SHARD_FEED *feed;               // one queue per shard
+	size_t queued;                  // files in all queues, each holding an open handle
+	int done;                       // every file has been dealt
+
+	pthread_mutex_t lock;
+	pthread_cond_t changed;
+
+} FEED_STATE;
+
+
+typedef struct Shard_Part
+{
+	SHARD_RESULT result;
+	char error[SHARD_ERROR_SIZE];
+
+} SHARD_PART;
+
+
+typedef struct Shard_Query
+{
+	const char *text;               // query, or the word of Shard_Term_Postings()
+	size_t k;
+	int prune;
+	const RANK_SCOPE *scope;
+	SHARD_PART *part;               // one per shard
+
+} SHARD_QUERY;
+
+
+typedef struct Shard_Files
+{
+	const char *db;
+	const char *index;
+	int verify;
+	int binary;                     // Save_Shards(): save_index rather than save
+
+} SHARD_FILES;
+
+
+/* Pool thread: run one shard of the current scatter at a time */
+static void* Shard_Worker( void *arg )
+{
+	SHARD_SET *set = arg;
+	struct Shard_Pool *pool = set -> pool;
+
+	pthread_mutex_lock( &pool -> lock );
+
+	while( 1 )
+	{
+		while( !pool -> stop && ( pool -> task == NULL || pool -> next == set -> count ) )
+			pthread_cond_wait( &pool -> changed, &pool -> lock );
+
+		if( pool -> stop )
+			break;
+
+		int shard = pool -> next++;
+		SHARD_TASK task = pool -> task;
+		void *context = pool -> context;
+
+		pthread_mutex_unlock( &pool -> lock );
+
+		Status status = task( set, shard, context );
+
+		pthread_mutex_lock( &pool -> lock );
+
+		if( status == FAILURE )
+			pool -> status = FAILURE;
+
+		if( --pool -> pending == 0 )
+		{
+			pool -> task = NULL;
+			pthread_cond_broadcast( &pool -> changed );
+		}
+	}
+
+	pthread_mutex_unlock( &pool -> lock );
+	return NULL;
+}
+
+
+/* Hand task to the pool for every shard, without waiting */
+static void Scatter_Start( SHARD_SET *set, SHARD_TASK task, void *context )
+{
+	struct Shard_Pool *pool = set -> pool;
+
+	pthread_mutex_lock( &pool -> lock );
+	pool -> task = task;
+	pool -> context = context;
+	pool -> next = 0;
+	pool -> pending = set -> count;
+	pool -> status = SUCCESS;
+	pthread_cond_broadcast( &pool -> changed );
+	pthread_mutex_unlock( &pool -> lock );
+}
+
+
+/* Wait for the scatter of Scatter_Start(); FAILURE if any shard failed */
+static Status Scatter_Wait( SHARD_SET *set )
+{
+	struct Shard_Pool *pool = set -> pool;
+
+	pthread_mutex_lock( &pool -> lock );
+
+	while( pool -> pending > 0 )
+		pthread_cond_wait( &pool -> changed, &pool -> lock );
+
+	Status status = pool -> status;
+	pthread_mutex_unlock( &pool -> lock );
+
+	return status;
+}
+
+
+/* Run task on every shard, on the pool when there is one */
+static Status Scatter( SHARD_SET *set, SHARD_TASK task, void *context )
+{
+	if( set -> pool == NULL )
+	{
+		Status status = SUCCESS;
+
+		for( int shard = 0; shard < set -> count; shard++ )
+			if( task( set, shard, context ) == FAILURE )
+				status = FAILURE;
+
+		return status;
+	}
+
+	Scatter_Start( set, task, context );
+	return Scatter_Wait( set );
+}
+
+
+/* Finish every lazy update of the shards so that reading them has no side effects */
+static Status Settle_Shards( SHARD_SET *set )
+{
+	if( set -> pool == NULL )
+		return SUCCESS;
+
+	for( int shard = 0; shard < set -> count; shard++ )
+	{
+		Finish_Rehash( &set -> shard[shard] );
+		Update_Doc_Lengths( &set -> shard[shard] );
+
+		if( Update_Term_Dict( &set -> shard[shard] ) == FAILURE )
+			return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+
+/**/
+Status Open_Shard_Set( SHARD_SET *set, HASH_T *table, int count )
+{
+	set -> pool = NULL;
+
+	if( count <= 1 )
+	{
+		set -> shard = table;
+		set -> count = 1;
+		return SUCCESS;
+	}
+
+	set -> shard = calloc( count, sizeof( HASH_T ) );
+	set -> count = 0;
+
+	struct Shard_Pool *pool = calloc( 1, sizeof( struct Shard_Pool ) );
+
+	if( set -> shard == NULL || pool == NULL || ( pool -> worker = malloc( count * sizeof( pthread_t ) ) ) == NULL )
+	{
+		perror("Malloc failed for shards");
+		free( set -> shard );
+		free( pool );
+		return FAILURE;
+	}
+
+	for( ; set -> count < count; set -> count++ )
+	{
+		if( Initialise_Hash_Table( &set -> shard[ set -> count ] ) == FAILURE )
+			break;
+	}
+
+	pthread_mutex_init( &pool -> lock, NULL );
+	pthread_cond_init( &pool -> changed, NULL );
+	set -> pool = pool;
+
+	int started = 0;
+
+	// Building needs every shard running at once, so the pool has a thread per shard or none
+	while( set -> count == count && started < count && pthread_create( &pool -> worker[started], NULL, Shard_Worker, set ) == 0 )
+		started++;
+
+	if( started < count )
+	{
+		printf("[INFO]: Could not set up %d shards\n", count );
+
+		pthread_mutex_lock( &pool -> lock );
+		pool -> stop = 1;
+		pthread_cond_broadcast( &pool -> changed );
+		pthread_mutex_unlock( &pool -> lock );
+
+		for( int i = 0; i < started; i++ )
+			pthread_join( pool -> worker[i], NULL );
+
+		set -> pool = NULL;
+		pthread_mutex_destroy( &pool -> lock );
+		pthread_cond_destroy( &pool -> changed );
+		free( pool -> worker );
+		free( pool );
+
+		for( int i = 0; i < set -> count; i++ )
+			Free_Hash_Table( &set -> shard[i] );
+
+		free( set -> shard );
+		set -> shard = NULL;
+		set -> count = 0;
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+
+/**/
+void Close_Shard_Set( SHARD_SET *set )
+{
+	struct Shard_Pool *pool = set -> pool;
+
+	// One table belongs to the caller
+	if( pool == NULL )
+		return;
+
+	pthread_mutex_lock( &pool -> lock );
+	pool -> stop = 1;
+	pthread_cond_broadcast( &pool -> changed );
+	pthread_mutex_unlock( &pool -> lock );
+
+	for( int i = 0; i < set -> count; i++ )
+		pthread_join( pool -> worker[i], NULL );
+
+	pthread_mutex_destroy( &pool -> lock );
+	pthread_cond_destroy( &pool -> changed );
+	free( pool -> worker );
+	free( pool );
+
+	for( int i = 0; i < set -> count; i++ )
+		Free_Hash_Table( &set -> shard[i] );
+
+	free( set -> shard );
+	set -> shard = NULL;
+	set -> count = 0;
+	set -> pool = NULL;
+}
+
+
+/**/
+void Shard_File_Name( char *name, const char *base, int shard, int count )
+{
+	if( count <= 1 )
+		snprintf( name, FILENAME_MAX, "%s", base );
+	else
+		snprintf( name, FILENAME_MAX, "%s.%d", base, shard );
+}
+
+
+/* Pool task: index the files dealt to one shard, opening each only while it is indexed */
+static Status Build_Shard( SHARD_SET *set, int shard, void *context )
+{
+	FEED_STATE *state = context;
+	SHARD_FEED *feed = &state -> feed[shard];
+	HASH_T *Hash_T = &set -> shard[shard];
+	Status status = SUCCESS;
+
+	Adopt_Posting_Form( Hash_T );
+
+	while( 1 )
+	{
+		pthread_mutex_lock( &state -> lock );
+
+		while( feed -> count == 0 && !state -> done )
+			pthread_cond_wait( &state -> changed, &state -> lock );
+
+		if( feed -> count == 0 )
+		{
+			pthread_mutex_unlock( &state -> lock );
+			break;
+		}
+
+		char *path = feed -> path[ feed -> head ];
+		FILE *fptr = feed -> file[ feed -> head ];
+		feed -> head = ( feed -> head + 1 ) % SHARD_FEED_SIZE;
+		feed -> count--;
+		state -> queued--;
+
+		pthread_cond_broadcast( &state -> changed );
+		pthread_mutex_unlock( &state -> lock );
+
+		DOC_ID doc_id;
+
+		if( Register_Document( &Hash_T -> Docs, path, &doc_id ) == FAILURE )
+		{
+			printf("[INFO]: Could not register '%s'. Skipping...\n", path );
+		}
+		else
+		{
+			Record_Document_File( &Hash_T -> Docs, doc_id, path, fptr );
+
+			if( Index_File( Hash_T, fptr, doc_id ) == FAILURE )
+			{
+				printf("[INFO]: Indexing '%s' failed\n", path );
+				status = FAILURE;
+			}
+		}
+
+		fclose( fptr );
+		free( path );
+	}
+
+	return status;
+}
+
+
+/**/
+Status Build_Shards( SHARD_SET *set, LIST **head, int threads )
+{
+	if( set -> pool == NULL )
+		return Create_DataBase_Parallel( set -> shard, head, threads );
+
+	if( head == NULL )
+	{
+		printf("[INFO]: No File to add to the List.\n");
+		return FAILURE;
+	}
+
+	FEED_STATE state;
+	DOC_TABLE seen;
+
+	state.feed = calloc( set -> count, sizeof( SHARD_FEED ) );
+	state.queued = 0;
+	state.done = 0;
+
+	if( state.feed == NULL || Initialise_Doc_Table( &seen ) == FAILURE )
+	{
+		perror("Malloc failed for shard build");
+		free( state.feed );
+		return FAILURE;
+	}
+
+	CORPUS *corpus = Open_Corpus( *head );
+	if( corpus == NULL )
+	{
+		Free_Doc_Table( &seen );
+		free( state.feed );
+		return FAILURE;
+	}
+
+	pthread_mutex_init( &state.lock, NULL );
+	pthread_cond_init( &state.changed, NULL );
+
+	Scatter_Start( set, Build_Shard, &state );
+
+	char filename[FILENAME_MAX];
+	long dealt = 0;
+
+	while( Next_Corpus_File( corpus, filename ) == SUCCESS )
+	{
+		DOC_ID doc_id;
+
+		// A file is indexed once, whichever shard would hold it
+		if( Find_Document_File( &seen, filename, NULL, NULL ) == EXISTS )
+		{
+			printf("[INFO]: '%s' already present in database. Skipping...\n", filename );
+			continue;
+		}
+
+		// Only a file that opens takes its turn, so the files after it land where a one-table build puts them
+		FILE *fptr = fopen( filename, "r" );
+		if( fptr == NULL )
+		{
+			printf("[INFO]: Could not open '%s'. Skipping...\n", filename );
+			Skip_Corpus_File( corpus );
+			continue;
+		}
+
+		char *path = strdup( filename );
+
+		if( path == NULL || Register_Document( &seen, filename, &doc_id ) == FAILURE )
+		{
+			printf("[INFO]: Could not register '%s'. Skipping...\n", filename );
+			free( path );
+			fclose( fptr );
+			continue;
+		}
+
+		Record_Document_File( &seen, doc_id, filename, fptr );
+
+		SHARD_FEED *feed = &state.feed[ dealt++ % set -> count ];
+
+		pthread_mutex_lock( &state.lock );
+
+		while( feed -> count == SHARD_FEED_SIZE || state.queued == SHARD_OPEN_FILES )
+			pthread_cond_wait( &state.changed, &state.lock );
+
+		feed -> path[ ( feed -> head + feed -> count ) % SHARD_FEED_SIZE ] = path;
+		feed -> file[ ( feed -> head + feed -> count ) % SHARD_FEED_SIZE ] = fptr;
+		feed -> count++;
+		state.queued++;
+
+		pthread_cond_broadcast( &state.changed );
+		pthread_mutex_unlock( &state.lock );
+	}
+
+	pthread_mutex_lock( &state.lock );
+	state.done = 1;
+	pthread_cond_broadcast( &state.changed );
+	pthread_mutex_unlock( &state.lock );
+
+	Status status = Scatter_Wait( set );
+
+	Close_Corpus( corpus );
+	Free_Doc_Table( &seen );
+	pthread_mutex_destroy( &state.lock );
+	pthread_cond_destroy( &state.changed );
+	free( state.feed );
+
+	return status;
+}
+
+
+/* Pool task: load one shard from its text save file or binary index */
+static Status Load_Shard( SHARD_SET *set, int shard, void *context )
+{
+	SHARD_FILES *files = context;
+	char name[FILENAME_MAX];
+
+	if( files -> db != NULL )
+	{
+		Shard_File_Name( name, files -> db, shard, set -> count );
+		return Load_DataBase_File( &set -> shard[shard], name );
+	}
+
+	Shard_File_Name( name, files -> index, shard, set -> count );
+
+	if( Load_Binary_Index( &set -> shard[shard], name ) == FAILURE )
+		return FAILURE;
+
+	return files -> verify ? Verify_Binary_Index( &set -> shard[shard] ) : SUCCESS;
+}
+
+
+/**/
+Status Load_Shards( SHARD_SET *set, const char *db, const char *index, int verify )
+{
+	SHARD_FILES files = { db, index, verify, 0 };
+	char name[FILENAME_MAX];
+
+	if( Scatter( set, Load_Shard, &files ) == FAILURE )
+		return FAILURE;
+
+	// Fewer shards than were saved would silently leave documents out
+	Shard_File_Name( name, db != NULL ? db : index, set -> count, set -> count );
+
+	if( set -> count > 1 && access( name, F_OK ) == 0 )
+	{
+		printf("[INFO]: '%s' exists: the index was saved with more than %d shards\n", name, set -> count );
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+
+/* Pool task: write one shard's text save file or binary index */
+static Status Save_Shard( SHARD_SET *set, int shard, void *context )
+{
+	SHARD_FILES *files = context;
+	char name[FILENAME_MAX];
+
+	if( files -> binary )
+	{
+		Shard_File_Name( name, files -> index, shard, set -> count );
+		return Save_Binary_Index( &set -> shard[shard], name );
+	}
+
+	Shard_File_Name( name, files -> db, shard, set -> count );
+	return Save_DataBase_File( &set -> shard[shard], name, 0 );
+}
+
+
+/**/
+Status Save_Shards( SHARD_SET *set, const char *save, const char *save_index )
+{
+	SHARD_FILES files = { save, save_index, 0, 0 };
+	Status status = SUCCESS;
+
+	if( save != NULL )
+		status = Scatter( set, Save_Shard, &files );
+
+	files.binary = 1;
+
+	if( status == SUCCESS && save_index != NULL )
+		status = Scatter( set, Save_Shard, &files );
+
+	return status;
+}
+
+
+/* Pool task: Freeze_Hash_Table() of one shard */
+static Status Freeze_Shard( SHARD_SET *set, int shard, void *context )
+{
+	( void ) context;
+
+	return Freeze_Hash_Table( &set -> shard[shard] );
+}
+
+
+/**/
+Status Freeze_Shards( SHARD_SET *set )
+{
+	return Scatter( set, Freeze_Shard, NULL );
+}
+
+
+/* Pool task: Compact_Index() of one shard */
+static Status Compact_Shard( SHARD_SET *set, int shard, void *context )
+{
+	( void ) context;
+
+	return Compact_Index( &set -> shard[shard] );
+}
+
+
+/**/
+Status Compact_Shards( SHARD_SET *set )
+{
+	return Scatter( set, Compact_Shard, NULL );
+}
+
+
+/* Shard holding filename as a live document ( by name or file identity ), -1 if none */
+static int Find_Shard( SHARD_SET *set, const char *filename )
+{
+	for( int shard = 0; shard < set -> count; shard++ )
+		if( Find_Document_File( &set -> shard[shard].Docs, filename, NULL, NULL ) == EXISTS )
+			return shard;
+
+	return -1;
+}
+
+
+/**/
+Status Shard_Remove_Document( SHARD_SET *set, const char *filename )
+{
+	int shard = Find_Shard( set, filename );
+
+	// Remove_Document() reports a file no shard holds
+	return Remove_Document( &set -> shard[ shard >= 0 ? shard : 0 ], filename );
+}
+
+
+/**/
+Status Shard_Reindex_Document( SHARD_SET *set, const char *filename )
+{
+	int shard = Find_Shard( set, filename );
+
+	// A new file keeps the shards balanced
+	if( shard < 0 )
+	{
+		shard = 0;
+
+		for( int i = 1; i < set -> count; i++ )
+		{
+			DOC_TABLE *Docs = &set -> shard[i].Docs;
+			DOC_TABLE *Least = &set -> shard[shard].Docs;
+
+			if( Docs -> count - Docs -> deleted < Least -> count - Least -> deleted )
+				shard = i;
+		}
+	}
+
+	return Reindex_Document( &set -> shard[shard], filename );
+}
+
+
+/* Global document order: local doc id first, then shard ( the order of a one-table build ) */
+static int Compare_Shard_Doc( const SHARD_HIT *a, const SHARD_HIT *b )
+{
+	if( a -> doc_id != b -> doc_id )
+		return a -> doc_id < b -> doc_id ? -1 : 1;
+
+	return ( a -> shard > b -> shard ) - ( a -> shard < b -> shard );
+}
+
+
+/* qsort comparator for hits of one shard, by doc id */
+static int Compare_Hit_Doc( const void *a, const void *b )
+{
+	return Compare_Shard_Doc( a, b );
+}
+
+
+/* qsort comparator for ranked hits: best score first, then global document order */
+static int Compare_Hit_Score( const void *a, const void *b )
+{
+	const SHARD_HIT *x = a;
+	const SHARD_HIT *y = b;
+
+	if( x -> score != y -> score )
+		return x -> score > y -> score ? -1 : 1;
+
+	return Compare_Shard_Doc( x, y );
+}
+
+
+/* Allocate room for count hits; FAILURE when out of memory */
+static Status Result_Alloc( SHARD_RESULT *result, size_t count )
+{
+	result -> count = 0;
+	result -> hit = malloc( ( count ? count : 1 ) * sizeof( SHARD_HIT ) );
+
+	if( result -> hit == NULL )
+	{
+		perror("Malloc failed for shard results");
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+
+/* Union of the per-shard results, each in doc id order, into global document order */
+static Status Gather_Union( SHARD_SET *set, SHARD_PART *part, SHARD_RESULT *result )
+{
+	size_t total = 0;
+
+	for( int shard = 0; shard < set -> count; shard++ )
+		total += part[shard].result.count;
+
+	if( Result_Alloc( result, total ) == FAILURE )
+		return FAILURE;
+
+	size_t *next = calloc( set -> count, sizeof( size_t ) );
+	if( next == NULL )
+	{
+		perror("Malloc failed for shard results");
+		Free_Shard_Result( result );
+		return FAILURE;
+	}
+
+	// Shards are few, so the smallest head is found by a scan
+	while( result -> count < total )
+	{
+		int best = -1;
+
+		for( int shard = 0; shard < set -> count; shard++ )
+		{
+			if( next[shard] == part[shard].result.count )
+				continue;
+
+			if( best < 0 || Compare_Shard_Doc( &part[shard].result.hit[ next[shard] ], &part[best].result.hit[ next[best] ] ) < 0 )
+				best = shard;
+		}
+
+		result -> hit[ result -> count++ ] = part[best].result.hit[ next[best]++ ];
+	}
+
+	free( next );
+	return SUCCESS;
+}
+
+
+/* Scatter task over a zeroed part per shard; the parts are freed again */
+static Status Scatter_Query( SHARD_SET *set, SHARD_TASK task, SHARD_QUERY *query )
+{
+	query -> part = calloc( set -> count, sizeof( SHARD_PART ) );
+
+	if( query -> part == NULL )
+	{
+		perror("Malloc failed for shard results");
+		return FAILURE;
+	}
+
+	if( Settle_Shards( set ) == FAILURE )
+		return FAILURE;
+
+	return Scatter( set, task, query );
+}
+
+
+/* Release the parts of Scatter_Query() */
+static void Free_Parts( SHARD_SET *set, SHARD_QUERY *query )
+{
+	if( query -> part == NULL )
+		return;
+
+	for( int shard = 0; shard < set -> count; shard++ )
+		Free_Shard_Result( &query -> part[shard].result );
+
+	free( query -> part );
+	query -> part = NULL;
+}
+
+
+/* Pool task: the matching documents of one shard */
+static Status Evaluate_Shard( SHARD_SET *set, int shard, void *context )
+{
+	SHARD_QUERY *query = context;
+	SHARD_PART *part = &query -> part[shard];
+	QUERY parsed;
+	QUERY_RESULT matches;
+
+	// Pattern expansions live in the parsed tree, so every shard parses its own copy
+	Status status = Parse_Query( query -> text, &parsed );
+
+	if( status == SUCCESS )
+		status = Expand_Query_Terms( &set -> shard[shard], &parsed );
+
+	if( status == SUCCESS )
+		status = Evaluate_Query( &set -> shard[shard], &parsed, &matches );
+
+	if( status == FAILURE )
+	{
+		snprintf( part -> error, SHARD_ERROR_SIZE, "%s", parsed.error != NULL ? parsed.error : "out of memory" );
+		Free_Query( &parsed );
+		return FAILURE;
+	}
+
+	status = Result_Alloc( &part -> result, matches.count );
+
+	for( size_t i = 0; status == SUCCESS && i < matches.count; i++ )
+	{
+		part -> result.hit[i].shard = shard;
+		part -> result.hit[i].doc_id = matches.doc[i];
+		part -> result.hit[i].word_count = 0;
+		part -> result.hit[i].score = 0.0;
+		part -> result.count++;
+	}
+
+	if( status == FAILURE )
+		snprintf( part -> error, SHARD_ERROR_SIZE, "out of memory" );
+
+	Free_Query_Result( &matches );
+	Free_Query( &parsed );
+
+	return status;
+}
+
+
+/**/
+Status Shard_Evaluate_Query( SHARD_SET *set, const char *text, SHARD_RESULT *result, char *error, size_t size )
+{
+	SHARD_QUERY query = { text, 0, 0, NULL, NULL };
+
+	result -> hit = NULL;
+	result -> count = 0;
+
+	Status status = Scatter_Query( set, Evaluate_Shard, &query );
+
+	if( status == SUCCESS )
+		status = Gather_Union( set, query.part, result );
+
+	// Every shard sees the same query, so the first message explains the failure
+	snprintf( error, size, "out of memory" );
+
+	for( int shard = 0; status == FAILURE && query.part != NULL && shard < set -> count; shard++ )
+	{
+		if( query.part[shard].error[0] != '\0' )
+		{
+			snprintf( error, size, "%s", query.part[shard].error );
+			break;
+		}
+	}
+
+	Free_Parts( set, &query );
+	return status;
+}
+
+
+/* Pool task: the live postings of one word in one shard */
+static Status Postings_Shard( SHARD_SET *set, int shard, void *context )
+{
+	SHARD_QUERY *query = context;
+	SHARD_RESULT *result = &query -> part[shard].result;
+	TERM_REF term;
+
+	if( Lookup_Term( &set -> shard[shard], query -> text, &term ) == FAILURE )
+		return SUCCESS;
+
+	if( Result_Alloc( result, term.file_count ) == FAILURE )
+		return FAILURE;
+
+	POSTING_ITER it;
+	Posting_Iter_Init_Term( &it, &term );
+
+	while( Posting_Iter_Next( &it ) == SUCCESS && result -> count < ( size_t ) term.file_count )
+	{
+		SHARD_HIT *hit = &result -> hit[ result -> count++ ];
+
+		hit -> shard = shard;
+		hit -> doc_id = it.doc_id;
+		hit -> word_count = it.word_count;
+		hit -> score = 0.0;
+	}
+
+	// A loaded chain lists files in save order; the gather needs doc id order
+	if( set -> count > 1 )
+		qsort( result -> hit, result -> count, sizeof( SHARD_HIT ), Compare_Hit_Doc );
+
+	return SUCCESS;
+}
+
+
+/**/
+Status Shard_Term_Postings( SHARD_SET *set, const char *word, SHARD_RESULT *result )
+{
+	SHARD_QUERY query = { word, 0, 0, NULL, NULL };
+
+	result -> hit = NULL;
+	result -> count = 0;
+
+	Status status = Scatter_Query( set, Postings_Shard, &query );
+
+	if( status == SUCCESS )
+		status = Gather_Union( set, query.part, result );
+
+	Free_Parts( set, &query );
+	return status;
+}
+
+
+/* Pool task: the best k documents of one shard, scored against the whole index */
+static Status Rank_Shard( SHARD_SET *set, int shard, void *context )
+{
+	SHARD_QUERY *query = context;
+	SHARD_RESULT *result = &query -> part[shard].result;
+	RANK_RESULT ranked;
+
+	if( Rank_Query_Scope( &set -> shard[shard], query -> text, query -> k, query -> prune, query -> scope, &ranked ) == FAILURE )
+		return FAILURE;
+
+	Status status = Result_Alloc( result, ranked.count );
+
+	for( size_t i = 0; status == SUCCESS && i < ranked.count; i++ )
+	{
+		SHARD_HIT *hit = &result -> hit[ result -> count++ ];
+
+		hit -> shard = shard;
+		hit -> doc_id = ranked.hit[i].doc_id;
+		hit -> word_count = 0;
+		hit -> score = ranked.hit[i].score;
+	}
+
+	Free_Rank_Result( &ranked );
+	return status;
+}
+
+
+/**/
+Status Shard_Rank_Query( SHARD_SET *set, const char *text, size_t k, int prune, SHARD_RESULT *result )
+{
+	RANK_SCOPE scope = { set -> shard, set -> count, 0.0, 0.0 };
+	SHARD_QUERY query = { text, k, prune, NULL, NULL };
+
+	result -> hit = NULL;
+	result -> count = 0;
+
+	// One table already holds the statistics of the whole index
+	if( set -> count > 1 )
+	{
+		double total_length = 0.0;
+
+		if( Settle_Shards( set ) == FAILURE )
+			return FAILURE;
+
+		for( int shard = 0; shard < set -> count; shard++ )
+		{
+			DOC_TABLE *Docs = &set -> shard[shard].Docs;
+
+			scope.documents += Docs -> count - Docs -> deleted;
+			total_length += Docs -> total_length;
+		}
+
+		scope.average = scope.documents > 0 ? total_length / scope.documents : 1.0;
+		query.scope = &scope;
+	}
+
+	Status status = Scatter_Query( set, Rank_Shard, &query );
+	size_t total = 0;
+
+	for( int shard = 0; status == SUCCESS && shard < set -> count; shard++ )
+		total += query.part[shard].result.count;
+
+	if( status == SUCCESS )
+		status = Result_Alloc( result, total );
+
+	for( int shard = 0; status == SUCCESS && shard < set -> count; shard++ )
+		for( size_t i = 0; i < query.part[shard].result.count; i++ )
+			result -> hit[ result -> count++ ] = query.part[shard].result.hit[i];
+
+	// Top k of the union of every shard's top k
+	if( status == SUCCESS )
+	{
+		qsort( result -> hit, result -> count, sizeof( SHARD_HIT ), Compare_Hit_Score );
+
+		if( result -> count > k )
+			result -> count = k;
+	}
+
+	Free_Parts( set, &query );
+	return status;
+}
+
+
+/**/
+long Shard_Live_Terms( SHARD_SET *set )
+{
+	size_t *next = calloc( set -> count, sizeof( size_t ) );
+	size_t *size = calloc( set -> count, sizeof( size_t ) );
+	long terms = 0;
+
+	if( next == NULL || size == NULL )
+	{
+		perror("Malloc failed for term count");
+		free( next );
+		free( size );
+		return -1;
+	}
+
+	for( int shard = 0; shard < set -> count; shard++ )
+		size[shard] = Term_Dict_Size( &set -> shard[shard] );
+
+	// k-way merge of the sorted dictionaries: equal words meet at the heads together
+	while( 1 )
+	{
+		const char *word = NULL;
+
+		for( int shard = 0; shard < set -> count; shard++ )
+		{
+			TERM_REF ref;
+
+			if( next[shard] == size[shard] )
+				continue;
+
+			Term_Dict_Ref( &set -> shard[shard], next[shard], &ref );
+
+			if( word == NULL || Compare_Terms( ref.word, word ) < 0 )
+				word = ref.word;
+		}
+
+		if( word == NULL )
+			break;
+
+		int live = 0;
+
+		for( int shard = 0; shard < set -> count; shard++ )
+		{
+			TERM_REF ref;
+
+			if( next[shard] == size[shard] )
+				continue;
+
+			Term_Dict_Ref( &set -> shard[shard], next[shard], &ref );
+
+			if( strcmp( ref.word, word ) != 0 )
+				continue;
+
+			// A word found only in deleted documents is gone until compaction removes it
+			live |= Live_File_Count( &ref ) > 0;
+			next[shard]++;
+		}
+
+		terms += live;
+	}
+
+	free( next );
+	free( size );
+	return terms;
+}
+
+
+/**/
+void Free_Shard_Result( SHARD_RESULT *result )
+{
+	free( result -> hit );
+	result -> hit = NULL;
+	result -> count = 0;
+}
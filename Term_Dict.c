@@ -0,0 +1,432 @@
+/*******************************************************************************************************************************************************************
+ * File        : Term_Dict.c
+ * Project     : Inverted Search Engine (Project-2)
+ *
+ * Description :
+ *      Sorted term dictionary next to the whole-word hash index. The hash table answers exact
+ *      lookups; the dictionary answers everything that needs the vocabulary in order: prefix
+ *      and wildcard expansion ( inv*, in?ex ), lexicographic ranges ( apple..banana ) and
+ *      sorted walks for Display and the binary index writer.
+ *
+ *      Heap table  : an array of MAIN_NODE pointers in dictionary order. The words already live
+ *                    in Main_arena, so the array costs one pointer per word. It is rebuilt on
+ *                    first use after Link_Main_Node() added a word ( stale flag ), so a build
+ *                    pays for one sort, not one sorted insert per new word.
+ *      Mapped index: the TERM_ENTRY array of the file is already in dictionary order and is
+ *                    used in place.
+ *
+ * Function Overview :
+ *
+ *      → Update_Term_Dict( HASH_T *Hash_T )
+ *            • Collects the heap words and sorts them once when the dictionary is stale
+ *
+ *      → Term_Dict_Size( HASH_T *Hash_T )
+ *            • Number of terms, updating the heap dictionary first ( 0 if that fails )
+ *            • Materialises a mapped index that has heap words over it, so call it before
+ *              Term_Dict_Ref() / Term_Dict_Seek() positions are used
+ *
+ *      → Term_Dict_Ref( HASH_T *Hash_T, size_t pos, TERM_REF *ref )
+ *            • TERM_REF of the pos-th term in dictionary order
+ *
+ *      → Term_Dict_Seek( HASH_T *Hash_T, const char *word )
+ *            • Position of the first term >= word ( binary search )
+ *
+ *      → Match_Pattern( const char *pattern, const char *word )
+ *            • '*' matches any run of characters, '?' exactly one
+ *
+ *      → Expand_Pattern( HASH_T *Hash_T, const char *pattern, TERM_REF *out, size_t max )
+ *      → Expand_Range( HASH_T *Hash_T, const char *from, const char *to, TERM_REF *out, size_t max )
+ *            • Store up to max matching terms in out, in dictionary order, and return how many
+ *              matched; max + 1 means "more than max", the scan stops there
+ *
+ *      → Expand_Fuzzy( HASH_T *Hash_T, const char *word, int distance, TERM_REF *out, int *out_distance, size_t max )
+ *            • Terms within Levenshtein distance of word, same contract as Expand_Pattern();
+ *              out_distance ( may be NULL ) receives the distance of each stored term
+ *
+ *      → Auto_Fuzzy_Distance( const char *word )
+ *            • 0 up to 2 bytes, 1 up to 5, 2 beyond: what a typo in a word that long usually costs
+ *
+ *      → Free_Term_Dict( HASH_T *Hash_T )
+ *
+ * Fuzzy Search :
+ *      The sorted dictionary is walked as if it were a trie, with one Levenshtein DP row per
+ *      prefix byte ( a Levenshtein automaton evaluated lazily ). Neighbouring terms share
+ *      prefixes, so only the rows past the shared prefix are computed. Once every cell of a
+ *      row exceeds the distance, no term with that prefix can match: the whole run of terms
+ *      is skipped with one galloping search. Only prefixes that can still lead to a match
+ *      are ever visited, never the whole vocabulary.
+ *
+ * Notes :
+ *      • Dictionary order is Compare_Terms(): letter group, then strcmp() within the group.
+ *        Every word sharing a non-empty prefix is in one group, so a prefix is one contiguous run
+ *      • A pattern is only scanned from its literal prefix ( the part before the first '*' or
+ *        '?' ); a leading wildcard walks the whole vocabulary
+ *      • Range bounds are inclusive; an empty bound leaves that side open
+ *
+ *******************************************************************************************************************************************************************/
+
+
+#include "Inverted_Search.h"
+#include "Types.h"
+
+
+/* Terms come from the mapping until it has been copied into the heap table */
+static int Uses_Mapping( HASH_T *Hash_T )
+{
+	return Hash_T -> Mapped != NULL && !Hash_T -> Mapped -> materialised;
+}
+
+
+/* qsort comparator for MAIN_NODE pointers by dictionary order */
+static int Compare_Node( const void *a, const void *b )
+{
+	return Compare_Terms( ( *( MAIN_NODE* const* ) a ) -> word, ( *( MAIN_NODE* const* ) b ) -> word );
+}
+
+
+/**/
+Status Update_Term_Dict( HASH_T *Hash_T )
+{
+	TERM_DICT *dict = &Hash_T -> Dict;
+
+	if( !dict -> stale || Uses_Mapping( Hash_T ) )
+		return SUCCESS;
+
+	if( Hash_T -> word_total > dict -> capacity )
+	{
+		MAIN_NODE **bigger = realloc( dict -> node, Hash_T -> word_total * sizeof( MAIN_NODE* ) );
+		if( bigger == NULL )
+		{
+			perror("Realloc failed for term dictionary");
+			return FAILURE;
+		}
+
+		dict -> node = bigger;
+		dict -> capacity = Hash_T -> word_total;
+	}
+
+	dict -> count = 0;
+
+	for( int i = 0; i < LETTER_GROUPS; i++ )
+		for( MAIN_NODE *node = Hash_T -> Letter[i].link; node != NULL; node = node -> Next_Main_node )
+			dict -> node[ dict -> count++ ] = node;
+
+	// Groups are already in order; only the words inside each group need sorting
+	size_t start = 0;
+
+	for( size_t i = 1; i <= dict -> count; i++ )
+	{
+		if( i < dict -> count && Find_Index( dict -> node[i] -> word[0] ) == Find_Index( dict -> node[start] -> word[0] ) )
+			continue;
+
+		qsort( dict -> node + start, i - start, sizeof( MAIN_NODE* ), Compare_Node );
+		start = i;
+	}
+
+	dict -> stale = 0;
+	return SUCCESS;
+}
+
+
+/**/
+size_t Term_Dict_Size( HASH_T *Hash_T )
+{
+	// Words re-indexed over a mapping live in the heap: the whole dictionary joins them there
+	if( Uses_Mapping( Hash_T ) && Hash_T -> word_total > 0 && Materialise_Mapped_Index( Hash_T ) == FAILURE )
+		return 0;
+
+	if( Uses_Mapping( Hash_T ) )
+		return Hash_T -> Mapped -> header -> term_count;
+
+	if( Update_Term_Dict( Hash_T ) == FAILURE )
+		return 0;
+
+	return Hash_T -> Dict.count;
+}
+
+
+/**/
+void Term_Dict_Ref( HASH_T *Hash_T, size_t pos, TERM_REF *ref )
+{
+	if( Uses_Mapping( Hash_T ) )
+	{
+		Mapped_Term_Ref( Hash_T -> Mapped, pos, ref );
+		ref -> docs = Doc_Tombstones( &Hash_T -> Docs );
+		return;
+	}
+
+	MAIN_NODE *node = Hash_T -> Dict.node[pos];
+
+	ref -> word = node -> word;
+	ref -> file_count = node -> file_count;
+	ref -> node = node;
+	ref -> postings = NULL;
+	ref -> postings_len = 0;
+	ref -> doc_limit = 0;
+	ref -> positional = Hash_T -> Positional;
+	ref -> docs = Doc_Tombstones( &Hash_T -> Docs );
+}
+
+
+/* Word of the pos-th term without building a whole TERM_REF */
+static const char* Term_Dict_Word( HASH_T *Hash_T, size_t pos )
+{
+	if( Uses_Mapping( Hash_T ) )
+		return Hash_T -> Mapped -> words + Hash_T -> Mapped -> term[pos].word_offset;
+
+	return Hash_T -> Dict.node[pos] -> word;
+}
+
+
+/**/
+size_t Term_Dict_Seek( HASH_T *Hash_T, const char *word )
+{
+	size_t low = 0;
+	size_t high = Term_Dict_Size( Hash_T );
+
+	// "" would sort into the symbols group; as a bound it means "from the first term"
+	if( word[0] == '\0' )
+		return 0;
+
+	while( low < high )
+	{
+		size_t middle = low + ( high - low ) / 2;
+
+		if( Compare_Terms( Term_Dict_Word( Hash_T, middle ), word ) < 0 )
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	return low;
+}
+
+
+/**/
+int Match_Pattern( const char *pattern, const char *word )
+{
+	const char *star = NULL;            // last '*' seen, and where its run started in word
+	const char *resume = NULL;
+
+	while( *word != '\0' )
+	{
+		if( *pattern == '*' )
+		{
+			star = pattern++;
+			resume = word;
+		}
+		else if( *pattern == '?' || *pattern == *word )
+		{
+			pattern++;
+			word++;
+		}
+		else if( star != NULL )
+		{
+			// Let the last '*' swallow one more character and retry
+			pattern = star + 1;
+			word = ++resume;
+		}
+		else
+			return 0;
+	}
+
+	while( *pattern == '*' )
+		pattern++;
+
+	return *pattern == '\0';
+}
+
+
+/**/
+size_t Expand_Pattern( HASH_T *Hash_T, const char *pattern, TERM_REF *out, size_t max )
+{
+	WORD prefix;
+	size_t length = strcspn( pattern, "*?" );
+
+	if( length > MAX_WORD_LENGTH - 1 )
+		length = MAX_WORD_LENGTH - 1;
+
+	memcpy( prefix, pattern, length );
+	prefix[length] = '\0';
+
+	size_t total = Term_Dict_Size( Hash_T );
+	size_t matched = 0;
+
+	for( size_t pos = Term_Dict_Seek( Hash_T, prefix ); pos < total && matched <= max; pos++ )
+	{
+		const char *word = Term_Dict_Word( Hash_T, pos );
+
+		// Past the run of words that start with the prefix
+		if( strncmp( word, prefix, length ) != 0 )
+			break;
+
+		if( !Match_Pattern( pattern, word ) )
+			continue;
+
+		if( matched < max )
+			Term_Dict_Ref( Hash_T, pos, &out[matched] );
+
+		matched++;
+	}
+
+	return matched;
+}
+
+
+/**/
+size_t Expand_Range( HASH_T *Hash_T, const char *from, const char *to, TERM_REF *out, size_t max )
+{
+	size_t total = Term_Dict_Size( Hash_T );
+	size_t matched = 0;
+
+	for( size_t pos = Term_Dict_Seek( Hash_T, from ); pos < total && matched <= max; pos++ )
+	{
+		if( to[0] != '\0' && Compare_Terms( Term_Dict_Word( Hash_T, pos ), to ) > 0 )
+			break;
+
+		if( matched < max )
+			Term_Dict_Ref( Hash_T, pos, &out[matched] );
+
+		matched++;
+	}
+
+	return matched;
+}
+
+
+/* End of the run of terms from pos on that start with the first length bytes of prefix ( galloping ) */
+static size_t Prefix_End( HASH_T *Hash_T, size_t pos, size_t total, const char *prefix, size_t length )
+{
+	size_t low = pos;               // known to start with the prefix
+	size_t step = 1;
+
+	while( low + step < total && strncmp( Term_Dict_Word( Hash_T, low + step ), prefix, length ) == 0 )
+	{
+		low += step;
+		step *= 2;
+	}
+
+	size_t high = low + step < total ? low + step : total;
+
+	while( high - low > 1 )
+	{
+		size_t middle = low + ( high - low ) / 2;
+
+		if( strncmp( Term_Dict_Word( Hash_T, middle ), prefix, length ) == 0 )
+			low = middle;
+		else
+			high = middle;
+	}
+
+	return high;
+}
+
+
+/**/
+int Auto_Fuzzy_Distance( const char *word )
+{
+	size_t length = strlen( word );
+
+	if( length <= 2 )
+		return 0;
+
+	return length <= 5 ? 1 : 2;
+}
+
+
+/**/
+size_t Expand_Fuzzy( HASH_T *Hash_T, const char *word, int distance, TERM_REF *out, int *out_distance, size_t max )
+{
+	// row[d][j]: edit distance between the first d bytes of the current term and word[0..j)
+	int row[MAX_WORD_LENGTH][MAX_WORD_LENGTH];
+
+	size_t m = strlen( word );
+	size_t total = Term_Dict_Size( Hash_T );
+	size_t matched = 0;
+	const char *previous = "";      // term whose prefix rows are in row[]
+	size_t valid = 0;               // rows 1..valid hold prefixes of previous
+
+	for( size_t j = 0; j <= m; j++ )
+		row[0][j] = ( int ) j;
+
+	size_t pos = 0;
+
+	while( pos < total && matched <= max )
+	{
+		const char *term = Term_Dict_Word( Hash_T, pos );
+		size_t depth = 0;
+
+		// Rows of a shared prefix are still good ( neighbours in sorted order share the most )
+		while( depth < valid && term[depth] == previous[depth] )
+			depth++;
+
+		previous = term;
+		valid = depth;
+
+		int dead = 0;
+
+		for( ; term[depth] != '\0' && !dead; depth++ )
+		{
+			int *above = row[depth];
+			int *next = row[ depth + 1 ];
+			int lowest;
+
+			next[0] = above[0] + 1;
+			lowest = next[0];
+
+			for( size_t j = 1; j <= m; j++ )
+			{
+				int cost = above[ j - 1 ] + ( term[depth] != word[ j - 1 ] );
+				int insert = next[ j - 1 ] + 1;
+				int remove = above[j] + 1;
+
+				next[j] = cost < insert ? cost : insert;
+				if( remove < next[j] )
+					next[j] = remove;
+
+				if( next[j] < lowest )
+					lowest = next[j];
+			}
+
+			valid = depth + 1;
+
+			// No extension of this prefix can come back within the distance
+			dead = lowest > distance;
+		}
+
+		if( dead )
+		{
+			pos = Prefix_End( Hash_T, pos, total, term, valid );
+			continue;
+		}
+
+		if( row[valid][m] <= distance )
+		{
+			if( matched < max )
+			{
+				Term_Dict_Ref( Hash_T, pos, &out[matched] );
+
+				if( out_distance != NULL )
+					out_distance[matched] = row[valid][m];
+			}
+
+			matched++;
+		}
+
+		pos++;
+	}
+
+	return matched;
+}
+
+
+/**/
+void Free_Term_Dict( HASH_T *Hash_T )
+{
+	free( Hash_T -> Dict.node );
+
+	Hash_T -> Dict.node = NULL;
+	Hash_T -> Dict.count = 0;
+	Hash_T -> Dict.capacity = 0;
+	Hash_T -> Dict.stale = 0;
+}
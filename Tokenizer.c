@@ -0,0 +1,251 @@
+/*******************************************************************************************************************************************************************
+ * File        : Tokenizer.c
+ * Project     : Inverted Search Engine (Project-2)
+ *
+ * Description :
+ *      Single-pass tokenizer used by Index_File(). The whole file is memory-mapped ( or, when
+ *      mmap is not possible, read in TOKEN_CHUNK_SIZE chunks ) and split on whitespace with a
+ *      byte classification table, replacing one locale-aware fscanf( "%s" ) call per token.
+ *
+ *      Tokens are delimited exactly as fscanf( "%s" ) delimits them in the C locale:
+ *      ' ', '\t', '\n', '\v', '\f', '\r'.
+ *
+ * Function Overview :
+ *
+ *      → Tokenize_File( FILE *fptr, TOKEN_SINK sink, void *context, TOKEN_STATS *stats )
+ *            • Calls sink( context, token ) for every token, NUL-terminated in a local buffer
+ *            • Tokens longer than MAX_WORD_LENGTH - 1 bytes are truncated and counted
+ *
+ *      → Set_Tokenizer_SIMD( int enable )
+ *            • Chooses the SSE2 classifier ( 16 bytes per step ) or the scalar table; the SIMD
+ *              path is only compiled where __SSE2__ is available
+ *
+ *      → Report_Tokenizer_Throughput( TOKEN_STATS *stats, double seconds )
+ *            • Prints bytes, tokens and MB/s for a build
+ *
+ * Notes :
+ *      • The SIMD setting is process wide and must be chosen before indexing threads start
+ *      • Stops early and returns FAILURE if the sink fails ( e.g. out of memory )
+ *
+ *******************************************************************************************************************************************************************/
+
+
+#include "Inverted_Search.h"
+#include "Types.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+
+static int Use_SIMD = 1;
+
+
+/* 1 for the fscanf( "%s" ) separators */
+static const unsigned char Is_Space[256] =
+{
+	[' '] = 1, ['\t'] = 1, ['\n'] = 1, ['\v'] = 1, ['\f'] = 1, ['\r'] = 1
+};
+
+
+/**/
+void Set_Tokenizer_SIMD( int enable )
+{
+	Use_SIMD = enable;
+}
+
+
+#ifdef __SSE2__
+/* Bit i set when p[i] is whitespace, for 16 bytes */
+static inline unsigned Space_Mask_16( const unsigned char *p )
+{
+	__m128i bytes = _mm_loadu_si128( ( const __m128i* ) p );
+
+	// '\t'..'\r' are 0x09..0x0D: ( byte - 0x09 ) <= 4 unsigned
+	__m128i shifted = _mm_sub_epi8( bytes, _mm_set1_epi8( 0x09 ) );
+	__m128i control = _mm_cmpeq_epi8( _mm_min_epu8( shifted, _mm_set1_epi8( 4 ) ), shifted );
+	__m128i blank = _mm_cmpeq_epi8( bytes, _mm_set1_epi8( ' ' ) );
+
+	return ( unsigned ) _mm_movemask_epi8( _mm_or_si128( control, blank ) );
+}
+#endif
+
+
+/* First position at or after p whose classification differs from want_space */
+static const unsigned char* Scan( const unsigned char *p, const unsigned char *end, int want_space )
+{
+#ifdef __SSE2__
+	if( Use_SIMD )
+	{
+		while( end - p >= 16 )
+		{
+			unsigned mask = Space_Mask_16( p );
+
+			if( want_space )
+				mask = ~mask & 0xFFFF;
+
+			if( mask != 0 )
+				return p + __builtin_ctz( mask );
+
+			p += 16;
+		}
+	}
+#endif
+
+	while( p < end && Is_Space[*p] == want_space )
+		p++;
+
+	return p;
+}
+
+
+/* Token being assembled; survives chunk boundaries */
+typedef struct Scan_State
+{
+	char token[MAX_WORD_LENGTH];
+	size_t length;
+	int in_token;
+	int truncated;
+
+} SCAN_STATE;
+
+
+/* Hand the finished token to the sink */
+static Status Emit_Token( SCAN_STATE *state, TOKEN_SINK sink, void *context, TOKEN_STATS *stats )
+{
+	state -> token[ state -> length ] = '\0';
+	state -> in_token = 0;
+
+	stats -> tokens++;
+	if( state -> truncated )
+		stats -> truncated++;
+
+	return sink( context, state -> token );
+}
+
+
+/* Split one buffer into tokens; a token reaching the buffer end stays open in state */
+static Status Tokenize_Buffer( const unsigned char *p, const unsigned char *end, SCAN_STATE *state,
+                               TOKEN_SINK sink, void *context, TOKEN_STATS *stats )
+{
+	while( p < end )
+	{
+		if( !state -> in_token )
+		{
+			p = Scan( p, end, 1 );
+			if( p == end )
+				break;
+
+			state -> in_token = 1;
+			state -> length = 0;
+			state -> truncated = 0;
+		}
+
+		const unsigned char *stop = Scan( p, end, 0 );
+		size_t length = stop - p;
+		size_t room = MAX_WORD_LENGTH - 1 - state -> length;
+
+		if( length > room )
+		{
+			length = room;
+			state -> truncated = 1;
+		}
+
+		memcpy( state -> token + state -> length, p, length );
+		state -> length += length;
+		p = stop;
+
+		if( stop == end )
+			break;          // the token may continue in the next chunk
+
+		if( Emit_Token( state, sink, context, stats ) == FAILURE )
+			return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+
+/**/
+Status Tokenize_File( FILE *fptr, TOKEN_SINK sink, void *context, TOKEN_STATS *stats )
+{
+	int fd = fileno( fptr );
+	struct stat info;
+	SCAN_STATE state;
+	Status status = SUCCESS;
+
+	state.in_token = 0;
+
+	if( fd >= 0 && fstat( fd, &info ) == 0 && S_ISREG( info.st_mode ) )
+	{
+		if( info.st_size == 0 )
+			return SUCCESS;
+
+		void *base = mmap( NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+		if( base != MAP_FAILED )
+		{
+			madvise( base, info.st_size, MADV_SEQUENTIAL );
+
+			const unsigned char *p = base;
+			status = Tokenize_Buffer( p, p + info.st_size, &state, sink, context, stats );
+
+			munmap( base, info.st_size );
+			stats -> bytes += info.st_size;
+
+			if( status == SUCCESS && state.in_token )
+				status = Emit_Token( &state, sink, context, stats );
+
+			return status;
+		}
+	}
+
+	// Not mappable ( pipe, special file ): stream through a large buffer
+	unsigned char *chunk = malloc( TOKEN_CHUNK_SIZE );
+	if( chunk == NULL )
+		return FAILURE;
+
+	rewind( fptr );
+
+	size_t got;
+
+	while( status == SUCCESS && ( got = fread( chunk, 1, TOKEN_CHUNK_SIZE, fptr ) ) > 0 )
+	{
+		stats -> bytes += got;
+		status = Tokenize_Buffer( chunk, chunk + got, &state, sink, context, stats );
+	}
+
+	if( status == SUCCESS && state.in_token )
+		status = Emit_Token( &state, sink, context, stats );
+
+	free( chunk );
+	return status;
+}
+
+
+/**/
+void Report_Tokenizer_Throughput( TOKEN_STATS *stats, double seconds )
+{
+	double megabytes = stats -> bytes / ( 1024.0 * 1024.0 );
+
+	printf("\n[INFO]: Tokenized %.2f MB, %zu tokens in %.3f s ( %.1f MB/s, %s )\n",
+			megabytes,
+			stats -> tokens,
+			seconds,
+			seconds > 0 ? megabytes / seconds : 0.0,
+#ifdef __SSE2__
+			Use_SIMD ? "SSE2" : "scalar" );
+#else
+			"scalar" );
+#endif
+
+	if( stats -> dropped > 0 )
+		printf("[INFO]: %zu token%s dropped by normalization\n", stats -> dropped, stats -> dropped > 1 ? "s" : "" );
+
+	if( stats -> truncated > 0 )
+		printf("[INFO]: %zu token%s longer than %d bytes truncated\n",
+				stats -> truncated, stats -> truncated > 1 ? "s" : "", MAX_WORD_LENGTH - 1 );
+}
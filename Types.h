@@ -4,9 +4,54 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <sys/types.h>
 #define FILENAME_MAX 4096
 #define MAX_WORD_LENGTH 100
 
+#define LETTER_GROUPS 27            // a-z + one group for digits/symbols (display & save order)
+#define HASH_INITIAL_SIZE 1024      // must be a power of two
+#define HASH_MAX_LOAD 1             // grow when words per bucket exceeds this
+#define HASH_REHASH_STEP 4          // old buckets migrated per table operation while resizing
+#define DOC_INITIAL_SIZE 64         // document table slots, must be a power of two
+#define ARENA_BLOCK_SIZE ( 1 << 20 )  // bytes per arena block
+#define ARENA_ALIGN 8
+#define POSTING_MAX_BYTES 15        // varint doc delta (5) + varint word count (10)
+#define POSTING_SKIP_INTERVAL 64    // postings between skip entries of a long frozen list
+#define POSITION_MAX_BYTES 10       // varint token position delta
+#define POSITION_INITIAL_BYTES 16   // first position buffer of a positional SUB_NODE
+
+#define BM25_K1 1.2                 // term frequency saturation
+#define BM25_B 0.75                 // document length normalisation
+#define RANK_DEFAULT_K 10           // results of a ranked search
+
+#define TERM_EXPANSION_MAX 1024     // terms one wildcard / range / fuzzy query word may expand to
+#define FUZZY_MAX_DISTANCE 2        // largest k of a word~k query
+#define FUZZY_SUGGESTIONS 5         // "did you mean" terms printed for a missing word
+
+#define CORPUS_QUEUE_SIZE 256       // discovered paths waiting for the indexer
+#define BUILD_BATCH_FILES 64        // files indexed into one partial index by a -j N build worker
+#define BUILD_BATCH_BYTES ( 1 << 20 )  // a batch is handed out once its files reach this size
+#define CORPUS_DEFAULT_INCLUDE "*.txt"  // --include: file name patterns, comma separated
+#define SHARD_FEED_SIZE 64          // files queued per shard while a sharded index is built
+#define SHARD_OPEN_FILES 256        // opened files queued across all shards, whatever their count
+#define SEGMENT_DEFAULT_DOCS 64     // --segment-docs: documents per segment published while serving
+#define SEGMENT_MERGE_FANIN 4       // segments of one tier merged into one by the background merger
+#define SAVE_SECTIONS 64            // term ranges of a full save, parsed side by side by a -j N load
+
+#define TOKEN_CHUNK_SIZE ( 1 << 20 )  // read size when a file cannot be mapped
+
+#define NORM_FOLD_CASE   0x1        // normalization stages (Normalize.c), also kept in INDEX_HEADER.flags
+#define NORM_STRIP_PUNCT 0x2
+#define NORM_STEM        0x4
+#define NORM_STOPWORDS   0x8
+#define NORM_DEFAULT ( NORM_FOLD_CASE | NORM_STRIP_PUNCT )
+
+#define INDEX_POSITIONAL 0x100      // INDEX_HEADER.flags: postings carry token positions
+
+#define INDEX_MAGIC "INVSRCH"       // binary index file signature (8 bytes with NUL)
+#define INDEX_VERSION 2            // 2: skip tables in front of long posting lists
+
 typedef enum{
     FAILURE,
     SUCCESS,
@@ -24,6 +69,8 @@ typedef void DISPLAY;
 typedef char FILE_NAME[FILENAME_MAX];
 typedef long int No_Of_Files;
 typedef long int Word_Count;
+typedef unsigned long HASH_VALUE;
+typedef unsigned int DOC_ID;
 
 
 typedef struct node{
@@ -34,29 +81,420 @@ typedef struct node{
 } LIST;
 
 
+typedef struct Build_Options
+{
+    int threads;                            // indexing threads, 1 = sequential
+    int simd;                               // SSE2 whitespace classifier in the tokenizer
+    unsigned normalize;                     // NORM_* stages applied to terms
+    const char *stopwords;                  // stopword list file, NULL for none
+    int positions;                          // keep token positions for phrase / NEAR queries
+    const char *include;                    // file name patterns indexed ( Check_Ext, directory walks )
+    int shards;                             // document-partitioned tables of a batch index, 1 = one table
+
+} BUILD_OPTIONS;
+
+
+typedef struct Corpus CORPUS;               // streaming file discovery ( Corpus.c )
+
+typedef struct Index_Writer INDEX_WRITER;   // binary index written term by term ( Binary_Index.c )
+
+typedef struct Segment_Index SEGMENT_INDEX; // published segments read while documents are added ( Segment_Index.c )
+
+typedef struct Snapshot SNAPSHOT;           // the segments one reader sees
+
+
+typedef struct Token_Stats
+{
+    size_t bytes;
+    size_t tokens;
+    size_t truncated;                       // tokens cut to MAX_WORD_LENGTH - 1 bytes
+    size_t dropped;                         // tokens removed by normalization ( stopwords, punctuation )
+
+} TOKEN_STATS;
+
+
+typedef Status ( *TOKEN_SINK )( void *context, char *token );
+
+
 typedef struct Sub_Node{
-    FILE_NAME File_name;
+    DOC_ID doc_id;
     Word_Count word_count;
     struct Sub_Node *link;
 
 } SUB_NODE;
 
 
+/* SUB_NODE of a positional table; only allocated when HASH_T.Positional is set */
+typedef struct Pos_Sub_Node{
+    SUB_NODE sub;                           // must stay first
+    unsigned char *positions;               // varint position deltas, word_count of them
+    unsigned int positions_len;
+    unsigned int positions_capacity;
+    unsigned long last_position;
+
+} POS_SUB_NODE;
+
+
 typedef struct Main_Node{
-    WORD word;
     No_Of_Files file_count;
+    HASH_VALUE hash_value;
     struct Sub_Node *Next_Sub_node;
-    struct Main_Node *Next_Main_node;
+    struct Sub_Node *Last_Sub_node;         // tail of the posting chain
+    struct Main_Node *Next_Main_node;       // next word in the same letter group
+    struct Main_Node *Next_Hash_node;       // next word in the same hash bucket
+    unsigned char *Postings;                // frozen form: varint (doc delta, count) pairs
+    unsigned int Postings_len;
+    unsigned int Postings_count;            // postings in the frozen bytes; later doc ids chain after them
+    char word[];                            // sized to the word when allocated from the arena
 
 } MAIN_NODE;
 
 
-typedef struct Hash_Table
+/* Frozen lists with more than POSTING_SKIP_INTERVAL postings start with a table of these */
+typedef struct Posting_Skip
+{
+    uint32_t last_doc;                      // doc id of the posting just before the jump target
+    uint32_t offset;                        // byte offset of the target, after the skip table
+
+} POSTING_SKIP;
+
+
+typedef struct Posting_Iter
+{
+    struct Sub_Node *sub;                   // chain form
+    const unsigned char *pos;               // frozen form
+    const unsigned char *end;
+
+    const unsigned char *data;              // first posting, after the skip table
+    const unsigned char *skip;              // POSTING_SKIP entries ( unaligned ), skip_count of them
+    unsigned long skip_count;
+    unsigned long index;                    // postings consumed so far
+    int positional;                         // postings carry positions
+
+    DOC_ID doc_id;
+    Word_Count word_count;
+    const unsigned char *positions;         // positional: word_count varint position deltas
+    const struct Doc_Table *docs;           // postings of deleted documents are skipped, NULL = none
+    DOC_ID doc_limit;                       // mapped list: a doc id at or past it ends the list, 0 = unchecked
+
+} POSTING_ITER;
+
+
+typedef struct Term_Ref
+{
+    const char *word;
+    No_Of_Files file_count;
+
+    struct Main_Node *node;                 // heap term, NULL for a mapped term
+    const unsigned char *postings;          // mapped term: frozen bytes inside the mapping
+    unsigned int postings_len;
+    int positional;                         // postings carry token positions
+    const struct Doc_Table *docs;           // tombstones to skip ( Doc_Tombstones() ), NULL = none
+    DOC_ID doc_limit;                       // mapped term: documents in the index, 0 = unchecked
+
+} TERM_REF;
+
+
+/* On-disk layout of a binary index (Binary_Index.c) */
+typedef struct Index_Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;                         // NORM_* stages the terms were normalized with
+
+    uint64_t doc_count;
+    uint64_t term_count;
+
+    uint64_t doc_offset;                    // uint64 name offsets[doc_count] + names
+    uint64_t doc_size;
+    uint64_t term_offset;                   // TERM_ENTRY[term_count] + words
+    uint64_t term_size;
+    uint64_t post_offset;                   // frozen posting arrays back to back
+    uint64_t post_size;
+
+    uint32_t doc_crc;
+    uint32_t term_crc;
+    uint32_t post_crc;
+    uint32_t header_crc;                    // computed with this field set to 0
+
+} INDEX_HEADER;
+
+
+typedef struct Term_Entry
+{
+    uint64_t word_offset;                   // from the start of the word pool
+    uint64_t post_offset;                   // from the start of the postings section
+    uint32_t post_len;
+    uint32_t file_count;
+
+} TERM_ENTRY;
+
+
+typedef struct Mapped_Index
+{
+    void *base;
+    size_t length;
+
+    const INDEX_HEADER *header;
+    const TERM_ENTRY *term;
+    const char *words;
+    const unsigned char *postings;
+
+    int materialised;                       // terms copied into the heap table, map kept for postings
+
+} MAPPED_INDEX;
+
+
+typedef struct Term_Cursor
+{
+    struct Hash_Table *table;
+    int group;
+    struct Main_Node *node;
+    uint64_t pos;
+
+} TERM_CURSOR;
+
+
+typedef struct Arena_Block
+{
+    struct Arena_Block *next;
+    size_t used;
+    size_t size;
+    unsigned char data[];
+
+} ARENA_BLOCK;
+
+
+typedef struct Arena
+{
+    ARENA_BLOCK *head;
+    size_t block_size;
+    size_t align;
+
+    size_t alloc_count;
+    size_t bytes_used;
+    size_t bytes_reserved;
+    size_t block_count;
+
+} ARENA;
+
+
+typedef struct Letter_Group
 {
     int index;
     struct Main_Node *link;
+    struct Main_Node *tail;
+
+} LETTER_GROUP;
+
+
+typedef struct Doc_Entry
+{
+    char *name;
+    HASH_VALUE hash_value;
+    Word_Count length;                      // terms indexed from the document ( BM25 )
+    unsigned int version;                   // 1 when first indexed, +1 per re-index of the same name
+    int deleted;                            // tombstone: postings stay until Compact_Index()
+
+    dev_t dev;                              // file identity, valid when identified
+    ino_t ino;
+    int identified;
+
+} DOC_ENTRY;
+
+
+typedef struct Doc_Table
+{
+    DOC_ENTRY *doc;                         // indexed by DOC_ID
+    size_t count;
+    size_t capacity;
+    size_t deleted;                         // tombstoned entries, live documents = count - deleted
+
+    DOC_ID *slot;                           // open addressing on name, stores id + 1 (0 = empty)
+    DOC_ID *ident_slot;                     // open addressing on ( dev, ino ), same size and encoding
+    size_t slot_size;
+    size_t resolved;                        // entries below it have had their identity looked up
+
+    Word_Count total_length;                // sum of every live document length
+    int lengths_stale;                      // set after a load; lengths are rebuilt from postings
+
+} DOC_TABLE;
+
+
+/* Heap terms in dictionary order (Term_Dict.c) */
+typedef struct Term_Dict
+{
+    struct Main_Node **node;                // sorted by Compare_Terms()
+    size_t count;
+    size_t capacity;
+    int stale;                              // a word was linked since the last build
+
+} TERM_DICT;
+
+
+/* A word given postings since the last save (Save_DataBase.c) */
+typedef struct Save_Change
+{
+    MAIN_NODE *node;
+    SUB_NODE *first;                        // first of those postings, used while the list is a chain
+
+} SAVE_CHANGE;
+
+
+/* Text save file the table was last saved to or loaded from (Save_DataBase.c) */
+typedef struct Save_Mark
+{
+    char *file;                             // NULL: no save in step with the table, next save is full
+    size_t docs;                            // doc ids below it are in the file
+    unsigned int generation;                // last generation written, 1 for a full save, 0 once compacted
+    long bytes;                             // file size then; anything else means it was changed
+    int logging;                            // changes go to the write-ahead log ( Write_Ahead_Log.c )
+    long torn;                              // bytes of an incomplete generation at the end, cut off by the next delta
+
+    SAVE_CHANGE *words;                     // words given postings since, each once, for the next delta
+    size_t word_count;
+    size_t word_capacity;
+    DOC_ID *removed;                        // saved documents removed or re-indexed since, each once
+    size_t removed_count;
+    size_t removed_capacity;
+    int lost;                               // a change could not be recorded: the next save is full
+
+} SAVE_MARK;
+
+
+typedef struct Hash_Table
+{
+    struct Main_Node **bucket;              // current bucket array
+    size_t size;
+
+    struct Main_Node **old_bucket;          // array being drained during a resize
+    size_t old_size;
+    size_t rehash_pos;
+
+    size_t word_total;
+    LETTER_GROUP Letter[LETTER_GROUPS];
+    TERM_DICT Dict;                         // sorted view of the words, rebuilt when stale
+
+    DOC_TABLE Docs;
+
+    ARENA Main_arena;                       // owns every MAIN_NODE
+    ARENA Sub_arena;                        // owns every SUB_NODE
+    ARENA Post_arena;                       // owns frozen posting arrays
+
+    MAPPED_INDEX *Mapped;                   // read-only binary index, NULL when not loaded
+
+    TOKEN_STATS Tokens;                     // tokenizer totals for files indexed into this table
+
+    int Positional;                         // postings carry token positions ( --positions )
+
+    SAVE_MARK Saved;                        // delta saves append to this file
 
 } HASH_T;
 
 
+/* Boolean query tree (Query.c) */
+typedef enum
+{
+    QUERY_TERM,
+    QUERY_AND,
+    QUERY_OR,
+    QUERY_NOT,
+    QUERY_PHRASE,                           // "a b c": terms at consecutive positions
+    QUERY_NEAR,                             // a NEAR/k b: terms at most k positions apart
+    QUERY_PATTERN,                          // inv*, in?ex: every term matching the wildcards
+    QUERY_RANGE,                            // apple..banana: every term in the inclusive range
+    QUERY_FUZZY                             // word~k: every term within edit distance k
+
+} QUERY_KIND;
+
+
+typedef struct Query_Node
+{
+    QUERY_KIND kind;
+    char *word;                             // QUERY_TERM / FUZZY: normalized term, QUERY_PATTERN: pattern
+
+    struct Query_Node *child;               // operands, linked through next
+    struct Query_Node *next;
+    int child_count;
+    unsigned long distance;                 // QUERY_NEAR / QUERY_FUZZY: k
+
+    char *upper;                            // QUERY_RANGE: last term ( word is the first ), "" = open
+    TERM_REF *terms;                        // QUERY_PATTERN / RANGE / FUZZY: expansion, dictionary order
+    size_t term_count;
+
+} QUERY_NODE;
+
+
+typedef struct Query
+{
+    ARENA arena;                            // owns every node and word of the query
+    QUERY_NODE *root;                       // NULL when the query held only stopwords
+    const char *error;                      // parse error message, NULL on success
+
+} QUERY;
+
+
+typedef struct Query_Result
+{
+    DOC_ID *doc;                            // matching documents, ascending
+    size_t count;
+    size_t capacity;                        // slots allocated in doc
+
+} QUERY_RESULT;
+
+
+typedef struct Rank_Hit
+{
+    DOC_ID doc_id;
+    double score;
+
+} RANK_HIT;
+
+
+typedef struct Rank_Result
+{
+    RANK_HIT *hit;                          // best first
+    size_t count;
+    size_t scored;                          // documents fully or partly scored
+
+} RANK_RESULT;
+
+
+typedef struct Rank_Scope
+{
+    HASH_T *table;                          // every shard of the index: df is summed over them
+    int count;
+    double documents;                       // live documents of all shards ( N )
+    double average;                         // their average length ( avgdl )
+
+} RANK_SCOPE;
+
+
+typedef struct Shard_Set
+{
+    HASH_T *shard;                          // document-partitioned tables, each a complete index
+    int count;
+    struct Shard_Pool *pool;                // one thread per shard ( Shard.c ), NULL for one table
+
+} SHARD_SET;
+
+
+typedef struct Shard_Hit
+{
+    int shard;
+    DOC_ID doc_id;                          // document of shard -> Docs
+    Word_Count word_count;                  // single-word queries
+    double score;                           // ranked queries
+
+} SHARD_HIT;
+
+
+typedef struct Shard_Result
+{
+    SHARD_HIT *hit;                         // in document order, best first when ranked
+    size_t count;
+
+} SHARD_RESULT;
+
+
 #endif
\ No newline at end of file
@@ -7,10 +7,34 @@
  *
  *          #index; word; file_count; filename1; count1; filename2; count2; ... #
  *
- *      For each entry, the function restores all MAIN_NODE and SUB_NODE relationships by inserting
- *      each occurrence into the hash table using Insert_To_Hash_Table().
+ *      For each entry, the function restores all MAIN_NODE and SUB_NODE relationships by adding
+ *      one posting per (word, file) with its saved count through Add_Posting(), so load time is
+ *      linear in the size of the save file rather than in the total number of occurrences.
+ *
+ *      A full save starts with "@documents; n; name; ... #", registered first so doc ids follow
+ *      the saved order, and "@sections; 64; offset0; ... offset64; #". When loading with more
+ *      than one thread ( -j N, Set_Load_Threads() ) the sections are parsed side by side: each
+ *      worker reads a claimed byte range with its own stream into a partial index, looking the
+ *      documents up read-only, and freezes it. The calling thread splices the partials into the
+ *      table in section order with Add_Frozen_Term(), the same ring of slots as Parallel_Build.c,
+ *      so the table equals that of a sequential load.
+ *
+ *      Delta saves ( Save_DataBase.c ) append generations to the file, each starting with
+ *
+ *          @generation; n; length; #          ( length: bytes of the generation after this line )
+ *
+ *      The length ( absent in files written before it was recorded ) tells whether the generation
+ *      was written completely. The generations are merged in file order: "@remove; filename; #" deletes a document of
+ *      an earlier generation ( removed or re-indexed since ), "@documents" registers the versions
+ *      added by the generation, even those without terms, and a document named again in a later
+ *      generation replaces the earlier one ( tombstoned, Live_Update.c ) instead of adding its
+ *      counts to it.
  *
  * Prototype        : Status Update_DataBase( HASH_T *H_Table, LIST **head );
+ *                    Status Load_DataBase_File( HASH_T *H_Table, const char *filename );
+ *                        → non-interactive loader used by Update_DataBase()
+ *                    void Set_Load_Threads( int threads );
+ *                        → -j setting ( Apply_Options() ); 1 reads the sections sequentially
  *
  * Input Parameters :
  *      H_Table  → Pointer to the hash table to be reinitialized and reconstructed
@@ -21,25 +45,48 @@
  *      FAILURE → If the file is missing or completely empty
  *
  * Special Notes    :
- *      • Hash table is always reset using Initialise_Hash_Table() before loading.
- *      • Duplicate prevention is not required because table is fresh on every load.
+ *      • Hash table is always released and reset using Free_Hash_Table() / Initialise_Hash_Table().
+ *      • The saved index column is informational; letter groups are recomputed from each word.
+ *      • Saved words pass through Normalize_Word(); words that become equal are merged and
+ *        stopwords are dropped.
+ *      • Duplicate prevention is not required because table is fresh on every load; within a
+ *        generation a ( word, file ) pair appears once, across generations the newest one wins.
+ *      • The table stays marked as in step with the file ( Set_Save_Mark() ), so the next
+ *        delta save appends to it.
  *      • Partial or malformed lines are ignored without stopping overall reconstruction.
- *      • Function does not rebuild original file list (`head`) since SUB_NODEs store names.
+ *      • A generation shorter than its header says, or a generation header without its newline,
+ *        was cut short by a crash: it is not applied and is reported, and the file is not
+ *        changed; the next delta save cuts it off before it appends ( SAVE_MARK.torn ). A last
+ *        line without its newline anywhere else ( base, older files ) is parsed as usual.
+ *      • A word split over two sections ( two saved spellings normalized to one term ) is
+ *        merged posting by posting; a section table that does not match the file is skipped
+ *        as a malformed record and the file is read sequentially.
+ *      • Memory of a parallel load is bounded by 2 × threads partial indexes. If a worker fails,
+ *        the partly merged table is dropped and the file is read again sequentially.
+ *      • The write-ahead log of the file ( filename.wal, Write_Ahead_Log.c ) is replayed last.
+ *      • Function does not rebuild original file list (`head`); filenames are re-registered
+ *        in the document table as they are read.
  *
  * Features         :
  *      • Allows choosing between default save file and custom filename.
- *      • Preserves file occurrence counts using repeated Insert_To_Hash_Table() calls.
+ *      • Preserves file occurrence counts by storing each saved count directly.
+ *      • Reads whole lines with getline(); a malformed line is skipped and counted.
  *      • Restores the inverted index into a usable state even with minor formatting issues.
  *
  * Limitations      :
  *      • Database is restored only from valid parsed tokens; no strict corruption detection.
- *      • Spacing and formatting must closely match Save_DataBase() output for proper parsing.
+ *      • Fields are ';' separated, so words / filenames containing ';' cannot be stored.
  *
  *******************************************************************************************************************************************************************/
 
 
 #include "Types.h"
 #include "Inverted_Search.h"
+#include <pthread.h>
+#include <unistd.h>
+
+
+static int Load_Threads = 1;
 
 
 Status  Update_DataBase( HASH_T* H_Table, LIST **head )
@@ -65,6 +112,401 @@ Status  Update_DataBase( HASH_T* H_Table, LIST **head )
 
     }
 
+    if( Load_DataBase_File( H_Table, filename ) == FAILURE )
+        return FAILURE;
+
+    Report_Memory_Usage( H_Table );
+    return SUCCESS;
+
+}
+
+
+/* Cut the next ';' separated field out of the line, skipping leading blanks */
+static char* Next_Field( char **cursor )
+{
+    char *field = *cursor;
+
+    while( *field == ' ' )
+        field++;
+
+    char *end = strchr( field, ';' );
+    if( end == NULL )
+        return NULL;
+
+    *end = '\0';
+    *cursor = end + 1;
+
+    return field;
+}
+
+
+/* Documents of earlier generations are replaced, not added to */
+typedef struct Load_State
+{
+    unsigned int generation;        // current generation, 1 until the first header
+    DOC_ID first;                   // first doc id registered in the current generation
+    long left;                      // bytes of the file after the current line
+    int torn;                       // the file ends inside the generation starting here
+
+    long offset[ SAVE_SECTIONS + 1 ];   // sections of the base, when it has a section table
+    int sections;                   // the section table was just read
+    int sequential;                 // section tables are read through, not loaded in parallel
+
+} LOAD_STATE;
+
+
+/* One section parsed into a partial index by a worker */
+typedef struct Load_Slot
+{
+    HASH_T partial;
+    long skipped;                   // malformed records of the section
+    int ready;
+    Status status;
+
+} LOAD_SLOT;
+
+
+typedef struct Section_Load
+{
+    HASH_T *H_Table;                // documents are looked up, never registered, while workers run
+    const char *filename;
+    const long *offset;
+
+    int next;                       // next section a worker will claim
+    int merged;                     // sections already merged by the calling thread
+
+    LOAD_SLOT *slot;
+    int ring;
+
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+
+} SECTION_LOAD;
+
+
+/**/
+void Set_Load_Threads( int threads )
+{
+    Load_Threads = threads;
+}
+
+
+/* "@sections; n; offset0; ... offsetn; #" of a full save, checked against the file */
+static Status Load_Section_Table( LOAD_STATE *state, const char *count, char *cursor, long size )
+{
+    if( strtol( count, NULL, 10 ) != SAVE_SECTIONS )
+        return FAILURE;
+
+    // The records start right after this line
+    long previous = size - state -> left;
+
+    for( int s = 0; s <= SAVE_SECTIONS; s++ )
+    {
+        char *field = Next_Field( &cursor );
+
+        if( field == NULL )
+            return FAILURE;
+
+        state -> offset[s] = strtol( field, NULL, 10 );
+
+        if( state -> offset[s] < previous || state -> offset[s] > size || ( s == 0 && state -> offset[s] != previous ) )
+            return FAILURE;
+
+        previous = state -> offset[s];
+    }
+
+    state -> sections = 1;
+    return SUCCESS;
+}
+
+
+/* "@generation; n; length; #", "@remove; filename; #", "@documents; n; name; ... #" or "@sections; ... #" */
+static Status Load_Save_Marker( HASH_T* H_Table, LOAD_STATE *state, char *line, long size )
+{
+    char *cursor = line;
+
+    char *marker = Next_Field( &cursor );
+    char *value = Next_Field( &cursor );
+
+    if( marker == NULL || value == NULL )
+        return FAILURE;
+
+    if( strcmp( marker, "@generation" ) == 0 )
+    {
+        unsigned int generation = strtoul( value, NULL, 10 );
+
+        if( generation <= state -> generation )
+            return FAILURE;
+
+        // The length is missing only in files written before it was recorded
+        char *length = Next_Field( &cursor );
+
+        if( length != NULL && strtol( length, NULL, 10 ) > state -> left )
+        {
+            state -> torn = 1;
+            return SUCCESS;
+        }
+
+        state -> generation = generation;
+        state -> first = H_Table -> Docs.count;
+        return SUCCESS;
+    }
+
+    if( strcmp( marker, "@documents" ) == 0 )
+    {
+        size_t count = strtoul( value, NULL, 10 );
+        DOC_ID doc_id;
+
+        // Registered up front, in the doc id order they were saved with
+        for( size_t i = 0; i < count; i++ )
+        {
+            char *name = Next_Field( &cursor );
+
+            if( name == NULL || Register_Document( &H_Table -> Docs, name, &doc_id ) == FAILURE )
+                return FAILURE;
+        }
+
+        return SUCCESS;
+    }
+
+    // Only a -j N load makes use of the sections; a sequential one reads on through them
+    if( strcmp( marker, "@sections" ) == 0 )
+        return Load_Threads > 1 && !state -> sequential ? Load_Section_Table( state, value, cursor, size ) : SUCCESS;
+
+    if( strcmp( marker, "@remove" ) == 0 )
+    {
+        DOC_ID doc_id;
+
+        // Already absent when an earlier delta removed it too
+        if( Find_Document( &H_Table -> Docs, value, &doc_id ) == EXISTS )
+            Delete_Document( &H_Table -> Docs, doc_id );
+
+        return SUCCESS;
+    }
+
+    return FAILURE;
+}
+
+
+/* Parse one "#index; word; file_count; name; count; ... #" record and add it in bulk; with a partial,
+   documents are only looked up in H_Table ( "@documents" ) and the postings go to the partial */
+static Status Load_Save_Record( HASH_T* H_Table, LOAD_STATE *state, char *line, HASH_T *partial )
+{
+    char *cursor = line;
+
+    char *index = Next_Field( &cursor );
+    char *word = Next_Field( &cursor );
+    char *count_field = Next_Field( &cursor );
+
+    if( index == NULL || word == NULL || count_field == NULL || index[0] != '#' || word[0] == '\0' )
+        return FAILURE;
+
+    // Saved words are normalized again so older save files join the current vocabulary
+    WORD term;
+    if( Normalize_Word( word, term ) != SUCCESS )
+        return SUCCESS;
+
+    No_Of_Files file_count = strtol( count_field, NULL, 10 );
+
+    for( No_Of_Files i = 0; i < file_count; i++ )
+    {
+        char *file_name = Next_Field( &cursor );
+        char *word_field = Next_Field( &cursor );
+
+        if( file_name == NULL || word_field == NULL )
+            return FAILURE;
+
+        Word_Count word_count = strtol( word_field, NULL, 10 );
+        if( word_count <= 0 )
+            continue;
+
+        DOC_ID doc_id;
+
+        if( partial != NULL )
+        {
+            if( Find_Document( &H_Table -> Docs, file_name, &doc_id ) == NOT_EXISTS || Add_Posting( partial, term, doc_id, word_count ) == FAILURE )
+                return FAILURE;
+
+            continue;
+        }
+
+        // A document saved again by a later generation starts over under a new version
+        if( state -> first > 0 && Find_Document( &H_Table -> Docs, file_name, &doc_id ) == EXISTS && doc_id < state -> first )
+            Delete_Document( &H_Table -> Docs, doc_id );
+
+        if( Register_Document( &H_Table -> Docs, file_name, &doc_id ) == FAILURE )
+            return FAILURE;
+
+        // One posting with its saved count, instead of word_count separate inserts
+        if( Add_Posting( H_Table, term, doc_id, word_count ) == FAILURE )
+            return FAILURE;
+    }
+
+    return SUCCESS;
+}
+
+
+/* Worker: parse claimed sections into partial indexes, no further ahead of the merge than the ring */
+static void* Section_Worker( void *arg )
+{
+    SECTION_LOAD *load = arg;
+
+    FILE *fptr = fopen( load -> filename, "r" );
+    char *line = NULL;
+    size_t line_size = 0;
+
+    pthread_mutex_lock( &load -> lock );
+
+    while( load -> next < SAVE_SECTIONS )
+    {
+        if( load -> next == load -> merged + load -> ring )
+        {
+            pthread_cond_wait( &load -> changed, &load -> lock );
+            continue;
+        }
+
+        int s = load -> next++;
+        pthread_mutex_unlock( &load -> lock );
+
+        LOAD_SLOT *slot = &load -> slot[ s % load -> ring ];
+        long position = load -> offset[s];
+        ssize_t length;
+
+        slot -> skipped = 0;
+        slot -> status = Initialise_Hash_Table( &slot -> partial );
+
+        if( fptr == NULL || fseek( fptr, position, SEEK_SET ) != 0 )
+            slot -> status = FAILURE;
+
+        while( slot -> status == SUCCESS && position < load -> offset[ s + 1 ] && ( length = getline( &line, &line_size, fptr ) ) != -1 )
+        {
+            position += length;
+
+            if( Load_Save_Record( load -> H_Table, NULL, line, &slot -> partial ) == FAILURE )
+                slot -> skipped++;
+        }
+
+        // Frozen, the section's words are copied into the table as they are
+        if( slot -> status == SUCCESS )
+            slot -> status = Freeze_Hash_Table( &slot -> partial );
+
+        pthread_mutex_lock( &load -> lock );
+        slot -> ready = 1;
+        pthread_cond_broadcast( &load -> changed );
+    }
+
+    pthread_mutex_unlock( &load -> lock );
+
+    free( line );
+    if( fptr != NULL )
+        fclose( fptr );
+
+    return NULL;
+}
+
+
+/* Add the words of one section; a word already present came from another saved spelling */
+static Status Merge_Section( HASH_T* H_Table, HASH_T *partial )
+{
+    TERM_CURSOR cursor;
+    TERM_REF term;
+    INDEX group;
+    Status status = SUCCESS;
+
+    Term_Cursor_Init( &cursor, partial );
+
+    while( status == SUCCESS && Term_Cursor_Next( &cursor, &term, &group ) == SUCCESS )
+    {
+        if( Find_Main_Node( H_Table, term.word ) == NULL )
+        {
+            status = Add_Frozen_Term( H_Table, term.word, term.node -> Postings, term.node -> Postings_len, term.file_count );
+            continue;
+        }
+
+        POSTING_ITER it;
+        Posting_Iter_Init_Term( &it, &term );
+
+        while( status == SUCCESS && Posting_Iter_Next( &it ) == SUCCESS )
+            status = Add_Posting( H_Table, ( char* ) term.word, it.doc_id, it.word_count );
+    }
+
+    return status;
+}
+
+
+/* Parse the sections of the base on Load_Threads workers and merge them in file order; malformed records */
+static long Load_Sections( HASH_T* H_Table, const char *filename, const long *offset )
+{
+    SECTION_LOAD load;
+    load.H_Table = H_Table;
+    load.filename = filename;
+    load.offset = offset;
+    load.next = 0;
+    load.merged = 0;
+    load.ring = 2 * Load_Threads;
+    load.slot = calloc( load.ring, sizeof( LOAD_SLOT ) );
+
+    pthread_t *worker = malloc( Load_Threads * sizeof( pthread_t ) );
+    int started = 0;
+
+    if( load.slot == NULL || worker == NULL )
+    {
+        perror("Malloc failed for parallel load");
+        free( load.slot );
+        free( worker );
+        return -1;
+    }
+
+    pthread_mutex_init( &load.lock, NULL );
+    pthread_cond_init( &load.changed, NULL );
+
+    for( int i = 0; i < Load_Threads; i++ )
+    {
+        if( pthread_create( &worker[i], NULL, Section_Worker, &load ) == 0 )
+            started++;
+    }
+
+    long skipped = started == 0 ? -1 : 0;
+
+    // Sections are merged in file order, so words keep the order a sequential load gives them
+    for( int s = 0; started > 0 && s < SAVE_SECTIONS; s++ )
+    {
+        LOAD_SLOT *slot = &load.slot[ s % load.ring ];
+
+        pthread_mutex_lock( &load.lock );
+        while( !slot -> ready )
+            pthread_cond_wait( &load.changed, &load.lock );
+        pthread_mutex_unlock( &load.lock );
+
+        if( skipped >= 0 && ( slot -> status == FAILURE || Merge_Section( H_Table, &slot -> partial ) == FAILURE ) )
+            skipped = -1;
+        else if( skipped >= 0 )
+            skipped += slot -> skipped;
+
+        Free_Hash_Table( &slot -> partial );
+
+        pthread_mutex_lock( &load.lock );
+        slot -> ready = 0;
+        load.merged++;
+        pthread_cond_broadcast( &load.changed );
+        pthread_mutex_unlock( &load.lock );
+    }
+
+    for( int i = 0; i < started; i++ )
+        pthread_join( worker[i], NULL );
+
+    pthread_mutex_destroy( &load.lock );
+    pthread_cond_destroy( &load.changed );
+    free( worker );
+    free( load.slot );
+
+    return skipped;
+}
+
+
+/**/
+Status Load_DataBase_File( HASH_T* H_Table, const char *filename )
+{
     FILE *fptr = fopen( filename, "r" );
     if( fptr == NULL )
     {
@@ -73,7 +515,9 @@ Status  Update_DataBase( HASH_T* H_Table, LIST **head )
     }
 
     fseek( fptr, 0, SEEK_END );
-    if( ftell( fptr ) == 0 )
+    long size = ftell( fptr );
+
+    if( size == 0 )
     {
         printf("\n[INFO]: '%s' is Empty. Nothing to load.\n", filename );
         fclose( fptr );
@@ -81,33 +525,100 @@ Status  Update_DataBase( HASH_T* H_Table, LIST **head )
     }
     rewind( fptr );
 
-    Initialise_Hash_Table( H_Table );
+    Free_Hash_Table( H_Table );
+    if( Initialise_Hash_Table( H_Table ) == FAILURE )
+    {
+        fclose( fptr );
+        return FAILURE;
+    }
 
-    INDEX index;
-    WORD word;
-    No_Of_Files file_count;
-    FILE_NAME file_name;
-    Word_Count word_count;
+    char *line = NULL;
+    size_t line_size = 0;
+    long skipped = 0;
+    long valid = size;
+    ssize_t length;
+    LOAD_STATE state = { .generation = 1 };
 
-    while( fscanf( fptr, "#%d; %[^;]; %ld;", &index, word, &file_count ) == 3 )
+    while( ( length = getline( &line, &line_size, fptr ) ) != -1 )
     {
+        state.left = size - ftell( fptr );
+
+        // Only a generation can be torn: its header gives its length ( Load_Save_Marker() ), and a
+        // header without its newline was itself being appended; any other last line is parsed
+        if( line[ length - 1 ] != '\n' && strncmp( line, "@generation", 11 ) == 0 )
+            state.torn = 1;
+
+        Status status = state.torn ? SUCCESS : line[0] == '@' ? Load_Save_Marker( H_Table, &state, line, size ) : Load_Save_Record( H_Table, &state, line, NULL );
 
-        for( No_Of_Files i = 0; i < file_count; i++ )
+        if( state.torn )
         {
-            if( fscanf( fptr, " %[^;]; %ld;", file_name, &word_count ) != 2 )
-                break;
-            
-            for( Word_Count j = 0; j < word_count; j++ )
-                Insert_To_Hash_Table( index, word, file_name, H_Table );
+            valid = size - state.left - length;
+            break;
         }
 
-        fscanf(fptr, " #\n");
+        if( status == FAILURE )
+            skipped++;
 
+        // The base is parsed side by side, then the generations after it are read on from its end
+        if( state.sections )
+        {
+            long section_skipped = Load_Sections( H_Table, filename, state.offset );
+
+            // Nothing of a half-merged table is kept: the file is read again from the start, sequentially
+            if( section_skipped < 0 )
+            {
+                printf("\n[INFO]: Parallel load of '%s' failed, reading it sequentially\n", filename );
+
+                Free_Hash_Table( H_Table );
+                if( Initialise_Hash_Table( H_Table ) == FAILURE )
+                {
+                    free( line );
+                    fclose( fptr );
+                    return FAILURE;
+                }
+
+                state = ( LOAD_STATE ) { .generation = 1, .sequential = 1 };
+                skipped = 0;
+                rewind( fptr );
+                continue;
+            }
+
+            skipped += section_skipped;
+            state.sections = 0;
+            fseek( fptr, state.offset[ SAVE_SECTIONS ], SEEK_SET );
+        }
     }
 
+    free( line );
     fclose( fptr );
-    
-    printf("\n[INFO]: Database successfully loaded from '%s'\n\n", filename );
-    return SUCCESS;
 
-}
\ No newline at end of file
+    // Nothing of the torn generation was applied; the file is left as it is until a save replaces it
+    if( valid < size )
+        printf("\n[INFO]: Incomplete save of %ld bytes at the end of '%s' ignored\n", size - valid, filename );
+
+    if( skipped > 0 )
+        printf("\n[INFO]: %ld malformed record%s skipped\n", skipped, skipped > 1 ? "s" : "" );
+
+    // Save files carry no document lengths; ranking rebuilds them from the postings
+    H_Table -> Docs.lengths_stale = 1;
+
+    // Delta saves append to what was just read
+    if( skipped == 0 )
+    {
+        Set_Save_Mark( H_Table, filename, state.generation );
+
+        // The next delta cuts the torn generation off before it appends
+        if( H_Table -> Saved.file != NULL )
+            H_Table -> Saved.torn = size - valid;
+    }
+
+    if( state.generation > 1 )
+        printf("\n[INFO]: %u generations merged, %zu replaced or removed document%s\n",
+               state.generation, H_Table -> Docs.deleted, H_Table -> Docs.deleted == 1 ? "" : "s" );
+
+    printf("\n[INFO]: Database successfully loaded from '%s'\n", filename );
+
+    // Changes made since the last save ( Write_Ahead_Log.c ), after the mark so the next delta has them
+    return Replay_Document_Log( H_Table, filename );
+
+}
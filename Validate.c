@@ -5,13 +5,21 @@
  *      Validates all command-line input files before adding them to the active file list.
  *      Each file must pass the following checks in order:
  *
- *          1. Check_Ext()      → Validates that the file has a ".txt" extension (case-sensitive)
+ *          1. Check_Ext()      → Validates that the file name matches --include ( "*.txt" by default,
+ *                                case-sensitive )
  *          2. Check_Avail()    → Ensures the file exists and is readable
  *          3. Check_Content()  → Confirms the file is not empty
- *          4. No_Duplicate()   → Prevents adding a file already present in the list
+ *          4. No_Duplicate()   → Prevents adding a file already present in the list, by name or by
+ *                                file identity ( a symlink, hard link or other path to the same file )
  *
- *      If a file clears all checks, it is appended to the LIST using Add_To_List(),
- *      and its file pointer remains open for later database creation.
+ *      If a file clears all checks, it is appended to the LIST using Add_To_List() and closed
+ *      again: files are opened only while they are indexed, so any number of files can be listed.
+ *
+ *      A directory is listed as it is; Create_DataBase() walks it recursively when the database
+ *      is created (Corpus.c) and applies the same checks to every file found.
+ *
+ *      Files already listed are kept in a document table (Doc_Table.c), so the duplicate check and
+ *      the append ( at the tail, not after a walk of the list ) take constant time per file.
  *
  * Prototype        : Status Read_and_Validate( int argc, char *argv[], LIST **head );
  *
@@ -29,6 +37,14 @@
  *                    • Prints descriptive messages for each validation outcome.
  *                    • Automatically closes file pointers for invalid files, preventing leaks.
  *
+ * Options          : Read_Options() runs first and removes "-j N" / "--threads N" (indexing threads,
+ *                    0 = one per CPU), "--no-simd" (scalar tokenizer) and the normalization flags
+ *                    "--raw", "--keep-case", "--keep-punct", "--stem", "--stopwords FILE", and
+ *                    "--positions" (token positions for phrase / NEAR queries) and
+ *                    "--include PATTERNS" (file name patterns such as "*.txt,*.md", matched by
+ *                    fnmatch() against the base name) and "--shards N" (document-partitioned
+ *                    batch index, Shard.c) so that only filenames are validated here.
+ *
  * Special Cases    :
  *                    • If fewer than 2 arguments → Program prints error and exits immediately.
  *                    • If all files fail validation → *head remains NULL*, but SUCCESS still returned.
@@ -41,6 +57,124 @@
 #include "Inverted_Search.h"
 #include <string.h>
 #include <stdlib.h>
+#include <unistd.h>
+#include <fnmatch.h>
+#include <sys/stat.h>
+
+
+static const char *Include = CORPUS_DEFAULT_INCLUDE;
+
+/* Strip option flags from argv so only filenames reach Read_and_Validate() */
+Status Read_Options( int *argc, char* argv[], BUILD_OPTIONS *options )
+{
+    options -> threads = 1;
+    options -> simd = 1;
+    options -> normalize = NORM_DEFAULT;
+    options -> stopwords = NULL;
+    options -> positions = 0;
+    options -> include = CORPUS_DEFAULT_INCLUDE;
+    options -> shards = 1;
+
+    int kept = 1;
+
+    for( int i = 1; i < *argc; i++ )
+    {
+        if( ( strcmp( argv[i], "-j" ) == 0 || strcmp( argv[i], "--threads" ) == 0 ) && i + 1 < *argc )
+        {
+            options -> threads = atoi( argv[++i] );
+
+            // -j 0 → one thread per online CPU
+            if( options -> threads <= 0 )
+            {
+                long cpus = sysconf( _SC_NPROCESSORS_ONLN );
+                options -> threads = cpus > 0 ? ( int ) cpus : 1;
+            }
+
+            continue;
+        }
+
+        if( strcmp( argv[i], "--no-simd" ) == 0 )
+        {
+            options -> simd = 0;
+            continue;
+        }
+
+        // Normalization stages ( Normalize.c )
+        if( strcmp( argv[i], "--raw" ) == 0 )
+        {
+            options -> normalize = 0;
+            continue;
+        }
+
+        if( strcmp( argv[i], "--keep-case" ) == 0 )
+        {
+            options -> normalize &= ~NORM_FOLD_CASE;
+            continue;
+        }
+
+        if( strcmp( argv[i], "--keep-punct" ) == 0 )
+        {
+            options -> normalize &= ~NORM_STRIP_PUNCT;
+            continue;
+        }
+
+        if( strcmp( argv[i], "--stem" ) == 0 )
+        {
+            options -> normalize |= NORM_STEM;
+            continue;
+        }
+
+        if( strcmp( argv[i], "--stopwords" ) == 0 && i + 1 < *argc )
+        {
+            options -> stopwords = argv[++i];
+            continue;
+        }
+
+        if( strcmp( argv[i], "--positions" ) == 0 )
+        {
+            options -> positions = 1;
+            continue;
+        }
+
+        if( strcmp( argv[i], "--shards" ) == 0 && i + 1 < *argc )
+        {
+            options -> shards = atoi( argv[++i] );
+
+            if( options -> shards < 1 )
+                options -> shards = 1;
+
+            continue;
+        }
+
+        if( strcmp( argv[i], "--include" ) == 0 && i + 1 < *argc )
+        {
+            options -> include = argv[++i];
+            continue;
+        }
+
+        argv[kept++] = argv[i];
+    }
+
+    *argc = kept;
+    argv[kept] = NULL;
+
+    return SUCCESS;
+}
+
+/* Hand the parsed options to the tokenizer, normalizer and index builder */
+Status Apply_Options( BUILD_OPTIONS *options )
+{
+    Set_Tokenizer_SIMD( options -> simd );
+    Set_Normalizer( options -> normalize );
+    Set_Positional_Index( options -> positions );
+    Set_File_Pattern( options -> include );
+    Set_Load_Threads( options -> threads );
+
+    if( options -> stopwords != NULL && Load_Stopwords( options -> stopwords ) != SUCCESS )
+        return FAILURE;
+
+    return SUCCESS;
+}
 
 Status Read_and_Validate( int argc, char* argv[], LIST **head )
 {
@@ -52,9 +186,31 @@ Status Read_and_Validate( int argc, char* argv[], LIST **head )
         exit(1);
     }
 
+    DOC_TABLE listed;
+    LIST **tail = head;
+
+    Initialise_Doc_Table( &listed );
+
     for( int i = 1; i < argc; i++ )
     {
         FILE *fptr;
+        struct stat st;
+
+        // Directories are walked when the database is created, not now
+        if( stat( argv[i], &st ) == 0 && S_ISDIR( st.st_mode ) )
+        {
+            if( No_Duplicate( argv[i], NULL, &listed ) == SUCCESS && Add_To_List( tail, argv[i], NULL ) == SUCCESS )
+            {
+                printf("[INFO]: %s directory added to list\n", argv[i] );
+                tail = &( *tail ) -> link;
+            }
+            else
+            {
+                printf("[INFO]: %s is Duplicate directory\n", argv[i] );
+            }
+
+            continue;
+        }
 
         if( Check_Ext( argv[i] ) == SUCCESS )
         {
@@ -62,17 +218,19 @@ Status Read_and_Validate( int argc, char* argv[], LIST **head )
             {
                 if( Check_Content( fptr ) == SUCCESS )
                 {
-                    if( No_Duplicate( argv[i], *head ) == SUCCESS )
+                    if( No_Duplicate( argv[i], fptr, &listed ) == SUCCESS )
                     {
-                        if( Add_To_List( head, argv[i], fptr ) == SUCCESS )
+                        // Reopened only while it is indexed
+                        fclose( fptr );
+
+                        if( Add_To_List( tail, argv[i], NULL ) == SUCCESS )
                         {
                             printf("[INFO]: %s added to list\n", argv[i] );
+                            tail = &( *tail ) -> link;
                         }
                         else
                         {
                             printf("[INFO]: %s failed to be listed\n", argv[i] );
-                            fclose( fptr );
-
                         }
                     }
                     else
@@ -99,17 +257,42 @@ Status Read_and_Validate( int argc, char* argv[], LIST **head )
         }
     }
 
+    Free_Doc_Table( &listed );
     return SUCCESS;
 }
 
-/* Validates the Extension of all files */
+/* Choose the file name patterns ( comma separated ) Check_Ext() accepts */
+void Set_File_Pattern( const char *patterns )
+{
+    Include = patterns != NULL ? patterns : CORPUS_DEFAULT_INCLUDE;
+}
+
+/* Validates the name of all files against the --include patterns */
 Status Check_Ext( char* filename )
 {
-    char* ext = strstr( filename, ".txt" );
-    if( ext == NULL || strcmp( ext, ".txt" ) != 0 )
-        return FAILURE;
+    const char *base = strrchr( filename, '/' );
+    base = base != NULL ? base + 1 : filename;
 
-    return SUCCESS;
+    for( const char *pattern = Include; *pattern != '\0'; )
+    {
+        size_t length = strcspn( pattern, "," );
+        char one[FILENAME_MAX];
+
+        if( length > 0 && length < sizeof( one ) )
+        {
+            memcpy( one, pattern, length );
+            one[length] = '\0';
+
+            if( fnmatch( one, base, 0 ) == 0 )
+                return SUCCESS;
+        }
+
+        pattern += length;
+        if( *pattern == ',' )
+            pattern++;
+    }
+
+    return FAILURE;
 }
 
 /* Validate if the file is available */
@@ -138,22 +321,16 @@ Status Check_Content( FILE *fptr )
     return FAILURE;
 }
 
-/* Check if any file is duplicate */
-Status No_Duplicate( char* filename, LIST *head )
+/* Check if any file is duplicate; a new file is recorded in listed */
+Status No_Duplicate( char* filename, FILE *fptr, DOC_TABLE *listed )
 {
-    if( head == NULL )
-        return SUCCESS;
-        
-    LIST *temp = head;
-    while( temp != NULL )
-    {
-        if( strcmp( filename, temp -> FILENAME ) == 0 )
-        {
-            return DUPLICATE;
-        }
+    DOC_ID doc_id;
 
-        temp = temp -> link;
-    }
+    if( Find_Document_File( listed, filename, fptr, &doc_id ) == EXISTS )
+        return DUPLICATE;
+
+    if( Register_Document( listed, filename, &doc_id ) == SUCCESS )
+        Record_Document_File( listed, doc_id, filename, fptr );
 
     return SUCCESS;
 }
\ No newline at end of file
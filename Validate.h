@@ -7,19 +7,28 @@
 #include <string.h>
 #include <ctype.h>
 
+// Read and remove option flags ( -j N / --threads N ) from argv
+Status Read_Options( int *argc, char* argv[], BUILD_OPTIONS *options );
+
+// Configure tokenizer / normalizer ( and load stopwords ) from the parsed options
+Status Apply_Options( BUILD_OPTIONS *options );
+
 // Read and Validate
 Status Read_and_Validate( int argc, char* argv[], LIST **head );
 
-// To check extension is .txt
+// To check the file name matches the --include patterns ( .txt by default )
 Status Check_Ext( char* filename );
 
+// Set the --include patterns used by Check_Ext()
+void Set_File_Pattern( const char *patterns );
+
 // To check if file is present
 Status Check_Avail( char* filename, FILE **fptr );
 
 // To check if file empty
 Status Check_Content( FILE *fptr );
 
-// To check duplicate file
-Status No_Duplicate( char* filename, LIST *head );
+// To check duplicate file ( name or file identity ), recording new files in listed
+Status No_Duplicate( char* filename, FILE *fptr, DOC_TABLE *listed );
 
 #endif
\ No newline at end of file
@@ -0,0 +1,265 @@
+/*******************************************************************************************************************************************************************
+ * File        : Write_Ahead_Log.c
+ * Project     : Inverted Search Engine (Project-2)
+ *
+ * Description :
+ *      Crash safety for the save files. A save file is never rewritten in place: a full save goes
+ *      to a temporary file that is synced and then renamed over the old one, so a crash leaves
+ *      either the old or the new file, never a half-written one.
+ *
+ *      Between saves, every document added, re-indexed or removed is appended to the write-ahead
+ *      log of the save file the table is in step with ( H_Table -> Saved, Save_DataBase.c ):
+ *
+ *          Saved_DataBase.txt.wal :   a <TAB> filename       ( add / re-index )
+ *                                     r <TAB> filename       ( remove )
+ *
+ *      Each change costs one synced append of one line. Loading the save file replays its log
+ *      on top of it, and a save to that file ( full or delta ) makes the log obsolete, so it is
+ *      removed once the save is on disk.
+ *
+ * Function Overview :
+ *
+ *      → Sync_Close( FILE *fptr )
+ *            • Flushes, fsyncs and closes a stream; FAILURE if any write was lost
+ *
+ *      → Commit_File( const char *temp_name, const char *filename )
+ *            • Renames a synced temporary file over filename and syncs the directory, so the
+ *              rename itself survives a crash; the temporary file is removed on failure
+ *
+ *      → Log_Document_Change( HASH_T *H_Table, char change, const char *filename )
+ *            • Appends one change ( 'a' or 'r' ) to the log of H_Table -> Saved.file
+ *            • Nothing to do ( SUCCESS ) for a table not in step with a save file
+ *
+ *      → Log_Added_Documents( HASH_T *H_Table, DOC_ID first )
+ *            • One synced append for every live document from doc id first on ( a build )
+ *
+ *      → Replay_Document_Log( HASH_T *H_Table, const char *filename )
+ *            • Applies the log of filename, if any, through Reindex_Document() / Remove_Document()
+ *            • The replayed changes are not logged again; they stay in the log until a save
+ *            • An add that fails ( file gone, unreadable or not indexable ) is named and counted
+ *              apart from the replayed changes; the load itself still succeeds
+ *
+ *      → Discard_Document_Log( const char *filename )
+ *            • Removes the log of filename after a save made it obsolete
+ *
+ * Notes :
+ *      • The log records file names, not postings: replay re-reads each file's current contents,
+ *        as a re-index would. A file edited since its change was logged comes back as it is now,
+ *        and one removed or unreadable since cannot be replayed at all, so the replayed table can
+ *        differ from the one that wrote the log. The next save drops a failed change for good
+ *      • Replaying a change twice is harmless ( re-index / remove again; a remove of a document
+ *        already gone is not a failure ), so a crash between a save and the removal of its log
+ *        loses nothing
+ *      • A torn last line ( crash during an append ) has no newline and is ignored
+ *      • Delta saves append to the save file itself and carry their own length, so a torn
+ *        generation is detected by Load_DataBase_File() and cut off by the next delta save
+ *
+ *******************************************************************************************************************************************************************/
+
+
+#include "Inverted_Search.h"
+#include "Types.h"
+#include <fcntl.h>
+#include <libgen.h>
+#include <unistd.h>
+
+
+/* Log file of a save file */
+static void Log_Name( char *name, const char *filename )
+{
+	snprintf( name, FILENAME_MAX, "%s.wal", filename );
+}
+
+
+/* Sync the directory holding filename, so entries created, renamed or removed there persist */
+static Status Sync_Directory( const char *filename )
+{
+	char path[FILENAME_MAX];
+	snprintf( path, sizeof( path ), "%s", filename );
+
+	int fd = open( dirname( path ), O_RDONLY | O_DIRECTORY );
+	if( fd < 0 )
+		return FAILURE;
+
+	Status status = fsync( fd ) == 0 ? SUCCESS : FAILURE;
+	close( fd );
+
+	return status;
+}
+
+
+/**/
+Status Sync_Close( FILE *fptr )
+{
+	Status status = SUCCESS;
+
+	if( fflush( fptr ) != 0 || ferror( fptr ) || fsync( fileno( fptr ) ) != 0 )
+		status = FAILURE;
+
+	if( fclose( fptr ) != 0 )
+		status = FAILURE;
+
+	return status;
+}
+
+
+/**/
+Status Commit_File( const char *temp_name, const char *filename )
+{
+	if( rename( temp_name, filename ) != 0 )
+	{
+		remove( temp_name );
+		return FAILURE;
+	}
+
+	// The new name is durable only once the directory is
+	if( Sync_Directory( filename ) == FAILURE )
+		printf("[INFO]: Could not sync the directory of '%s'\n", filename );
+
+	return SUCCESS;
+}
+
+
+/* Append lines to the log of H_Table's save file and sync them */
+static Status Append_Log( HASH_T *H_Table, char change, const char **name, size_t count )
+{
+	char log_name[FILENAME_MAX];
+	Log_Name( log_name, H_Table -> Saved.file );
+
+	FILE *fptr = fopen( log_name, "a" );
+	if( fptr == NULL )
+	{
+		printf("[INFO]: Could not open the log '%s'\n", log_name );
+		return FAILURE;
+	}
+
+	for( size_t i = 0; i < count; i++ )
+		fprintf( fptr, "%c\t%s\n", change, name[i] );
+
+	if( Sync_Close( fptr ) == FAILURE )
+	{
+		printf("[INFO]: Could not write the log '%s'\n", log_name );
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+
+/**/
+Status Log_Document_Change( HASH_T *H_Table, char change, const char *filename )
+{
+	if( H_Table -> Saved.file == NULL || !H_Table -> Saved.logging )
+		return SUCCESS;
+
+	return Append_Log( H_Table, change, &filename, 1 );
+}
+
+
+/**/
+Status Log_Added_Documents( HASH_T *H_Table, DOC_ID first )
+{
+	DOC_TABLE *Docs = &H_Table -> Docs;
+
+	if( H_Table -> Saved.file == NULL || !H_Table -> Saved.logging || first >= Docs -> count )
+		return SUCCESS;
+
+	const char **name = malloc( ( Docs -> count - first ) * sizeof( char* ) );
+	size_t count = 0;
+
+	if( name == NULL )
+	{
+		perror("Malloc failed for the log");
+		return FAILURE;
+	}
+
+	for( DOC_ID id = first; id < Docs -> count; id++ )
+	{
+		if( !Docs -> doc[id].deleted )
+			name[ count++ ] = Docs -> doc[id].name;
+	}
+
+	Status status = count > 0 ? Append_Log( H_Table, 'a', name, count ) : SUCCESS;
+
+	free( name );
+	return status;
+}
+
+
+/**/
+Status Replay_Document_Log( HASH_T *H_Table, const char *filename )
+{
+	char log_name[FILENAME_MAX];
+	Log_Name( log_name, filename );
+
+	FILE *fptr = fopen( log_name, "r" );
+	if( fptr == NULL )
+		return SUCCESS;
+
+	char *line = NULL;
+	size_t line_size = 0;
+	ssize_t length;
+	long replayed = 0;
+	long failed = 0;
+
+	// The changes are in the log already
+	int logging = H_Table -> Saved.logging;
+	H_Table -> Saved.logging = 0;
+
+	while( ( length = getline( &line, &line_size, fptr ) ) != -1 )
+	{
+		// A line without its newline was cut short by a crash while it was appended
+		if( length < 3 || line[ length - 1 ] != '\n' || line[1] != '\t' )
+			continue;
+
+		line[ length - 1 ] = '\0';
+
+		Status status;
+
+		if( line[0] == 'a' )
+			status = Reindex_Document( H_Table, line + 2 );
+		else if( line[0] == 'r' )
+		{
+			// NOT_EXISTS: already gone, as the log has it
+			Remove_Document( H_Table, line + 2 );
+			status = SUCCESS;
+		}
+		else
+			continue;
+
+		if( status == FAILURE )
+		{
+			printf("[INFO]: Logged change to '%s' could not be replayed\n", line + 2 );
+			failed++;
+		}
+		else
+			replayed++;
+	}
+
+	H_Table -> Saved.logging = logging;
+
+	free( line );
+	fclose( fptr );
+
+	printf("\n[INFO]: %ld logged change%s replayed from '%s'", replayed, replayed == 1 ? "" : "s", log_name );
+
+	if( failed > 0 )
+		printf(", %ld failed and not applied", failed );
+
+	printf("\n");
+	return SUCCESS;
+}
+
+
+/**/
+Status Discard_Document_Log( const char *filename )
+{
+	char log_name[FILENAME_MAX];
+	Log_Name( log_name, filename );
+
+	if( remove( log_name ) != 0 )
+		return SUCCESS;
+
+	Sync_Directory( log_name );
+	return SUCCESS;
+}